@@ -22,7 +22,7 @@ echo 开始编译...
 
 REM 编译 DLL
 echo 1. 编译 WinLog.dll...
-g++ -shared -o bin/WinLog.dll src/winlog.cpp src/async_log_queue.cpp -I include -DWINDOWS -DWINGDIAPI= -DWINLOG_EXPORTS -static-libgcc -static-libstdc++ -Wl,--out-implib,lib/WinLog.lib
+g++ -shared -o bin/WinLog.dll src/winlog.cpp src/async_log_queue.cpp src/spill_file.cpp src/log_args.cpp src/log_site.cpp src/timestamp_formatter.cpp src/log_clock.cpp src/log_file.cpp src/log_sink.cpp src/log_sink_worker.cpp src/log_compressor.cpp src/rotating_file_sink.cpp src/binary_log_sink.cpp src/binary_log_decoder.cpp -I include -DWINDOWS -DWINGDIAPI= -DWINLOG_EXPORTS -static-libgcc -static-libstdc++ -Wl,--out-implib,lib/WinLog.lib
 if %errorlevel% neq 0 (
     echo 错误：DLL 编译失败
     exit /b 1
@@ -54,10 +54,19 @@ if %errorlevel% neq 0 (
 )
 echo ✓ 测试程序编译成功
 
+echo 5. 编译二进制日志解码工具...
+g++ -o bin/winlog-decode.exe tools/winlog_decode.cpp -I include -L lib -lWinLog -static-libgcc -static-libstdc++
+if %errorlevel% neq 0 (
+    echo 错误：解码工具编译失败
+    exit /b 1
+)
+echo ✓ 解码工具编译成功
+
 echo.
 echo 构建完成！
 echo 生成文件：
 dir /b bin\*.dll
+bin\*.exe
 lib\*.lib
 examples\*.exe
 test\*.exe
@@ -2,7 +2,12 @@
 #define ASYNC_LOG_QUEUE_H
 
 #include "winlog.h"
+#include "mpsc_ring_buffer.h"
+#include "record_ring_buffer.h"
+#include "spsc_ring_buffer.h"
+#include "spill_file.h"
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -15,11 +20,16 @@
 // 异步日志队列类
 class WINLOG_API AsyncLogQueue {
 public:
-    // 日志处理回调函数类型
-    using LogHandler = std::function<void(const std::vector<LogEntry>&)>;
+    // 日志处理回调函数类型（批次中的条目由队列持有，回调返回后归还内存池）
+    using LogHandler = std::function<void(const std::vector<LogEntry*>&)>;
     
     // 构造函数
-    AsyncLogQueue(size_t queueSize, size_t maxBatchSize, size_t memoryPoolSize, bool dropOnOverflow = false, int flushIntervalMs = 1000);
+    AsyncLogQueue(size_t queueSize, size_t maxBatchSize, size_t memoryPoolSize, bool dropOnOverflow = false, int flushIntervalMs = 1000,
+                  QueueEngine engine = QueueEngine::mutex, bool useMemoryPool = true, size_t queueBytes = 4 * 1024 * 1024,
+                  size_t laneSize = 4096);
+    
+    // 根据异步配置构造
+    explicit AsyncLogQueue(const AsyncConfig& config);
     
     // 析构函数
     ~AsyncLogQueue();
@@ -37,27 +47,106 @@ public:
     // 添加日志到队列（移动语义）
     bool enqueue(LogEntry&& entry);
     
-    // 刷新队列中的所有日志
+    // 添加日志到队列（指针交接）：entry必须来自allocateEntry，调用后所有权归队列，
+    // 入队失败时条目会被自动归还内存池
+    bool enqueue(LogEntry* entry);
+    
+    // 批量入队（指针交接）：entries中的条目都必须来自allocateEntry，调用后所有权归队列。
+    // 整批只占用一次队列预留、唤醒一次工作线程，批次中的日志在输出中保持连续
+    // （批次超出队列容量时按容量分段，段与段之间可能插入其他线程的日志）。返回被接受的条目数
+    size_t enqueueBatch(LogEntry** entries, size_t count);
+    
+    // 分配日志条目（优化版）：生产者直接在池化条目中格式化消息后调用enqueue(LogEntry*)
+    LogEntry* allocateEntry();
+    
+    // 释放日志条目（优化版）
+    void freeEntry(LogEntry* entry);
+    
+    // 等待此刻之前入队的日志全部交给处理回调（按序号判断，持续写入时也能返回），超时或队列停止时返回false
     bool flush(int timeoutMs = -1);
     
+    // 序号：每条成功入队的日志对应一个序号，按工作线程的输出顺序递增（取值因引擎而异：互斥锁引擎为入队次数，
+    // 无锁引擎为环形缓冲区的写入位置，变长记录引擎为记录末尾的字节位置，通道引擎为合并用的时间戳），0表示没有日志。
+    // 调用线程在本队列中最近一次成功入队的日志的序号
+    uint64_t lastSequence() const;
+    
+    // 此刻之前入队的全部日志都不超过的序号
+    uint64_t currentSequence() const;
+    
+    // 序号不超过此值的日志都已交给处理回调
+    uint64_t processedSequence() const;
+    
+    // 等待序号不超过sequence的日志全部交给处理回调（由工作线程在每批处理完成后通知），超时或队列停止时返回false
+    bool waitProcessed(uint64_t sequence, int timeoutMs = -1);
+    
     // 停止日志处理线程
     void stop();
     
     // 获取队列当前大小
     size_t size() const;
     
-    // 判断队列是否已满
+    // 判断队列是否已满（perThreadLanes引擎判断调用线程自己的通道）
     bool isFull() const;
     
     // 判断队列是否已停止
     bool isStopped() const;
     
+    // 设置本队列的溢出策略（按配置构造时取自AsyncConfig），应在开始入队前调用；
+    // spill策略在此创建溢出文件，创建失败时改用blockWithTimeout并返回false
+    bool setOverflowPolicy(OverflowPolicy policy, int timeoutMs = 100, const char* spillPath = nullptr,
+                           size_t spillBytes = 64 * 1024 * 1024);
+    
+    // 获取本队列的溢出策略
+    OverflowPolicy overflowPolicy() const;
+    
+    // 启用优先级通道（按配置构造时取自AsyncConfig），应在开始入队前调用：级别不低于level的日志在正常入队之外
+    // 另复制一份放入容量为capacity的优先级通道，工作线程每轮先把它交给优先级回调，再处理常规批次；
+    // 常规批次中对应的条目带有expedited标记，由处理回调决定是否跳过。level为off时不启用
+    void setPriorityLane(LogLevel level, size_t capacity = 1024);
+    
+    // 设置优先级通道的处理回调（未设置时使用日志处理回调）
+    void setPriorityHandler(LogHandler handler);
+    
+    // 设置工作线程在队列为空时的等待策略（按配置构造时取自AsyncConfig），应在开始入队前调用
+    void setWaitStrategy(WaitStrategy strategy, int spinIterations = 4000, int batchIntervalUs = 1000);
+    
+    // 获取等待策略
+    WaitStrategy waitStrategy() const;
+    
+    // 启用自适应批量大小（按配置构造时取自AsyncConfig），应在开始入队前调用：工作线程按到达速率与每条日志的
+    // 处理耗时，在[minBatchSize, maxBatchSize]内选择每批的上限，使一批的处理耗时不超过latencyTargetUs。
+    // 未启用时每批固定以maxBatchSize为上限
+    void setAdaptiveBatching(bool enabled, size_t minBatchSize = 16, int latencyTargetUs = 1000);
+    
+    // 获取队列引擎类型
+    QueueEngine engine() const;
+    
     // 获取队列统计信息
     struct Stats {
         size_t totalEnqueued;        // 总入队数
         size_t totalDropped;         // 总丢弃数
+        size_t totalOverflows;       // 入队时队列已满的次数（dropByLevel策略下低级别日志超出其可用空间也计入）
+        size_t droppedByLevel[LOG_LEVEL_COUNT]; // 按级别统计的丢弃数
+        // 溢出文件统计信息（spill策略）
+        size_t spilledEntries;       // 写入溢出文件的条目数
+        size_t spilledBytes;         // 写入溢出文件的负载字节数
+        uint64_t totalSpillNanos;    // 生产者写入溢出文件的累计耗时（纳秒）
+        uint64_t maxSpillNanos;      // 单条写入的最长耗时（纳秒）
+        size_t drainedEntries;       // 从溢出文件读回并处理的条目数
+        uint64_t totalDrainNanos;    // 读回并处理溢出条目的累计耗时（纳秒）
+        // 优先级通道统计信息
+        size_t expeditedEntries;     // 经优先级通道提前交给处理回调的条目数
+        size_t expediteMisses;       // 优先级通道已满或暂停、只按常规顺序处理的条目数
+        // 等待策略统计信息
+        size_t producerWakeups;      // 生产者通知休眠中的工作线程的次数
+        size_t consumerParks;        // 工作线程在条件变量上休眠的次数
+        // 批量处理统计信息
+        size_t batchOperations;      // 交给处理回调的批次数
+        size_t batchLimit;           // 工作线程当前选择的每批上限（未启用自适应时为maxBatchSize）
+        double batchesPerSecond;     // 自构造或上次重置统计以来平均每秒处理的批次数
         size_t totalProcessed;       // 总处理数
         size_t currentQueueSize;     // 当前队列大小
+        size_t totalQueueBytes;      // 入队写入队列存储的总字节数（定长槽位按sizeof(LogEntry)计）
         // 内存池统计信息
         size_t totalAllocations;     // 总分配次数
         size_t totalDeallocations;   // 总释放次数
@@ -73,12 +162,12 @@ public:
     void resetStats();
     
     // 静态配置方法
-    static void setDropOnOverflow(bool drop);
     static void setFlushIntervalMs(int ms);
 
 private:
     // 线程本地缓存结构
     struct ThreadLocalCache {
+        ~ThreadLocalCache();            // 线程退出时释放缓存中的对象
         std::vector<LogEntry*> entries; // 本地缓存的对象
         static constexpr size_t CACHE_SIZE = 32; // 每个线程的缓存大小
         static constexpr size_t BATCH_THRESHOLD = 8; // 批量回收阈值
@@ -87,20 +176,156 @@ private:
     // 获取当前线程的本地缓存
     ThreadLocalCache& getThreadLocalCache();
     
+    // 生产者通道：每个生产者线程独享一条SPSC环形缓冲区
+    struct ProducerLane {
+        explicit ProducerLane(size_t capacity);
+        SpscRingBuffer<LogEntry*> ring;              // 通道数据
+        // 生产者正在入队时记录的时间戳下界，空闲时为UINT64_MAX；工作线程据此计算合并水位线
+        alignas(WINLOG_CACHE_LINE_SIZE) std::atomic<uint64_t> inFlightSince;
+        std::atomic<bool> retired;                   // 所属线程已退出，通道排空后由工作线程回收
+        std::atomic<bool> closed;                    // 所属队列已销毁，线程登记表可以丢弃该通道
+    };
+    
+    // 线程本地的通道登记表：一个线程可能同时向多个队列写日志，线程退出时将其通道全部标记为退役
+    struct ThreadLaneRegistry {
+        ~ThreadLaneRegistry();
+        std::vector<std::pair<uint64_t, std::shared_ptr<ProducerLane>>> lanes; // 队列实例ID -> 通道
+        uint64_t lastQueueId = 0;                    // 最近使用的队列实例ID
+        ProducerLane* lastLane = nullptr;            // 最近使用的通道
+    };
+    
+    // 获取当前线程在本队列中的通道（首次调用时惰性注册，类似getThreadLocalCache）
+    ProducerLane* getProducerLane();
+    
+    // 查找当前线程在本队列中已注册的通道，不注册新通道
+    ProducerLane* findProducerLane() const;
+    
+    // 通道引擎的入队实现
+    bool enqueueLane(LogEntry* entry);
+    
+    // 通道引擎的出队实现：按时间戳合并各通道中早于水位线的条目
+    void dequeueLanes(std::vector<LogEntry*>& batch);
+    
+    // 停止后等待在途的生产者完成入队，此后各通道中的条目不再增加，可以不受水位线限制全部取出
+    void fenceLaneProducers();
+    
+    // 通道引擎的队列大小（遍历所有通道）
+    size_t laneQueueSize() const;
+    
+    // 记录调用线程最近一次入队的序号（参数为内存队列的原始序号）
+    void setLastSequence(uint64_t sequence);
+    
+    // 工作线程处理完一批后公布已处理的序号（参数为内存队列的原始序号），并唤醒等待的线程
+    void publishProcessed(uint64_t rawSequence);
+    
     // 从本地缓存批量转移对象到全局池
     void refillGlobalPool(ThreadLocalCache& cache);
     
     // 日志处理工作线程函数
     void workerThread();
     
-    // 从队列中批量获取日志
-    std::vector<LogEntry> dequeueBatch();
+    // 从队列中批量获取日志，填入batch（先清空，容量跨批次保留）
+    void dequeueBatch(std::vector<LogEntry*>& batch);
     
-    // 分配日志条目（优化版）
-    LogEntry* allocateEntry();
+    // 处理完一批后更新自适应批量上限：batchSize为本批条数，processNanos为本批取出与处理的耗时，
+    // cycleNanos为距上一轮开始的时间（含空闲等待）
+    void adaptBatchLimit(size_t batchSize, uint64_t processNanos, uint64_t cycleNanos);
     
-    // 释放日志条目（优化版）
-    void freeEntry(LogEntry* entry);
+    // 无锁引擎的入队实现
+    bool enqueueLockFree(LogEntry* entry);
+    
+    // 变长记录引擎的入队实现：按实际长度编码进字节环后立即归还条目
+    bool enqueueRecord(LogEntry* entry);
+    
+    // 各引擎的批量入队实现（一段不超过队列容量的批次），返回被接受的条目数
+    size_t enqueueBatchLocked(LogEntry** entries, size_t count);
+    size_t enqueueBatchLockFree(LogEntry** entries, size_t count);
+    size_t enqueueBatchRecord(LogEntry** entries, size_t count);
+    size_t enqueueBatchLane(LogEntry** entries, size_t count);
+    
+    // dropByLevel策略下队列用量已进入低级别日志的保留区时，丢弃批次中低于warn的条目并压缩数组，返回剩余条目数
+    size_t shedBatch(LogEntry** entries, size_t count, size_t used, size_t capacity);
+    
+    // 将条目计入丢弃并归还内存池
+    void dropEntries(LogEntry* const* entries, size_t count);
+    
+    // 处理完成后归还批次（变长记录引擎与溢出文件的批次来自工作线程私有的解码条目，无需归还）
+    void releaseBatch(const std::vector<LogEntry*>& batch);
+    
+    // 唤醒正在休眠的消费者（仅当消费者确实在等待时才加锁通知，互斥锁引擎在入队的锁内直接检查）
+    void wakeConsumer();
+    
+    // 队列为空时按等待策略等待新的日志
+    void waitForEntries();
+    
+    // 工作线程在条件变量上休眠，直到生产者通知（有线程等待序号推进时只短暂休眠）
+    void parkConsumer();
+    
+    // 无锁引擎队列已满时按溢出策略处理：tryPush重试写入，返回false时由调用者计入丢弃并归还条目。
+    // level为待写入日志的级别（批次取其中最高的级别）
+    template <typename TryPush>
+    bool handleOverflow(LogLevel level, TryPush&& tryPush);
+    
+    // dropByLevel策略下低级别日志是否已超出其可用空间（used和capacity为队列当前用量与容量）
+    bool shedLowLevel(LogLevel level, size_t used, size_t capacity) const;
+    
+    // spill策略：写入溢出文件的结果
+    enum class SpillResult {
+        inactive,   // 本轮溢出已排空，应回到内存队列
+        spilled,    // 已写入溢出文件
+        dropped     // 溢出文件已满，已丢弃并归还条目
+    };
+    
+    // 写入溢出文件：start为true时在未溢出的状态下开始新一轮溢出，fence为此刻内存队列的原始序号
+    SpillResult spillEntry(LogEntry* entry, bool start, uint64_t fence);
+    
+    // 在一次加锁中将多个条目依次写入溢出文件，stored为写入的条数（写不下的条目已丢弃并归还）；
+    // 未处于溢出中且start为false时返回false，条目未被处理
+    bool spillEntries(LogEntry* const* entries, size_t count, bool start, uint64_t fence, size_t& stored);
+    
+    // 内存队列已满时开始溢出，返回enqueue的结果
+    bool spillOverflow(LogEntry* entry, uint64_t fence);
+    size_t spillOverflow(LogEntry* const* entries, size_t count, uint64_t fence);
+    
+    // 处于溢出中时将条目写入溢出文件并返回true，accepted为enqueue的结果；未处于溢出中时返回false
+    bool continueSpill(LogEntry* entry, bool& accepted);
+    bool continueSpill(LogEntry* const* entries, size_t count, size_t& accepted);
+    
+    // 内存队列此刻的原始序号（未按溢出编码，互斥锁引擎会获取queueMutex_）
+    uint64_t rawCurrentSequence() const;
+    
+    // 从内存队列中批量获取日志
+    void dequeueMemoryBatch(std::vector<LogEntry*>& batch);
+    
+    // 内存队列取空后按顺序读回溢出文件中写入位置limit之前的日志；溢出文件也已读空时结束本轮溢出
+    void dequeueSpill(std::vector<LogEntry*>& batch, uint64_t limit);
+    
+    // 内存队列是否为空（不含溢出文件）
+    bool isMemoryEmpty() const;
+    
+    // 将高优先级日志复制一份放入优先级通道，通道已满或已暂停时返回false，
+    // 此时调用方须在常规入队之后调用finishExpediteMisses
+    bool expedite(const LogEntry& entry);
+    void finishExpediteMisses(size_t count);
+    
+    // 未能提前的条目都已处理完时恢复提前输出（工作线程公布已处理的序号后调用）
+    void resumeExpedite();
+    
+    // 按队列引擎把条目放入常规队列
+    bool enqueueRegular(LogEntry* entry);
+    
+    // 工作线程取出常规批次后，先把优先级通道中的日志交给优先级回调（此前入队的副本此时一定可见）
+    void deliverPriority();
+    
+    // 溢出与丢弃统计
+    void recordOverflow();
+    void recordDrop(LogLevel level);
+    
+    // 判断队列是否为空（按引擎类型分派）
+    bool isQueueEmpty() const;
+    
+    // 工作线程自旋时判断队列是否为空：只读原子计数，不加任何锁（休眠前由parkConsumer在锁内复查）
+    bool isQueueEmptyUnlocked() const;
     
     // 批量分配日志条目
     std::vector<LogEntry*> allocateBatch(size_t count);
@@ -111,15 +336,95 @@ private:
     // 内部成员变量
     size_t queueSize_;           // 队列最大大小
     size_t maxBatchSize_;        // 最大批量处理大小
+    std::atomic<size_t> batchLimit_; // 当前每批的上限（自适应时由工作线程调整）
     size_t memoryPoolSize_;      // 内存池初始大小
-    static bool dropOnOverflow_; // 队列溢出时是否丢弃
+    bool useMemoryPool_;         // 是否使用内存池（否则每条日志直接new/delete）
+    OverflowPolicy overflowPolicy_; // 队列已满时的处理策略
+    int overflowTimeoutMs_;      // 等待空位的最长时间（毫秒）
     static int flushIntervalMs_; // 自动刷新间隔（毫秒）
     
     // 线程安全队列
-    std::queue<LogEntry> queue_;
+    QueueEngine engine_;                 // 队列引擎类型
+    std::queue<LogEntry*> queue_;
+    std::atomic<size_t> queuedEntries_;       // queue_中的条目数（在queueMutex_内更新，自旋检查时不加锁读取）
     mutable std::mutex queueMutex_;
     std::condition_variable notEmpty_;
     std::condition_variable notFull_;
+    std::atomic<WaitStrategy> waitStrategy_;  // 队列为空时的等待策略
+    std::atomic<int> spinIterations_;         // 让出CPU或休眠之前的自旋次数
+    std::atomic<int> batchIntervalUs_;        // timedBatch策略的处理间隔（微秒）
+    
+    // 无锁引擎相关
+    std::unique_ptr<MpscRingBuffer<LogEntry*>> ring_; // 无锁环形缓冲区（仅lockFree引擎）
+    std::atomic<bool> consumerSleeping_;              // 消费者是否正在条件变量上休眠
+    size_t enqueueBase_;                              // 重置统计时的入队位置基准
+    
+    // 生产者通道引擎相关
+    uint64_t queueId_;                                // 队列实例ID（区分线程登记表中的通道）
+    size_t laneSize_;                                 // 每条通道的容量
+    mutable std::mutex lanesMutex_;                   // 保护lanes_（仅在注册/回收通道时加锁）
+    std::vector<std::shared_ptr<ProducerLane>> lanes_;// 所有已注册的通道
+    std::atomic<size_t> lanesVersion_;                // 通道列表版本号，工作线程据此刷新快照
+    std::vector<std::shared_ptr<ProducerLane>> workerLanes_; // 工作线程持有的通道快照
+    size_t workerLanesVersion_;                       // 快照对应的版本号
+    size_t retiredLaneEnqueued_;                      // 已回收通道的累计入队数
+    bool drainingLanes_;                              // 停止后的最终排空：合并不受水位线限制（只由工作线程访问）
+    alignas(WINLOG_CACHE_LINE_SIZE) std::atomic<uint64_t> laneWatermark_; // 工作线程最近一轮合并的水位线上界
+    static std::atomic<uint64_t> nextQueueId_;        // 队列实例ID生成器
+    static thread_local std::unique_ptr<ThreadLaneRegistry> threadLanes; // 线程本地通道登记表
+    
+    // 序号相关：对外公布的序号为原始序号的2倍，奇数留给溢出文件中的日志——一轮溢出中的日志都取2*fence+1，
+    // 介于溢出开始前（不超过2*fence）与溢出结束后（不小于2*fence+2）入队的日志之间
+    struct ThreadSequence {
+        uint64_t queueId = 0;                         // 序号所属的队列实例ID
+        uint64_t sequence = 0;                        // 最近一次入队的序号
+    };
+    static thread_local ThreadSequence threadSequence; // 线程本地的最近入队序号
+    uint64_t enqueueSequence_;                        // 互斥锁引擎的累计入队次数（由queueMutex_保护）
+    uint64_t dequeuedSequence_;                       // 最近一次取出的批次覆盖到的序号（只由工作线程访问）
+    alignas(WINLOG_CACHE_LINE_SIZE) std::atomic<uint64_t> processedSequence_; // 已交给处理回调的序号
+    std::atomic<int> sequenceWaiters_;                // 正在等待序号推进的线程数
+    std::mutex sequenceMutex_;
+    std::condition_variable sequenceDone_;            // 已处理的序号推进或队列停止
+    
+    // 溢出文件相关（仅spill策略）：溢出开始后新日志一律写入溢出文件，直到工作线程取空内存队列并排空溢出文件，
+    // 从而保持入队顺序
+    std::unique_ptr<SpillFile> spill_;                // 溢出文件
+    mutable std::mutex spillMutex_;                   // 保护溢出文件的写入与溢出状态的切换
+    std::atomic<bool> spillActive_;                   // 是否处于溢出中
+    uint64_t spillFence_;                             // 本轮溢出开始时内存队列的原始序号（由spillMutex_保护，下同）
+    uint64_t spillDoneSequence_;                      // 最近一轮溢出排空后可公布的已处理序号
+    std::vector<std::unique_ptr<LogEntry>> spillDecoded_; // 工作线程私有的溢出条目解码缓冲
+    bool batchFromSpill_;                             // 最近一批是否来自溢出文件（只由工作线程访问）
+    
+    // 优先级通道相关：条目只是副本，常规队列中的原条目仍按顺序处理，序号与flush不受影响
+    LogLevel priorityLevel_;                          // 不低于该级别的日志进入优先级通道（off表示不启用）
+    size_t priorityCapacity_;                         // 优先级通道的容量
+    std::mutex priorityMutex_;                        // 保护priorityQueue_
+    std::vector<LogEntry*> priorityQueue_;            // 待提前输出的副本
+    std::vector<LogEntry*> priorityBatch_;            // 工作线程私有的优先级批次，跨批次复用
+    std::atomic<size_t> priorityPending_;             // 优先级通道中的条目数（工作线程判断是否休眠时使用，不加锁）
+    std::atomic<bool> expediteHeld_;                  // 有条目未能提前，暂停提前输出直到工作线程处理到它
+    size_t expediteMissesInFlight_;                   // 未能提前、尚未完成常规入队的条目数（由priorityMutex_保护，下同）
+    uint64_t expediteFence_;                          // 恢复提前输出前须处理到的序号
+    std::atomic<size_t> expeditedEntries_;            // 提前输出的条目数（生产者以relaxed原子计数，不加statsMutex_）
+    std::atomic<size_t> expediteMisses_;              // 未能提前的条目数
+    LogHandler priorityHandler_;                      // 优先级通道的处理回调
+    
+    // 变长记录引擎相关
+    std::unique_ptr<RecordRingBuffer> records_;       // 变长记录字节环（仅recordRing引擎）
+    std::vector<std::unique_ptr<LogEntry>> decoded_;  // 工作线程私有的解码条目，跨批次复用
+    size_t enqueueBytesBase_;                         // 重置统计时的字节位置基准
+    
+    // 自适应批量相关：滑动平均只由工作线程访问
+    std::atomic<bool> adaptiveBatching_;              // 是否启用自适应批量大小
+    std::atomic<size_t> minBatchSize_;                // 自适应时每批上限的下界
+    std::atomic<uint64_t> batchLatencyNanos_;         // 一批处理耗时的目标（纳秒）
+    double entryCostNanos_;                           // 每条日志取出与处理耗时的滑动平均（纳秒）
+    double arrivalPerNano_;                           // 到达速率的滑动平均（条/纳秒）
+    std::vector<LogEntry*> batchBuffer_;              // 工作线程每轮复用的预分配批次缓冲区
+    std::vector<std::pair<uint64_t, size_t>> mergeHeap_; // 通道引擎按(时间戳, 通道下标)归并的堆，工作线程每轮复用
+    std::chrono::steady_clock::time_point statsSince_; // 构造或上次重置统计的时刻（由statsMutex_保护）
     
     // 日志处理相关
     LogHandler logHandler_;
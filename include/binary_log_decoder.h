@@ -0,0 +1,67 @@
+#ifndef BINARY_LOG_DECODER_H
+#define BINARY_LOG_DECODER_H
+
+#include "winlog.h"
+#include "log_output_buffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// 二进制日志解码器：将BinaryLogSink写入的文件还原为与文本输出目标相同格式的日志行
+// （时间戳换算公式与LogClock一致，消息按formatLogArgs格式化，结果逐字节相同）
+class WINLOG_API BinaryLogDecoder {
+public:
+    explicit BinaryLogDecoder(TimestampPrecision precision = TimestampPrecision::milliseconds,
+                              TimestampZone zone = TimestampZone::local);
+
+    // 禁止拷贝构造和赋值操作
+    BinaryLogDecoder(const BinaryLogDecoder&) = delete;
+    BinaryLogDecoder& operator=(const BinaryLogDecoder&) = delete;
+
+    // 解码整个文件，文本写入outputPath（为nullptr时写到标准输出）。
+    // 文件无法打开或格式错误时返回false，错误之前已解码的日志仍会写出
+    bool decodeFile(const char* inputPath, const char* outputPath);
+
+    // 流式解码：data为文件内容的下一段（第一段从文件头开始），解码其中完整的记录并追加到out，
+    // 返回已消耗的字节数；末尾不完整的记录应与下一段拼接后再次传入。格式错误时停止并设置lastError
+    size_t decode(const char* data, size_t len, LogOutputBuffer& out);
+
+    // 已解码的日志条数
+    uint64_t entriesDecoded() const {
+        return entries_;
+    }
+
+    // 最近一次错误的描述（没有错误时为空）
+    const std::string& lastError() const {
+        return error_;
+    }
+
+private:
+    // 调用点表项
+    struct Site {
+        std::string format;
+        std::string file;
+        uint32_t line;
+        std::string types;                  // 参数类型（LogArgType）
+    };
+
+    // 解码一条记录：成功返回1，数据不完整返回0，格式错误返回-1
+    int decodeRecord(const char*& p, const char* end, LogOutputBuffer& out);
+
+    // 按CLOCK记录的对应关系将时钟计数换算为墙上时间并格式化
+    size_t formatTime(uint64_t ticks, char* out);
+
+    TimestampFormatter formatter_;
+    bool headerRead_;                       // 是否已读取文件头
+    bool clockKnown_;                       // 是否已读取CLOCK记录
+    uint64_t tickBase_;
+    int64_t epochBase_;
+    double nanosPerTick_;
+    uint64_t lastTimestamp_;                // 上一条记录的时钟计数
+    std::unordered_map<uint32_t, Site> sites_;
+    uint64_t entries_;
+    std::string error_;
+};
+
+#endif // BINARY_LOG_DECODER_H
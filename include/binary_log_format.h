@@ -0,0 +1,211 @@
+#ifndef BINARY_LOG_FORMAT_H
+#define BINARY_LOG_FORMAT_H
+
+#include "winlog.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 二进制日志文件格式（.wlb），由BinaryLogSink写入、winlog-decode还原为文本：
+//
+//   文件头：   "WLOGBIN\0"(8字节) + 版本号(uint32) + 保留(uint32)
+//   之后为记录流，每条记录以一个标记字节开始（高4位为类型，低4位为日志级别）：
+//   CLOCK：    tickBase(uint64) + epochBase(int64) + nanosPerTick(double)
+//              时钟计数与墙上时间的对应关系，之后条目的时间戳增量以tickBase为起点
+//              （BinaryLogSink写入的时间戳已换算为纳秒，每次会话写入一条nanosPerTick为1的记录）
+//   SITE：     id(varint) + line(varint) + 格式字符串长度(varint) + 格式字符串 + 文件名长度(varint) + 文件名
+//              + 参数个数(varint) + 每个参数的类型（LogArgType，各1字节）
+//              调用点表项，每个文件中首次出现时写入一次；参数类型与之前不同时重新写入，覆盖之前的表项
+//   ENTRY：    时间戳增量(zigzag varint) + 调用点ID(varint) + 按调用点参数类型依次排列的参数值
+//              （整数为varint，有符号整数先zigzag；浮点数8字节；字符1字节；字符串为长度(varint) + 内容）
+//   TEXT：     时间戳增量(zigzag varint) + 行号(varint) + 文件名长度(varint) + 文件名 + 消息长度(varint) + 消息
+//              已在调用线程中格式化的日志（printf风格接口）
+//
+// 多字节整数均为小端序。时间戳增量相对于上一条ENTRY/TEXT（或CLOCK的tickBase）
+
+#define BINARY_LOG_MAGIC "WLOGBIN"
+#define BINARY_LOG_VERSION 1
+#define BINARY_LOG_HEADER_SIZE 16
+
+// 记录类型（标记字节的高4位）
+enum class BinaryRecordType : uint8_t {
+    clock = 1,
+    site = 2,
+    entry = 3,
+    text = 4
+};
+
+// 不在调用点登记表中的格式字符串（WinLog::info(format, args...)等）使用的调用点ID起点
+#define BINARY_LOG_DYNAMIC_SITE_BASE 0x10000000u
+
+// 队列工作线程交给二进制输出目标的中间记录：记录头后紧跟messageLen字节的消息。
+// 只在进程内传递（含格式字符串指针），由输出目标转码为上面的文件格式
+struct BinaryEntryHeader {
+    uint64_t timestamp;         // 调用点时间（工作线程已换算为自1970-01-01 00:00:00 UTC起的纳秒数）
+    const char* format;         // 延迟格式化的格式字符串（nullptr表示消息已格式化）
+    uint32_t siteId;            // 调用点ID（0表示没有登记）
+    uint32_t line;              // 未登记调用点的行号
+    uint16_t messageLen;        // 消息或编码参数的长度
+    uint16_t fileLen;           // 未登记调用点的文件名长度（文件名紧跟在消息之后）
+};
+
+// 变长整数编码（每字节7位，最高位表示后面还有字节），返回写入的字节数（最多10字节）
+inline size_t writeVarint(char* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out[n++] = static_cast<char>(value);
+    return n;
+}
+
+// 读取变长整数，数据不完整时返回false
+inline bool readVarint(const char*& p, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t b = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 有符号数的zigzag编码：绝对值小的负数也只占很少的字节
+inline uint64_t zigzagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// 将LogArgBuffer编码的参数转为文件中的紧凑形式：类型标记单独写入types（同一调用点的参数类型通常不变，
+// 只随SITE记录写入），整数和指针改为varint（有符号整数先zigzag），字符串长度改为varint，其余不变。
+// out至少需要2 * len字节，types至少需要len / 2字节；遇到无法识别或不完整的参数时停止，返回写入out的字节数
+inline size_t packLogArgs(const char* args, size_t len, char* out, char* types, size_t& typeCount) {
+    const char* p = args;
+    const char* end = args + len;
+    size_t n = 0;
+    typeCount = 0;
+    while (p < end) {
+        LogArgType type = static_cast<LogArgType>(*p);
+        switch (type) {
+            case LogArgType::signedInt:
+            case LogArgType::unsignedInt:
+            case LogArgType::pointer: {
+                if (end - p < 9) {
+                    return n;
+                }
+                uint64_t value;
+                memcpy(&value, p + 1, sizeof(value));
+                if (type == LogArgType::signedInt) {
+                    value = zigzagEncode(static_cast<int64_t>(value));
+                }
+                n += writeVarint(out + n, value);
+                p += 9;
+                break;
+            }
+            case LogArgType::floating:
+                if (end - p < 9) {
+                    return n;
+                }
+                memcpy(out + n, p + 1, 8);
+                n += 8;
+                p += 9;
+                break;
+            case LogArgType::character:
+                if (end - p < 2) {
+                    return n;
+                }
+                out[n++] = p[1];
+                p += 2;
+                break;
+            case LogArgType::string: {
+                if (end - p < 3) {
+                    return n;
+                }
+                uint16_t strLen;
+                memcpy(&strLen, p + 1, sizeof(strLen));
+                if (static_cast<size_t>(end - p - 3) < strLen) {
+                    return n;
+                }
+                n += writeVarint(out + n, strLen);
+                memcpy(out + n, p + 3, strLen);
+                n += strLen;
+                p += 3 + strLen;
+                break;
+            }
+            default:
+                return n;
+        }
+        types[typeCount++] = static_cast<char>(type);
+    }
+    return n;
+}
+
+// packLogArgs的逆过程：按调用点的参数类型从p开始读取，还原为formatLogArgs可以解码的形式。
+// 数据不完整、类型无法识别或输出空间不足时返回false
+inline bool unpackLogArgs(const char*& p, const char* end, const char* types, size_t typeCount,
+                          char* out, size_t outCapacity, size_t& outLen) {
+    size_t n = 0;
+    for (size_t i = 0; i < typeCount; ++i) {
+        LogArgType type = static_cast<LogArgType>(types[i]);
+        switch (type) {
+            case LogArgType::signedInt:
+            case LogArgType::unsignedInt:
+            case LogArgType::pointer: {
+                uint64_t value;
+                if (!readVarint(p, end, value) || outCapacity - n < 9) {
+                    return false;
+                }
+                if (type == LogArgType::signedInt) {
+                    value = static_cast<uint64_t>(zigzagDecode(value));
+                }
+                out[n] = static_cast<char>(type);
+                memcpy(out + n + 1, &value, sizeof(value));
+                n += 9;
+                break;
+            }
+            case LogArgType::floating:
+                if (end - p < 8 || outCapacity - n < 9) {
+                    return false;
+                }
+                out[n] = static_cast<char>(type);
+                memcpy(out + n + 1, p, 8);
+                n += 9;
+                p += 8;
+                break;
+            case LogArgType::character:
+                if (end - p < 1 || outCapacity - n < 2) {
+                    return false;
+                }
+                out[n] = static_cast<char>(type);
+                out[n + 1] = *p++;
+                n += 2;
+                break;
+            case LogArgType::string: {
+                uint64_t strLen;
+                if (!readVarint(p, end, strLen) || strLen > 0xFFFF || static_cast<uint64_t>(end - p) < strLen ||
+                    outCapacity - n < 3 + strLen) {
+                    return false;
+                }
+                uint16_t len16 = static_cast<uint16_t>(strLen);
+                out[n] = static_cast<char>(type);
+                memcpy(out + n + 1, &len16, sizeof(len16));
+                memcpy(out + n + 3, p, len16);
+                n += 3 + len16;
+                p += len16;
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    outLen = n;
+    return true;
+}
+
+#endif // BINARY_LOG_FORMAT_H
@@ -0,0 +1,68 @@
+#ifndef BINARY_LOG_SINK_H
+#define BINARY_LOG_SINK_H
+
+#include "log_sink.h"
+#include "binary_log_format.h"
+#include "log_file.h"
+#include "log_output_buffer.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 二进制文件输出目标：不格式化消息，按binary_log_format.h的格式写入时间戳增量、调用点ID和编码后的参数，
+// 格式字符串与文件名只在调用点表中出现一次。文件由winlog-decode（或BinaryLogDecoder）离线还原为文本。
+// 只注册二进制输出目标时，队列工作线程完全不做格式化和时间戳换算
+class WINLOG_API BinaryLogSink : public LogSink {
+public:
+    explicit BinaryLogSink(const char* path, LogLevel level = LogLevel::trace,
+                           DurabilityPolicy durability = DurabilityPolicy::flushPerBatch,
+                           int syncIntervalMs = 1000, size_t syncIntervalBytes = 1024 * 1024);
+    ~BinaryLogSink() override;
+
+    // 文件是否已成功打开
+    bool isOpen() const;
+
+    void write(const LogBatch& batch) override;
+    void flush() override;
+    bool sync() override;
+
+    LogSinkEncoding encoding() const override {
+        return LogSinkEncoding::binary;
+    }
+
+    // 底层日志文件（统计信息）
+    const LogFile& file() const {
+        return file_;
+    }
+
+private:
+    // 写入本文件的调用点表项
+    struct SiteState {
+        uint32_t id;                        // 文件中的调用点ID
+        const char* format;                 // 格式字符串（登记表或字符串字面量，进程内有效）
+        std::string file;
+        uint32_t line;
+        std::string types;                  // 最近一次写入的参数类型
+    };
+
+    // 本次会话首批写入CLOCK记录，以base为时间戳增量的起点
+    void writeClock(uint64_t base);
+
+    // 写入SITE记录
+    void writeSite(const SiteState& site);
+
+    // 取得调用点ID，首次出现或参数类型变化时写入SITE记录；未登记的格式字符串分配动态ID
+    uint32_t resolveSite(const BinaryEntryHeader& header, const char* file, const char* types, size_t typeCount);
+
+    LogFile file_;
+    LogOutputBuffer out_;                   // 本批转码后的记录
+    std::vector<SiteState> sites_;          // 已写入本文件的调用点
+    std::vector<uint32_t> siteSlots_;       // 登记调用点ID对应的sites_下标加1（0表示尚未写入）
+    std::unordered_map<const char*, uint32_t> dynamicSites_; // 未登记的格式字符串对应的sites_下标
+    uint32_t nextDynamicSite_;              // 下一个动态调用点ID
+    uint64_t lastTimestamp_;                // 上一条记录的时间戳（纳秒）
+    bool clockWritten_;                     // 是否已写入CLOCK记录
+};
+
+#endif // BINARY_LOG_SINK_H
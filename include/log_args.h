@@ -0,0 +1,148 @@
+#ifndef LOG_ARGS_H
+#define LOG_ARGS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Windows DLL导出宏定义
+#ifndef WINLOG_API
+#ifdef WINLOG_EXPORTS
+#define WINLOG_API __declspec(dllexport)
+#else
+#define WINLOG_API __declspec(dllimport)
+#endif
+#endif
+
+// 延迟格式化参数的类型标记
+enum class LogArgType : uint8_t {
+    signedInt = 1,      // 有符号整数（统一扩展为int64）
+    unsignedInt = 2,    // 无符号整数（统一扩展为uint64）
+    floating = 3,       // 浮点数（统一扩展为double）
+    character = 4,      // 字符
+    string = 5,         // 字符串（按值复制，[uint16长度 | 字节]）
+    pointer = 6         // 指针（只记录地址）
+};
+
+// 参数编码缓冲区：调用线程只把参数的原始字节依次写入，格式化留给工作线程
+// 编码格式：[类型标记 | 值字节]...，空间不足时停止写入后续参数
+class LogArgBuffer {
+public:
+    LogArgBuffer(char* data, size_t capacity) : data_(data), capacity_(capacity), size_(0) {}
+
+    void putSigned(int64_t value) {
+        putValue(LogArgType::signedInt, &value, sizeof(value));
+    }
+
+    void putUnsigned(uint64_t value) {
+        putValue(LogArgType::unsignedInt, &value, sizeof(value));
+    }
+
+    void putDouble(double value) {
+        putValue(LogArgType::floating, &value, sizeof(value));
+    }
+
+    void putChar(char value) {
+        putValue(LogArgType::character, &value, sizeof(value));
+    }
+
+    void putPointer(const void* value) {
+        uint64_t address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+        putValue(LogArgType::pointer, &address, sizeof(address));
+    }
+
+    void putString(const char* str, size_t len) {
+        if (!str) {
+            str = "(null)";
+            len = 6;
+        }
+        // 字符串超出剩余空间时截断
+        size_t header = 1 + sizeof(uint16_t);
+        if (size_ + header > capacity_) {
+            size_ = capacity_;
+            return;
+        }
+        size_t room = capacity_ - size_ - header;
+        if (len > room) {
+            len = room;
+        }
+        if (len > 0xFFFF) {
+            len = 0xFFFF;
+        }
+        uint16_t len16 = static_cast<uint16_t>(len);
+        data_[size_] = static_cast<char>(LogArgType::string);
+        memcpy(data_ + size_ + 1, &len16, sizeof(len16));
+        memcpy(data_ + size_ + header, str, len);
+        size_ += header + len;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+private:
+    void putValue(LogArgType type, const void* value, size_t len) {
+        if (size_ + 1 + len > capacity_) {
+            size_ = capacity_;
+            return;
+        }
+        data_[size_] = static_cast<char>(type);
+        memcpy(data_ + size_ + 1, value, len);
+        size_ += 1 + len;
+    }
+
+    char* data_;        // 编码目标（通常是LogEntry::message）
+    size_t capacity_;   // 目标容量
+    size_t size_;       // 已写入字节数
+};
+
+// 类型不受支持时用于触发static_assert
+template <typename T>
+struct LogArgUnsupported : std::false_type {};
+
+// 按参数的静态类型选择编码方式（编译期分派，运行期只有一次memcpy）
+template <typename T>
+inline void encodeLogArg(LogArgBuffer& buffer, const T& value) {
+    typedef typename std::decay<T>::type Decayed;
+    if constexpr (std::is_same<Decayed, bool>::value) {
+        buffer.putSigned(value ? 1 : 0);
+    } else if constexpr (std::is_same<Decayed, char>::value) {
+        buffer.putChar(value);
+    } else if constexpr (std::is_integral<Decayed>::value && std::is_signed<Decayed>::value) {
+        buffer.putSigned(static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral<Decayed>::value) {
+        buffer.putUnsigned(static_cast<uint64_t>(value));
+    } else if constexpr (std::is_enum<Decayed>::value) {
+        buffer.putSigned(static_cast<int64_t>(value));
+    } else if constexpr (std::is_floating_point<Decayed>::value) {
+        buffer.putDouble(static_cast<double>(value));
+    } else if constexpr (std::is_same<Decayed, std::string>::value) {
+        buffer.putString(value.data(), value.size());
+    } else if constexpr (std::is_same<Decayed, char*>::value || std::is_same<Decayed, const char*>::value) {
+        // 字符串字面量与C字符串按值复制，调用返回后原缓冲区可以立即复用
+        const char* str = value;
+        buffer.putString(str, str ? strlen(str) : 0);
+    } else if constexpr (std::is_pointer<Decayed>::value || std::is_null_pointer<Decayed>::value) {
+        buffer.putPointer(static_cast<const void*>(value));
+    } else {
+        static_assert(LogArgUnsupported<T>::value, "WinLog: unsupported log argument type");
+    }
+}
+
+inline void encodeLogArgs(LogArgBuffer&) {
+}
+
+template <typename First, typename... Rest>
+inline void encodeLogArgs(LogArgBuffer& buffer, const First& first, const Rest&... rest) {
+    encodeLogArg(buffer, first);
+    encodeLogArgs(buffer, rest...);
+}
+
+// 按printf风格的格式字符串解码参数并格式化（在工作线程中调用）
+// 参数类型与转换说明不一致时按参数的实际类型输出；参数不足时原样输出转换说明
+// 返回写入out的字符数（不含结尾'\0'）
+WINLOG_API size_t formatLogArgs(const char* format, const char* args, size_t argsLen, char* out, size_t outCapacity);
+
+#endif // LOG_ARGS_H
@@ -0,0 +1,52 @@
+#ifndef LOG_CLOCK_H
+#define LOG_CLOCK_H
+
+#include <cstdint>
+
+// Windows DLL导出宏定义
+#ifndef WINLOG_API
+#ifdef WINLOG_EXPORTS
+#define WINLOG_API __declspec(dllexport)
+#else
+#define WINLOG_API __declspec(dllimport)
+#endif
+#endif
+
+// 日志时间戳的时钟源
+enum class LogClockSource {
+    steady = 0,     // std::chrono::steady_clock（Windows下即QueryPerformanceCounter）
+    tsc = 1,        // CPU时间戳计数器（RDTSC），首次使用时相对steady_clock校准；非x86平台退化为steady
+    coarse = 2      // GetTickCount64（毫秒计数，分辨率约10~16毫秒，读取开销最低）
+};
+
+// 日志时钟：在调用点以极低开销读取原始计数，由工作线程按校准参数换算为墙上时间再格式化
+class WINLOG_API LogClock {
+public:
+    // 读取当前时钟源的原始计数（单调递增）
+    static uint64_t now();
+
+    // 切换时钟源并重新建立与系统时间的对应关系（WinLog::init会自动调用）。
+    // 切换前取得的计数无法再正确换算，有异步队列在运行时拒绝切换并返回false
+    static bool setSource(LogClockSource source);
+
+    static LogClockSource getSource();
+
+    // 距上次建立对应关系超过1秒时重新取系统时间作为基准点，TSC时钟源同时按更长的基线重新校准频率。
+    // 由异步队列的工作线程在每轮处理前调用，未到间隔时只读取一次steady_clock
+    static void refresh();
+
+    // 异步队列运行期间登记为计数的使用者，期间setSource拒绝切换
+    static void addConsumer();
+    static void removeConsumer();
+
+    // 将原始计数换算为自1970-01-01 00:00:00 UTC起的纳秒数
+    static int64_t toEpochNanos(uint64_t ticks);
+
+    // 每个原始计数对应的纳秒数
+    static double nanosPerTick();
+
+    // 当前的换算参数：epochNanos = epochBase + (ticks - tickBase) * nanosPerTick（供离线解码使用）
+    static void getMapping(uint64_t* tickBase, int64_t* epochBase, double* nanosPerTick);
+};
+
+#endif // LOG_CLOCK_H
@@ -0,0 +1,28 @@
+#ifndef LOG_COMPRESSOR_H
+#define LOG_COMPRESSOR_H
+
+#include "winlog.h"
+#include <cstddef>
+#include <cstdint>
+
+// 内置的日志块压缩器：LZ77类字节对齐格式（字面量长度/匹配长度共用一个标记字节，偏移量2字节，
+// 窗口64KB），不依赖外部库。日志文本重复度高，压缩速度远高于磁盘写入速度，压缩比通常在4~8倍
+
+// 压缩后数据的最大长度
+WINLOG_API size_t logCompressBound(size_t inputLen);
+
+// 压缩一个数据块，返回压缩后的字节数，输出空间不足时返回0
+WINLOG_API size_t logCompressBlock(const char* input, size_t inputLen, char* output, size_t outputCapacity);
+
+// 解压一个数据块，返回解压后的字节数，数据损坏或输出空间不足时返回0
+WINLOG_API size_t logDecompressBlock(const char* input, size_t inputLen, char* output, size_t outputCapacity);
+
+// 压缩文件（.wlz）：文件头"WLZ1"后依次为各数据块（原始长度、压缩长度、数据），原始长度为0表示结束。
+// 源文件按256KB分块压缩，压缩无效的块按原样存储。bytesIn/bytesOut可为nullptr
+WINLOG_API bool logCompressFile(const char* sourcePath, const char* targetPath,
+                                uint64_t* bytesIn = nullptr, uint64_t* bytesOut = nullptr);
+
+// 将.wlz文件解压为原始文件
+WINLOG_API bool logDecompressFile(const char* sourcePath, const char* targetPath);
+
+#endif // LOG_COMPRESSOR_H
@@ -0,0 +1,221 @@
+#ifndef LOG_FILE_H
+#define LOG_FILE_H
+
+#include "winlog.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 日志文件：直接使用系统文件句柄，按持久化策略决定何时写入操作系统、何时落盘。
+// 也可以内存映射方式写入（setMapping）：按大窗口映射文件，追加时直接复制到映射内存，不再经过进程内缓冲区和WriteFile；
+// 或以重叠I/O方式写入（setOverlapped）：写出只提交不等待，多个缓冲区轮流使用，写线程不阻塞在WriteFile中；
+// 或以无缓冲方式写入（setDirect）：按块对齐直接写到磁盘，不占用系统的文件缓存。
+// 非线程安全，由持有输出锁的线程串行调用
+class WINLOG_API LogFile {
+public:
+    explicit LogFile(size_t bufferSize = 256 * 1024);
+    ~LogFile();
+
+    // 禁止拷贝构造和赋值操作
+    LogFile(const LogFile&) = delete;
+    LogFile& operator=(const LogFile&) = delete;
+
+    // 以追加方式打开（不存在时创建），truncate为true时清空已有内容
+    bool open(const char* path, bool truncate = false);
+
+    // 以内存映射方式写入：每次映射windowBytes字节（向上取整到64KB）的窗口，写满后文件扩展一个窗口并重新映射。
+    // 数据由系统的页面缓存回写，syncInterval/syncOnError策略落盘时调用FlushViewOfFile和FlushFileBuffers；
+    // 关闭时文件截断为实际长度。windowBytes为0时使用缓冲写入。在open之前调用
+    void setMapping(size_t windowBytes);
+
+    bool isMapped() const {
+        return mapWindow_ > 0;
+    }
+
+    // 以重叠I/O方式写入：进程内缓冲区扩为inFlight个，写满或批次结束时提交异步写入后立即切换到下一个缓冲区，
+    // 最多inFlight个写入同时进行，只有全部缓冲区都在写入中时才等待。flush和sync等待全部写入完成。
+    // 文件末尾按4MB一段超前扩展，使写入不在文件末尾之后；关闭时截断为实际长度，异常退出留下的零填充尾部在下次打开时截掉。
+    // 系统不支持时打开后自动改用同步写入（isOverlapped返回false）。inFlight为0时使用同步写入。在open之前调用
+    void setOverlapped(size_t inFlight);
+
+    bool isOverlapped() const {
+        return overlapped_;
+    }
+
+    // 以无缓冲方式写入（FILE_FLAG_NO_BUFFERING）：数据不经过系统的文件缓存，从两个按页对齐的缓冲区按4KB的块写出，
+    // 一个写入中时填充另一个（重叠I/O）。每次写出补零到块边界，不足一个块的尾部留在下一个缓冲区开头，下次连同新数据重写；
+    // 文件空间和文件末尾按preallocateBytes一段段向后扩展，flush和sync后仍保留，关闭时文件截断为实际长度，
+    // 异常退出留下的零填充尾部在下次打开时截掉。
+    // 系统或文件系统不支持时打开后自动改用重叠I/O写入（isDirect返回false）。preallocateBytes为0时不使用。在open之前调用
+    void setDirect(size_t preallocateBytes);
+
+    bool isDirect() const {
+        return direct_;
+    }
+
+    // 为文件预留磁盘空间（不改变文件长度），减少追加写入时的空间分配
+    bool preallocate(uint64_t bytes);
+
+    // 写出缓冲数据后关闭
+    void close();
+
+    bool isOpen() const;
+
+    // 设置持久化策略
+    void setDurability(DurabilityPolicy policy, int syncIntervalMs, size_t syncIntervalBytes);
+
+    // 写入一整批日志，并按持久化策略写入操作系统或落盘；containsError表示批次中含error/critical级别日志
+    bool writeBatch(const char* data, size_t len, bool containsError);
+
+    // 追加到进程内缓冲区，缓冲区不足时先写出；一批数据分多段追加时，最后调用endBatch
+    bool append(const char* data, size_t len);
+
+    // 结束一批数据的追加，按持久化策略写入操作系统或落盘
+    bool endBatch(bool containsError);
+
+    // 将进程内缓冲的数据写入操作系统（重叠I/O方式下等待全部写入完成）
+    bool flush();
+
+    // 写入操作系统并调用FlushFileBuffers落盘
+    bool sync();
+
+    // 当前文件长度（包括仍在进程内缓冲的数据）
+    uint64_t fileSize() const {
+        return fileSize_;
+    }
+
+    // 统计信息
+    uint64_t bytesWritten() const {
+        return bytesWritten_;
+    }
+
+    uint64_t writeCalls() const {
+        return writeCalls_;
+    }
+
+    uint64_t syncCalls() const {
+        return syncCalls_;
+    }
+
+    // 因全部缓冲区都在写入中而等待的次数（重叠I/O方式）
+    uint64_t overlappedWaits() const {
+        return overlappedWaits_;
+    }
+
+    // 提交时已同步完成的写入次数（重叠I/O方式，系统未能异步执行）
+    uint64_t synchronousWrites() const {
+        return synchronousWrites_;
+    }
+
+    // 预留文件空间的次数（无缓冲方式）
+    uint64_t preallocations() const {
+        return preallocations_;
+    }
+
+    // 映射窗口的次数（内存映射方式）
+    uint64_t mapCalls() const {
+        return mapCalls_;
+    }
+
+    // 打开时从上次异常退出留下的文件尾部截掉的字节数（内存映射和无缓冲方式：未写入的零填充部分和写了一半的行）
+    uint64_t recoveredBytes() const {
+        return recoveredBytes_;
+    }
+
+private:
+    // 调用WriteFile写出全部数据
+    bool writeToHandle(const char* data, size_t len);
+
+    // 将进程内缓冲区交给操作系统：同步方式直接写出，重叠I/O方式只提交不等待
+    bool writeBuffer();
+
+    // 重叠I/O方式：提交当前缓冲区并切换到下一个缓冲区（下一个仍在写入中时等待其完成）
+    bool submitSlot();
+
+    // 等待一个缓冲区的写入完成
+    bool waitSlot(size_t index);
+
+    // 等待全部写入完成
+    bool waitAllSlots();
+
+    // 创建和释放重叠I/O的缓冲区与事件
+    bool createSlots();
+    void releaseSlots();
+
+    // 以普通方式打开（handle_为该句柄）并截掉异常退出留下的零填充尾部
+    bool openAndRecover(const char* path, bool truncate);
+
+    // 无缓冲方式打开：先以普通方式截掉异常退出留下的尾部并读出不足一个块的部分，再以无缓冲方式重新打开。
+    // 无法以无缓冲方式打开时返回false
+    bool openDirect(const char* path, bool truncate);
+
+    // 无缓冲方式：写入范围超过已预留的空间时再预留一段，并将文件末尾移到预留空间的末尾
+    void reserveSpace(uint64_t end);
+
+    // 将文件截断为实际写入的长度（内存映射、重叠I/O和无缓冲方式的文件长度会超过实际数据）
+    bool truncateToSize();
+
+    // 设置文件长度（FileEndOfFileInfo）
+    bool setEndOfFile(uint64_t size);
+
+    // 重叠I/O方式：写入范围超过文件末尾时将文件末尾向后扩展一段
+    void extendEndOfFile(uint64_t end);
+
+    // 映射包含当前文件末尾的下一个窗口，映射长度超过文件长度时文件随之扩展
+    bool mapNextWindow();
+
+    // 解除当前窗口的映射
+    void unmapWindow();
+
+    // 将当前窗口中尚未落盘的部分交给操作系统写回磁盘
+    bool flushView();
+
+    // 截掉上次异常退出时留在文件尾部的零填充窗口和写了一半的行
+    void recoverTail();
+
+    void* handle_;                          // 文件句柄（HANDLE）
+    std::unique_ptr<char[]> buffer_;        // 进程内写缓冲区
+    size_t capacity_;                       // 缓冲区容量
+    size_t size_;                           // 缓冲区中待写出的字节数
+    uint64_t fileSize_;                     // 打开时的文件长度加上之后追加的字节数
+
+    DurabilityPolicy policy_;               // 持久化策略
+    std::chrono::milliseconds syncInterval_;// syncInterval策略的时间间隔
+    size_t syncIntervalBytes_;              // syncInterval策略的字节间隔
+    std::chrono::steady_clock::time_point lastSync_; // 上次落盘时间
+    size_t bytesSinceSync_;                 // 上次落盘后写入的字节数
+
+    uint64_t bytesWritten_;                 // 写入操作系统的总字节数
+    uint64_t writeCalls_;                   // WriteFile调用次数
+    uint64_t syncCalls_;                    // FlushFileBuffers调用次数
+
+    // 重叠I/O方式
+    struct OverlappedSlot;
+    size_t slotCount_;                      // 缓冲区个数，0表示同步写入
+    bool overlapped_;                       // 当前是否以重叠I/O方式写入
+    std::unique_ptr<OverlappedSlot[]> slots_; // 各缓冲区及其写入状态
+    size_t currentSlot_;                    // 正在填充的缓冲区
+    uint64_t writeOffset_;                  // 下一次提交的写入位置
+    uint64_t endOfFile_;                    // 文件在磁盘上的长度（重叠I/O方式下超前于fileSize_）
+    uint64_t overlappedWaits_;              // 等待缓冲区写入完成的次数
+    uint64_t synchronousWrites_;            // 提交时已同步完成的写入次数
+
+    // 无缓冲方式（使用重叠I/O的缓冲区）
+    size_t directExtent_;                   // 每次预留的空间，0表示不使用
+    bool direct_;                           // 当前是否以无缓冲方式写入
+    size_t directCarry_;                    // 当前缓冲区开头已写出过的尾部字节数
+    uint64_t allocatedSize_;                // 已预留的文件空间
+    uint64_t preallocations_;               // 预留文件空间的次数
+
+    // 内存映射方式
+    size_t mapWindow_;                      // 窗口大小，0表示缓冲写入
+    void* mapping_;                         // 文件映射对象（HANDLE）
+    char* view_;                            // 当前窗口的映射地址
+    uint64_t viewOffset_;                   // 当前窗口在文件中的起始位置
+    uint64_t syncedSize_;                   // 已落盘的文件长度
+    uint64_t mapCalls_;                     // 映射窗口的次数
+    uint64_t recoveredBytes_;               // 打开时截掉的尾部字节数
+};
+
+#endif // LOG_FILE_H
@@ -0,0 +1,138 @@
+#ifndef LOG_OUTPUT_BUFFER_H
+#define LOG_OUTPUT_BUFFER_H
+
+#include "winlog.h"
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+// 日志级别标签
+inline const char* logLevelTag(LogLevel level, size_t& len) {
+    switch (level) {
+        case LogLevel::trace:
+            len = 5;
+            return "TRACE";
+        case LogLevel::debug:
+            len = 5;
+            return "DEBUG";
+        case LogLevel::info:
+            len = 4;
+            return "INFO";
+        case LogLevel::warn:
+            len = 4;
+            return "WARN";
+        case LogLevel::error:
+            len = 5;
+            return "ERROR";
+        case LogLevel::critical:
+            len = 8;
+            return "CRITICAL";
+        default:
+            len = 7;
+            return "UNKNOWN";
+    }
+}
+
+// 可复用的输出缓冲区：一批日志行依次追加到同一块连续内存中，整批一次写出。
+// 容量只增不减，稳定状态下追加不会触发任何堆分配
+class LogOutputBuffer {
+public:
+    explicit LogOutputBuffer(size_t initialCapacity = 64 * 1024) :
+        data_(new char[initialCapacity]),
+        capacity_(initialCapacity),
+        size_(0) {
+    }
+
+    // 禁止拷贝构造和赋值操作
+    LogOutputBuffer(const LogOutputBuffer&) = delete;
+    LogOutputBuffer& operator=(const LogOutputBuffer&) = delete;
+
+    void append(const char* data, size_t len) {
+        reserve(size_ + len);
+        memcpy(data_.get() + size_, data, len);
+        size_ += len;
+    }
+
+    void append(char c) {
+        reserve(size_ + 1);
+        data_[size_++] = c;
+    }
+
+    // 整数直接转换到缓冲区中，不经过临时字符串
+    void appendInt(long long value) {
+        reserve(size_ + 24);
+        std::to_chars_result result = std::to_chars(data_.get() + size_, data_.get() + capacity_, value);
+        size_ = static_cast<size_t>(result.ptr - data_.get());
+    }
+
+    // 追加一条完整日志行："[时间] [级别] (文件:行号) 消息\n"
+    void appendLine(const char* time, size_t timeLen, LogLevel level,
+                    const char* file, size_t fileLen, int line,
+                    const char* message, size_t messageLen) {
+        size_t levelLen = 0;
+        const char* levelTag = logLevelTag(level, levelLen);
+        // 一次性预留整行所需空间（行号最多11个字符）
+        reserve(size_ + timeLen + levelLen + fileLen + messageLen + 32);
+
+        append('[');
+        append(time, timeLen);
+        append("] [", 3);
+        append(levelTag, levelLen);
+        append("] ", 2);
+        if (fileLen > 0 && line > 0) {
+            append('(');
+            append(file, fileLen);
+            append(':');
+            appendInt(line);
+            append(") ", 2);
+        }
+        append(message, messageLen);
+        append('\n');
+    }
+
+    // 确保容量不小于required，不足时按倍数扩容
+    void reserve(size_t required) {
+        if (required <= capacity_) {
+            return;
+        }
+        size_t newCapacity = capacity_ > 0 ? capacity_ * 2 : 256;
+        while (newCapacity < required) {
+            newCapacity *= 2;
+        }
+        std::unique_ptr<char[]> newData(new char[newCapacity]);
+        memcpy(newData.get(), data_.get(), size_);
+        data_ = std::move(newData);
+        capacity_ = newCapacity;
+    }
+
+    void clear() {
+        size_ = 0;
+    }
+
+    // 与另一个缓冲区交换内容（双缓冲时使用，不复制数据）
+    void swap(LogOutputBuffer& other) {
+        std::swap(data_, other.data_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+    }
+
+    const char* data() const {
+        return data_.get();
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    std::unique_ptr<char[]> data_;     // 缓冲区
+    size_t capacity_;                  // 当前容量
+    size_t size_;                      // 已写入字节数
+};
+
+#endif // LOG_OUTPUT_BUFFER_H
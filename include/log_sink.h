@@ -0,0 +1,276 @@
+#ifndef LOG_SINK_H
+#define LOG_SINK_H
+
+#include "winlog.h"
+#include "log_file.h"
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 一条已格式化的日志行：位于整批缓冲区中的[offset, offset + length)，包含结尾的换行符
+struct LogLine {
+    size_t offset;
+    size_t length;
+    LogLevel level;
+};
+
+// 一批已格式化的日志：所有行连续存放在同一块内存中，由全部输出目标共享，每行只格式化一次
+struct LogBatch {
+    const char* data;       // 整批日志文本
+    size_t size;            // 整批日志字节数
+    const LogLine* lines;   // 每行的位置与级别
+    size_t count;           // 行数
+    LogLevel minLevel;      // 批次中的最低级别
+    LogLevel maxLevel;      // 批次中的最高级别
+
+    // 将级别不低于level的行按连续区间合并后依次交给fn(const char* data, size_t len)，
+    // 整批都满足时只调用一次
+    template <typename Fn>
+    void forEachRun(LogLevel level, Fn&& fn) const {
+        if (count == 0 || maxLevel < level) {
+            return;
+        }
+        if (minLevel >= level) {
+            fn(data, size);
+            return;
+        }
+        size_t runStart = 0;
+        size_t runEnd = 0;
+        bool inRun = false;
+        for (size_t i = 0; i < count; ++i) {
+            const LogLine& line = lines[i];
+            if (line.level >= level) {
+                if (!inRun) {
+                    runStart = line.offset;
+                    inRun = true;
+                }
+                runEnd = line.offset + line.length;
+            } else if (inRun) {
+                fn(data + runStart, runEnd - runStart);
+                inRun = false;
+            }
+        }
+        if (inRun) {
+            fn(data + runStart, runEnd - runStart);
+        }
+    }
+};
+
+// 输出目标接收的日志编码
+enum class LogSinkEncoding {
+    text = 0,       // 格式化后的文本行（"[时间] [级别] (文件:行号) 消息\n"）
+    binary = 1      // 未格式化的二进制记录（每行为一个BinaryEntryHeader加消息，见binary_log_format.h）
+};
+
+// 异步模式下输出目标缓冲区已满时的处理策略
+enum class SinkOverflowPolicy {
+    block = 0,      // 等待该输出目标的写线程腾出空间（不丢日志，慢输出目标会拖慢整个流水线）
+    drop = 1        // 丢弃放不下的日志并计入droppedLines（慢输出目标只丢自己的日志）
+};
+
+// 输出目标的统计信息
+struct SinkStats {
+    uint64_t batchesWritten;    // 写入的批次数
+    uint64_t linesWritten;      // 写入的行数
+    uint64_t bytesWritten;      // 写入的字节数
+    uint64_t droppedLines;      // 因缓冲区已满被丢弃的行数
+    uint64_t totalWriteNanos;   // write调用的累计耗时（纳秒）
+    uint64_t maxWriteNanos;     // 单次write调用的最长耗时（纳秒）
+    
+    SinkStats() : batchesWritten(0), linesWritten(0), bytesWritten(0), droppedLines(0),
+                  totalWriteNanos(0), maxWriteNanos(0) {}
+};
+
+class LogSinkWorker;
+
+// 输出目标接口：同一输出目标不会被并发调用。同步模式下在调用线程中持有输出锁调用；
+// 异步模式下每个输出目标有自己的有界缓冲区和写线程，由队列的工作线程投递已格式化的整批日志，
+// 慢输出目标不会拖慢其他输出目标。每个输出目标有自己的最低级别，低于该级别的行不会交给它
+class WINLOG_API LogSink {
+public:
+    explicit LogSink(LogLevel level = LogLevel::trace);
+    virtual ~LogSink();
+
+    // 禁止拷贝构造和赋值操作
+    LogSink(const LogSink&) = delete;
+    LogSink& operator=(const LogSink&) = delete;
+
+    // 写入一整批日志，实现者应只处理级别不低于getLevel()的行（可使用LogBatch::forEachRun）
+    virtual void write(const LogBatch& batch) = 0;
+
+    // 将缓冲的数据写出（WinLog::flush时调用）
+    virtual void flush();
+
+    // 写出缓冲的数据并落盘（WinLog::waitDurable时调用），默认只调用flush；失败时返回false
+    virtual bool sync();
+
+    // 本输出目标接收的编码；只有文本输出目标时日志库才格式化消息
+    virtual LogSinkEncoding encoding() const {
+        return LogSinkEncoding::text;
+    }
+
+    // 设置和获取本输出目标的最低级别（可在任意线程中调用）
+    void setLevel(LogLevel level) {
+        level_.store(level, std::memory_order_relaxed);
+    }
+
+    LogLevel getLevel() const {
+        return level_.load(std::memory_order_relaxed);
+    }
+    
+    // 异步模式下写线程缓冲区的容量（字节）与溢出策略，在注册到日志库之前设置
+    void setBufferCapacity(size_t bytes) {
+        bufferCapacity_ = bytes;
+    }
+    
+    size_t getBufferCapacity() const {
+        return bufferCapacity_;
+    }
+    
+    void setOverflowPolicy(SinkOverflowPolicy policy) {
+        overflowPolicy_ = policy;
+    }
+    
+    SinkOverflowPolicy getOverflowPolicy() const {
+        return overflowPolicy_;
+    }
+    
+    // 统计信息（可在任意线程中调用）
+    SinkStats getStats() const;
+    void resetStats();
+    
+    // 写入一批日志并记录统计信息（由日志库调用）
+    void submit(const LogBatch& batch);
+
+private:
+    friend class LogSinkWorker;
+    
+    std::atomic<LogLevel> level_;       // 最低输出级别
+    size_t bufferCapacity_;             // 写线程缓冲区容量
+    SinkOverflowPolicy overflowPolicy_; // 缓冲区已满时的处理策略
+    
+    // 统计信息
+    std::atomic<uint64_t> batchesWritten_;
+    std::atomic<uint64_t> linesWritten_;
+    std::atomic<uint64_t> bytesWritten_;
+    std::atomic<uint64_t> droppedLines_;
+    std::atomic<uint64_t> totalWriteNanos_;
+    std::atomic<uint64_t> maxWriteNanos_;
+};
+
+// 文件输出目标：整批日志合并为一次写入，按持久化策略决定何时落盘；
+// mappedWindowBytes非0时以内存映射方式写入（见LogFile::setMapping），
+// overlappedWrites非0时以重叠I/O方式写入（见LogFile::setOverlapped），
+// directPreallocateBytes非0时以无缓冲方式写入并按此大小预留文件空间（见LogFile::setDirect）
+class WINLOG_API FileLogSink : public LogSink {
+public:
+    explicit FileLogSink(const char* path, LogLevel level = LogLevel::trace,
+                         DurabilityPolicy durability = DurabilityPolicy::flushPerBatch,
+                         int syncIntervalMs = 1000, size_t syncIntervalBytes = 1024 * 1024,
+                         size_t mappedWindowBytes = 0, size_t overlappedWrites = 0,
+                         size_t directPreallocateBytes = 0);
+    ~FileLogSink() override;
+
+    // 文件是否已成功打开
+    bool isOpen() const;
+
+    void write(const LogBatch& batch) override;
+    void flush() override;
+    bool sync() override;
+
+    // 底层日志文件（统计信息）
+    const LogFile& file() const {
+        return file_;
+    }
+
+private:
+    LogFile file_;
+};
+
+// 内存映射文件输出目标：按窗口（默认64MB）映射日志文件，整批日志直接复制到映射内存，
+// 没有进程内缓冲区的复制，也没有WriteFile调用，由页面缓存回写；syncInterval/syncOnError策略调用FlushViewOfFile落盘。
+// 关闭时文件截断为实际长度，异常退出留下的零填充尾部和写了一半的行在下次打开时截掉
+class WINLOG_API MappedFileLogSink : public FileLogSink {
+public:
+    explicit MappedFileLogSink(const char* path, size_t windowBytes = 64 * 1024 * 1024,
+                               LogLevel level = LogLevel::trace,
+                               DurabilityPolicy durability = DurabilityPolicy::flushPerBatch,
+                               int syncIntervalMs = 1000, size_t syncIntervalBytes = 1024 * 1024) :
+        FileLogSink(path, level, durability, syncIntervalMs, syncIntervalBytes, windowBytes > 0 ? windowBytes : 1) {}
+};
+
+// 重叠I/O文件输出目标：每批日志提交异步写入后立即返回，最多inFlight批同时写入，
+// 写线程不必等待内核复制数据，可以继续接收下一批；系统不支持重叠I/O时改用同步写入
+class WINLOG_API OverlappedFileLogSink : public FileLogSink {
+public:
+    explicit OverlappedFileLogSink(const char* path, size_t inFlight = 4, LogLevel level = LogLevel::trace,
+                                   DurabilityPolicy durability = DurabilityPolicy::flushPerBatch,
+                                   int syncIntervalMs = 1000, size_t syncIntervalBytes = 1024 * 1024) :
+        FileLogSink(path, level, durability, syncIntervalMs, syncIntervalBytes, 0, inFlight > 0 ? inFlight : 1) {}
+};
+
+// 无缓冲文件输出目标：日志不经过系统的文件缓存，从两个按页对齐的缓冲区按4KB块直接写到磁盘，
+// 大量日志不会挤占其他进程的文件缓存，也不会在缓存回写时造成突发的写入停顿；文件空间每次预留preallocateBytes（默认64MB）。
+// 每批日志的最后一个块补零写出，flush和关闭时文件截断为实际长度；文件系统不支持时改用重叠I/O写入
+class WINLOG_API DirectFileLogSink : public FileLogSink {
+public:
+    explicit DirectFileLogSink(const char* path, size_t preallocateBytes = 64 * 1024 * 1024,
+                               LogLevel level = LogLevel::trace,
+                               DurabilityPolicy durability = DurabilityPolicy::flushPerBatch,
+                               int syncIntervalMs = 1000, size_t syncIntervalBytes = 1024 * 1024) :
+        FileLogSink(path, level, durability, syncIntervalMs, syncIntervalBytes, 0, 0,
+                    preallocateBytes > 0 ? preallocateBytes : 1) {}
+};
+
+// 控制台输出目标：警告及以上级别写入stderr，其余写入stdout，连续写往同一个流的行合并为一次写入
+class WINLOG_API ConsoleLogSink : public LogSink {
+public:
+    explicit ConsoleLogSink(LogLevel level = LogLevel::trace);
+
+    void write(const LogBatch& batch) override;
+    void flush() override;
+};
+
+// 内存输出目标：保留最近capacity行日志，供测试或诊断界面读取
+class WINLOG_API MemoryLogSink : public LogSink {
+public:
+    explicit MemoryLogSink(size_t capacity = 1024, LogLevel level = LogLevel::trace);
+
+    void write(const LogBatch& batch) override;
+
+    // 返回当前保留的日志行（不含结尾的换行符）
+    std::vector<std::string> lines() const;
+
+    // 当前保留的行数
+    size_t size() const;
+
+    // 累计收到的行数（包括已被淘汰的行）
+    uint64_t totalLines() const;
+
+    void clear();
+
+private:
+    size_t capacity_;                   // 最多保留的行数
+    std::deque<std::string> lines_;     // 最近的日志行
+    uint64_t totalLines_;               // 累计收到的行数
+    mutable std::mutex mutex_;          // 保护lines_和totalLines_（读取可能来自其他线程）
+};
+
+// 回调输出目标：每行日志调用一次用户回调，text不含结尾的换行符，只在回调期间有效
+class WINLOG_API CallbackLogSink : public LogSink {
+public:
+    using Callback = std::function<void(LogLevel level, const char* text, size_t length)>;
+
+    explicit CallbackLogSink(Callback callback, LogLevel level = LogLevel::trace);
+
+    void write(const LogBatch& batch) override;
+
+private:
+    Callback callback_;
+};
+
+#endif // LOG_SINK_H
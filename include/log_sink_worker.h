@@ -0,0 +1,70 @@
+#ifndef LOG_SINK_WORKER_H
+#define LOG_SINK_WORKER_H
+
+#include "log_sink.h"
+#include "log_output_buffer.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 输出目标的写线程：队列工作线程把已格式化的整批日志复制到有界的待写缓冲区后立即返回，
+// 写线程与之交换双缓冲后在锁外调用输出目标，慢输出目标只会占满自己的缓冲区。
+// flush和sync登记请求后由写线程在两批之间代为调用输出目标，持续写入时也不会一直等不到空闲；
+// 同时登记的多个请求只调用一次
+class WINLOG_API LogSinkWorker {
+public:
+    explicit LogSinkWorker(const std::shared_ptr<LogSink>& sink);
+    ~LogSinkWorker();
+
+    // 禁止拷贝构造和赋值操作
+    LogSinkWorker(const LogSinkWorker&) = delete;
+    LogSinkWorker& operator=(const LogSinkWorker&) = delete;
+
+    // 投递一批日志：只复制通过输出目标级别过滤的行；缓冲区已满时按输出目标的溢出策略等待或丢弃
+    void post(const LogBatch& batch);
+
+    // 等待已投递的日志全部写出后调用输出目标的flush，超时返回false（timeoutMs为-1时无限等待）
+    bool flush(int timeoutMs = -1);
+
+    // 等待已投递的日志全部写出后调用输出目标的sync落盘，超时或落盘失败时返回false
+    bool sync(int timeoutMs = -1);
+
+    // 写出剩余日志后停止写线程
+    void stop();
+
+    const std::shared_ptr<LogSink>& sink() const {
+        return sink_;
+    }
+
+private:
+    void writerThread();
+
+    // 登记flush或sync请求并等待写线程完成
+    bool request(bool sync, int timeoutMs);
+
+    std::shared_ptr<LogSink> sink_;
+    size_t capacity_;                       // 待写缓冲区容量（字节）
+    SinkOverflowPolicy policy_;             // 缓冲区已满时的处理策略
+
+    LogOutputBuffer pending_;               // 待写缓冲区（由mutex_保护）
+    std::vector<LogLine> pendingLines_;
+    LogLevel pendingMinLevel_;
+    LogLevel pendingMaxLevel_;
+    LogOutputBuffer writing_;               // 写线程正在写出的缓冲区（只由写线程访问）
+    std::vector<LogLine> writingLines_;
+
+    bool busy_;                             // 写线程是否正在调用输出目标
+    uint64_t requests_;                     // 累计登记的flush/sync请求数
+    uint64_t requestsDone_;                 // 已完成的请求数
+    bool syncRequested_;                    // 尚未处理的请求中是否有sync
+    bool lastRequestOk_;                    // 最近一次完成的请求是否成功
+    bool stop_;
+    std::mutex mutex_;
+    std::condition_variable dataReady_;     // 待写缓冲区有数据或需要停止
+    std::condition_variable spaceReady_;    // 待写缓冲区已被取走或写线程空闲
+    std::thread thread_;
+};
+
+#endif // LOG_SINK_WORKER_H
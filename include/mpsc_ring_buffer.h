@@ -0,0 +1,164 @@
+#ifndef MPSC_RING_BUFFER_H
+#define MPSC_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// 缓存行大小，用于隔离生产者与消费者的热点字段，避免伪共享
+#define WINLOG_CACHE_LINE_SIZE 64
+
+// 无锁有界多生产者单消费者环形缓冲区
+// 每个槽位携带一个序列号：生产者通过CAS抢占写入位置后写入数据并发布序列号，
+// 消费者根据序列号判断槽位是否可读，整个过程不需要任何互斥锁
+template <typename T>
+class MpscRingBuffer {
+public:
+    // 容量向上取整为2的幂，便于使用位掩码计算槽位下标
+    explicit MpscRingBuffer(size_t capacity) :
+        capacity_(roundUpToPowerOfTwo(capacity)),
+        mask_(capacity_ - 1),
+        slots_(new Slot[capacity_]),
+        enqueuePos_(0),
+        dequeuePos_(0) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // 禁止拷贝构造和赋值操作
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+    MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+    // 尝试写入（任意生产者线程），缓冲区已满时返回false且不会移动value；position非空时返回抢占的写入位置
+    bool tryPush(T&& value, size_t* position = nullptr) {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                // 槽位空闲，尝试抢占该写入位置
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // 槽位尚未被消费者释放，缓冲区已满
+                return false;
+            } else {
+                // 其他生产者已抢先占用，重新读取写入位置
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value = std::move(value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        if (position) {
+            *position = pos;
+        }
+        return true;
+    }
+
+    // 尝试一次写入count个元素（任意生产者线程），占用连续的写入位置，其他生产者的元素不会插入其间；
+    // 剩余空位不足count个时返回false且不会移动任何元素；position非空时返回第一个元素的写入位置
+    bool tryPushBatch(T* values, size_t count, size_t* position = nullptr) {
+        if (count == 0 || count > capacity_) {
+            return false;
+        }
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            // 消费者按顺序释放槽位，最后一个槽位已释放时前面的槽位一定也已释放
+            Slot& last = slots_[(pos + count - 1) & mask_];
+            size_t seq = last.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + count - 1);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            Slot& slot = slots_[(pos + i) & mask_];
+            slot.value = std::move(values[i]);
+            slot.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        if (position) {
+            *position = pos;
+        }
+        return true;
+    }
+
+    // 尝试读取（仅限唯一的消费者线程），缓冲区为空时返回false
+    bool tryPop(T& out) {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[pos & mask_];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+            // 槽位为空，或生产者已抢占但尚未发布
+            return false;
+        }
+
+        out = std::move(slot.value);
+        // 释放槽位，供下一轮环绕的生产者使用
+        slot.sequence.store(pos + capacity_, std::memory_order_release);
+        dequeuePos_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 当前元素数量（近似值，并发写入时仅供参考）
+    size_t size() const {
+        size_t head = dequeuePos_.load(std::memory_order_acquire);
+        size_t tail = enqueuePos_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    // 累计抢占的写入位置数量（即累计成功入队次数）
+    size_t totalPushed() const {
+        return enqueuePos_.load(std::memory_order_relaxed);
+    }
+
+    // 累计读取的元素数量
+    size_t totalPopped() const {
+        return dequeuePos_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;  // 槽位序列号
+        T value;                       // 槽位数据
+    };
+
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t capacity_;            // 槽位数量（2的幂）
+    const size_t mask_;                // 下标掩码
+    std::unique_ptr<Slot[]> slots_;    // 槽位数组
+
+    // 生产者与消费者的位置计数器分别独占缓存行
+    alignas(WINLOG_CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos_;
+    alignas(WINLOG_CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos_;
+};
+
+#endif // MPSC_RING_BUFFER_H
@@ -0,0 +1,191 @@
+#ifndef RECORD_RING_BUFFER_H
+#define RECORD_RING_BUFFER_H
+
+#include "mpsc_ring_buffer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// 无锁多生产者单消费者变长记录环形缓冲区
+// 记录按实际长度紧密排列在一块连续的字节区域中：[前缀 | 负载]，整体按8字节对齐。
+// 生产者通过CAS预留空间、写入负载后发布前缀中的长度；消费者原地读取负载，
+// 读取完成后将该记录占用的字节清零再归还空间，因此空闲区域始终为全零，
+// 消费者看到非零长度即可确认记录已发布。
+class RecordRingBuffer {
+public:
+    // 容量（字节）向上取整为2的幂
+    explicit RecordRingBuffer(size_t capacityBytes) :
+        capacity_(roundUpToPowerOfTwo(capacityBytes)),
+        mask_(capacity_ - 1),
+        buffer_(new char[capacity_]()),
+        tail_(0),
+        committed_(0),
+        head_(0),
+        popped_(0) {
+    }
+
+    // 禁止拷贝构造和赋值操作
+    RecordRingBuffer(const RecordRingBuffer&) = delete;
+    RecordRingBuffer& operator=(const RecordRingBuffer&) = delete;
+
+    // 记录占用的总字节数（前缀 + 负载，按8字节对齐）
+    static size_t recordSize(size_t payloadLen) {
+        return (sizeof(RecordPrefix) + payloadLen + 7) & ~static_cast<size_t>(7);
+    }
+
+    // 生产者：预留payloadLen字节的负载空间，空间不足时返回nullptr
+    // 若记录无法放入缓冲区尾部的剩余连续空间，会先写入一条填充记录再从头部开始；
+    // endPosition非空时返回记录末尾的累计字节位置（消费者的读取位置越过它即表示该记录已被取出）
+    char* tryReserve(size_t payloadLen, size_t* endPosition = nullptr) {
+        size_t total = recordSize(payloadLen);
+        if (total > capacity_ / 2) {
+            return nullptr;
+        }
+
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        size_t need;
+        for (;;) {
+            size_t head = head_.load(std::memory_order_acquire);
+            if (pos < head) {
+                pos = tail_.load(std::memory_order_relaxed);
+                continue;
+            }
+            size_t contiguous = capacity_ - (pos & mask_);
+            need = total <= contiguous ? total : contiguous + total;
+            if (pos + need - head > capacity_) {
+                return nullptr;
+            }
+            if (tail_.compare_exchange_weak(pos, pos + need, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        if (need != total) {
+            // 尾部剩余空间不足，写入填充记录，消费者读到后直接跳过
+            RecordPrefix* padding = prefixAt(pos);
+            padding->payloadLen = 0;
+            padding->size.store(static_cast<uint32_t>(need - total) | PADDING_FLAG, std::memory_order_release);
+            pos += need - total;
+        }
+
+        RecordPrefix* prefix = prefixAt(pos);
+        prefix->payloadLen = static_cast<uint32_t>(payloadLen);
+        if (endPosition) {
+            *endPosition = pos + total;
+        }
+        return reinterpret_cast<char*>(prefix + 1);
+    }
+
+    // 生产者：发布tryReserve返回的记录；一条记录中打包了多个逻辑条目时，count为条目数（计入size与totalCommitted）
+    void commit(char* payload, size_t count = 1) {
+        RecordPrefix* prefix = reinterpret_cast<RecordPrefix*>(payload) - 1;
+        uint32_t total = static_cast<uint32_t>(recordSize(prefix->payloadLen));
+        // 与tail_位于同一缓存行，CAS之后该行已被当前生产者独占，计数几乎没有额外开销
+        committed_.fetch_add(count, std::memory_order_relaxed);
+        prefix->size.store(total, std::memory_order_release);
+    }
+
+    // 消费者：原地读取下一条已发布记录的负载，暂无可读记录时返回nullptr
+    const char* peek(size_t& payloadLen) {
+        for (;;) {
+            size_t pos = head_.load(std::memory_order_relaxed);
+            RecordPrefix* prefix = prefixAt(pos);
+            uint32_t size = prefix->size.load(std::memory_order_acquire);
+            if (size == 0) {
+                return nullptr;
+            }
+            if (size & PADDING_FLAG) {
+                // 跳过填充记录（填充区域除前缀外本来就是全零）
+                prefix->size.store(0, std::memory_order_relaxed);
+                head_.store(pos + (size & ~PADDING_FLAG), std::memory_order_release);
+                continue;
+            }
+            payloadLen = prefix->payloadLen;
+            return reinterpret_cast<const char*>(prefix + 1);
+        }
+    }
+
+    // 消费者：释放peek返回的记录，清零后归还空间（count与commit时的条目数一致）
+    void pop(size_t count = 1) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        RecordPrefix* prefix = prefixAt(pos);
+        uint32_t size = prefix->size.load(std::memory_order_relaxed);
+        prefix->size.store(0, std::memory_order_relaxed);
+        prefix->payloadLen = 0;
+        memset(reinterpret_cast<char*>(prefix + 1), 0, size - sizeof(RecordPrefix));
+        popped_.store(popped_.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+        head_.store(pos + size, std::memory_order_release);
+    }
+
+    // 当前已发布但尚未读取的记录数量（近似值，打包的记录按条目数计）
+    size_t size() const {
+        size_t popped = popped_.load(std::memory_order_acquire);
+        size_t committed = committed_.load(std::memory_order_acquire);
+        return committed > popped ? committed - popped : 0;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    // 当前已占用的字节数（含已预留未发布的记录）
+    size_t bytesUsed() const {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    // 累计预留的字节数（含填充）
+    size_t totalBytesReserved() const {
+        return tail_.load(std::memory_order_relaxed);
+    }
+
+    // 累计读取的字节数（消费者的读取位置，含填充）
+    size_t totalBytesPopped() const {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    // 累计发布的记录数量（打包的记录按条目数计）
+    size_t totalCommitted() const {
+        return committed_.load(std::memory_order_relaxed);
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    // 记录前缀：size为0表示尚未发布，最高位表示填充记录
+    struct RecordPrefix {
+        std::atomic<uint32_t> size;    // 记录总字节数
+        uint32_t payloadLen;           // 负载实际字节数
+    };
+
+    static const uint32_t PADDING_FLAG = 0x80000000u;
+
+    RecordPrefix* prefixAt(size_t pos) const {
+        return reinterpret_cast<RecordPrefix*>(buffer_.get() + (pos & mask_));
+    }
+
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 4096;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t capacity_;            // 字节容量（2的幂）
+    const size_t mask_;                // 偏移掩码
+    std::unique_ptr<char[]> buffer_;   // 记录存储区
+
+    // 生产者与消费者的位置计数器分别独占缓存行
+    alignas(WINLOG_CACHE_LINE_SIZE) std::atomic<size_t> tail_;
+    std::atomic<size_t> committed_;
+    alignas(WINLOG_CACHE_LINE_SIZE) std::atomic<size_t> head_;
+    std::atomic<size_t> popped_;
+};
+
+#endif // RECORD_RING_BUFFER_H
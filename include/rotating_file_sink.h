@@ -0,0 +1,107 @@
+#ifndef ROTATING_FILE_SINK_H
+#define ROTATING_FILE_SINK_H
+
+#include "log_sink.h"
+#include "log_file.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 轮转统计信息
+struct RotationStats {
+    uint64_t rotations;             // 轮转次数
+    uint64_t preparedSwitches;      // 直接切换到已预先创建的下一个文件的次数
+    uint64_t totalRotationNanos;    // 轮转（关闭、重命名、切换）的累计耗时（纳秒）
+    uint64_t maxRotationNanos;      // 单次轮转的最长耗时（纳秒）
+    uint64_t filesCompressed;       // 已压缩的历史文件数
+    uint64_t compressedBytesIn;     // 压缩前的总字节数
+    uint64_t compressedBytesOut;    // 压缩后的总字节数
+    uint64_t compressionNanos;      // 压缩的累计耗时（纳秒）
+    uint64_t filesDeleted;          // 超出保留个数而删除的历史文件数
+
+    RotationStats() : rotations(0), preparedSwitches(0), totalRotationNanos(0), maxRotationNanos(0),
+                      filesCompressed(0), compressedBytesIn(0), compressedBytesOut(0), compressionNanos(0),
+                      filesDeleted(0) {}
+};
+
+// 轮转文件输出目标：当前日志始终写入path，按大小和/或时间轮转时重命名为path.N（N递增，越大越新），
+// 只保留最近maxFiles个历史文件。下一个文件（path.next）由后台线程预先创建并预留空间，
+// 轮转时只需关闭、两次重命名并切换句柄；历史文件由同一个低优先级后台线程压缩为path.N.wlz。
+// 轮转发生在输出目标的写线程中，不会阻塞产生日志的线程。mappedWindowBytes非0时以内存映射方式写入，
+// 轮转时关闭当前文件会先将其截断为实际长度；overlappedWrites非0时以重叠I/O方式写入；
+// directPreallocateBytes非0时以无缓冲方式写入
+class WINLOG_API RotatingFileLogSink : public LogSink {
+public:
+    RotatingFileLogSink(const char* path, const RotationConfig& rotation, LogLevel level = LogLevel::trace,
+                        DurabilityPolicy durability = DurabilityPolicy::flushPerBatch,
+                        int syncIntervalMs = 1000, size_t syncIntervalBytes = 1024 * 1024,
+                        size_t mappedWindowBytes = 0, size_t overlappedWrites = 0,
+                        size_t directPreallocateBytes = 0);
+    ~RotatingFileLogSink() override;
+
+    // 当前文件是否已成功打开
+    bool isOpen() const;
+
+    void write(const LogBatch& batch) override;
+    void flush() override;
+    bool sync() override;
+
+    // 轮转统计信息（可在任意线程中调用）
+    RotationStats getRotationStats() const;
+
+    // 等待后台线程完成已排队的压缩和清理，超时返回false（timeoutMs为-1时无限等待）
+    bool waitIdle(int timeoutMs = -1);
+
+private:
+    // 轮转：关闭当前文件，重命名为下一个历史文件，切换到预先创建的下一个文件
+    void rotate();
+
+    // 打开一个新的当前文件（没有预先创建的文件时使用）
+    std::unique_ptr<LogFile> openFile(const char* path, bool truncate);
+
+    // 计算当前时间之后的下一个轮转时刻（自1970年起的秒数）
+    int64_t nextRotationTime(int64_t now) const;
+
+    // 扫描已有的历史文件，确定下一个序号；未压缩的历史文件加入压缩队列
+    void scanArchives();
+
+    // 历史文件的路径
+    std::string archivePath(uint64_t index) const;
+
+    // 后台线程：预先创建下一个文件，压缩并清理历史文件
+    void backgroundThread();
+    void processArchive(uint64_t index);
+
+    std::string path_;                      // 当前文件路径
+    std::string nextPath_;                  // 预先创建的下一个文件路径
+    RotationConfig rotation_;
+    DurabilityPolicy durability_;
+    int syncIntervalMs_;
+    size_t syncIntervalBytes_;
+    size_t mappedWindowBytes_;              // 非0时各文件以内存映射方式写入
+    size_t overlappedWrites_;               // 非0时各文件以重叠I/O方式写入
+    size_t directPreallocateBytes_;         // 非0时各文件以无缓冲方式写入
+
+    std::unique_ptr<LogFile> current_;      // 当前文件（只由写线程访问）
+    uint64_t nextIndex_;                    // 下一个历史文件的序号
+    int64_t nextRotateTime_;                // 下一个按时间轮转的时刻（秒），0表示不按时间轮转
+    bool syncUsed_;                         // 是否调用过sync（只由写线程访问）
+
+    // 以下由mutex_保护
+    std::unique_ptr<LogFile> prepared_;     // 预先创建的下一个文件
+    bool prepareRequested_;                 // 需要预先创建下一个文件
+    std::deque<uint64_t> pendingArchives_;  // 待压缩和清理的历史文件序号
+    bool busy_;                             // 后台线程正在处理任务
+    bool stop_;
+    RotationStats stats_;
+    mutable std::mutex mutex_;
+    std::condition_variable workReady_;     // 有新任务或需要停止
+    std::condition_variable idle_;          // 后台线程空闲
+    std::deque<uint64_t> archives_;         // 保留的历史文件序号，从旧到新（只由后台线程访问）
+    std::thread thread_;
+};
+
+#endif // ROTATING_FILE_SINK_H
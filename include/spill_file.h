@@ -0,0 +1,90 @@
+#ifndef SPILL_FILE_H
+#define SPILL_FILE_H
+
+#include "winlog.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 溢出文件：以内存映射方式打开的定长临时文件，作为按顺序读写的字节环使用。
+// 记录按实际长度紧密排列：[前缀 | 负载]，整体按8字节对齐；尾部剩余空间放不下一条记录时写入一条回绕标记，
+// 从文件开头继续。同一时刻只能有一个写入者（由调用者加锁保证）和一个读取者（工作线程）；
+// 写入位置在负载写完后才公布，读取者只会看到完整的记录。关闭时删除文件
+class WINLOG_API SpillFile {
+public:
+    SpillFile();
+    ~SpillFile();
+
+    // 禁止拷贝构造和赋值操作
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    // 创建并映射溢出文件，容量（字节）向上取整为2的幂；path为空时在系统临时目录中创建
+    bool open(const char* path, size_t capacity);
+
+    // 解除映射、关闭并删除文件
+    void close();
+
+    bool isOpen() const {
+        return view_ != nullptr;
+    }
+
+    // 写入者：预留payloadLen字节的负载空间，空间不足时返回nullptr；写完负载后调用commit公布
+    char* reserve(size_t payloadLen);
+    void commit();
+
+    // 读取者：取得最早一条记录的负载，没有记录时返回nullptr；处理完成后调用pop归还空间
+    const char* peek(size_t& payloadLen);
+    void pop();
+
+    // 累计写入与读取位置（字节），读取者据此只读取某一时刻之前已公布的记录
+    uint64_t writePosition() const {
+        return writePos_.load(std::memory_order_acquire);
+    }
+
+    uint64_t readPosition() const {
+        return readPos_.load(std::memory_order_relaxed);
+    }
+
+    // 尚未读取的字节数
+    size_t bytesUsed() const {
+        return static_cast<size_t>(writePos_.load(std::memory_order_acquire) - readPos_.load(std::memory_order_acquire));
+    }
+
+    bool empty() const {
+        return bytesUsed() == 0;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    const std::string& path() const {
+        return path_;
+    }
+
+private:
+    // 记录前缀：负载长度，WRAP_MARKER表示从文件开头继续
+    struct RecordPrefix {
+        uint32_t length;
+        uint32_t reserved;
+    };
+    static const uint32_t WRAP_MARKER = 0xFFFFFFFFu;
+
+    static size_t recordSize(size_t payloadLen) {
+        return (sizeof(RecordPrefix) + payloadLen + 7) & ~static_cast<size_t>(7);
+    }
+
+    std::string path_;
+    void* handle_;                      // 文件句柄
+    void* mapping_;                     // 文件映射对象
+    char* view_;                        // 整个文件的映射视图
+    size_t capacity_;                   // 映射的字节数（2的幂）
+    size_t pendingSize_;                // 已预留、尚未公布的字节数（含回绕跳过的部分，只由写入者访问）
+    size_t peekSize_;                   // 最近一次peek的记录占用的字节数（含回绕跳过的部分，只由读取者访问）
+    alignas(64) std::atomic<uint64_t> writePos_;  // 累计写入位置
+    alignas(64) std::atomic<uint64_t> readPos_;   // 累计读取位置
+};
+
+#endif // SPILL_FILE_H
@@ -0,0 +1,117 @@
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include "mpsc_ring_buffer.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// 无锁有界单生产者单消费者环形缓冲区
+// 生产者与消费者各自缓存对方的位置，只有在缓存值显示已满/已空时才读取对方的缓存行
+template <typename T>
+class SpscRingBuffer {
+public:
+    // 容量向上取整为2的幂
+    explicit SpscRingBuffer(size_t capacity) :
+        capacity_(roundUpToPowerOfTwo(capacity)),
+        mask_(capacity_ - 1),
+        slots_(new T[capacity_]()),
+        tail_(0),
+        cachedHead_(0),
+        head_(0),
+        cachedTail_(0) {
+    }
+
+    // 禁止拷贝构造和赋值操作
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // 生产者：尝试写入，已满时返回false
+    bool tryPush(const T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ >= capacity_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ >= capacity_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 生产者：一次写入count个元素并只公布一次写入位置，剩余空位不足时返回false
+    bool tryPushBatch(const T* values, size_t count) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail + count - cachedHead_ > capacity_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail + count - cachedHead_ > capacity_) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            slots_[(tail + i) & mask_] = values[i];
+        }
+        tail_.store(tail + count, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者：查看队首元素，为空时返回nullptr
+    T* front() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) {
+                return nullptr;
+            }
+        }
+        return &slots_[head & mask_];
+    }
+
+    // 消费者：移除队首元素（必须先通过front确认非空）
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // 当前元素数量（近似值）
+    size_t size() const {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    // 累计写入的元素数量
+    size_t totalPushed() const {
+        return tail_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t capacity_;            // 槽位数量（2的幂）
+    const size_t mask_;                // 下标掩码
+    std::unique_ptr<T[]> slots_;       // 槽位数组
+
+    // 生产者独占的缓存行
+    alignas(WINLOG_CACHE_LINE_SIZE) std::atomic<size_t> tail_;
+    size_t cachedHead_;
+    // 消费者独占的缓存行
+    alignas(WINLOG_CACHE_LINE_SIZE) std::atomic<size_t> head_;
+    size_t cachedTail_;
+};
+
+#endif // SPSC_RING_BUFFER_H
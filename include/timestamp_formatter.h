@@ -0,0 +1,70 @@
+#ifndef TIMESTAMP_FORMATTER_H
+#define TIMESTAMP_FORMATTER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Windows DLL导出宏定义
+#ifndef WINLOG_API
+#ifdef WINLOG_EXPORTS
+#define WINLOG_API __declspec(dllexport)
+#else
+#define WINLOG_API __declspec(dllimport)
+#endif
+#endif
+
+// 格式化后的时间戳最大长度（含结尾'\0'）："YYYY-MM-DD HH:MM:SS.nnnnnnnnn"
+#define TIMESTAMP_BUFFER_SIZE 32
+
+// 时间戳小数部分的精度
+enum class TimestampPrecision {
+    milliseconds = 3,
+    microseconds = 6,
+    nanoseconds = 9
+};
+
+// 时间戳使用的时区
+enum class TimestampZone {
+    local = 0,      // 本地时间
+    utc = 1         // 协调世界时
+};
+
+// 时间戳格式化器：按秒缓存"YYYY-MM-DD HH:MM:SS"前缀，同一秒内只需复制前缀并写入小数部分，
+// 每秒最多调用一次localtime_s/gmtime_s。非线程安全，由调用者串行使用（如工作线程或持有输出锁时）
+class WINLOG_API TimestampFormatter {
+public:
+    explicit TimestampFormatter(TimestampPrecision precision = TimestampPrecision::milliseconds,
+                                TimestampZone zone = TimestampZone::local);
+
+    // 格式化时间点，out至少需要TIMESTAMP_BUFFER_SIZE字节，返回写入的字符数（不含结尾'\0'）
+    size_t format(std::chrono::system_clock::time_point time, char* out);
+
+    // 格式化自1970-01-01 00:00:00 UTC起的纳秒数
+    size_t format(int64_t nanosSinceEpoch, char* out);
+
+    void setPrecision(TimestampPrecision precision);
+    void setZone(TimestampZone zone);
+
+    TimestampPrecision getPrecision() const {
+        return precision_;
+    }
+
+    TimestampZone getZone() const {
+        return zone_;
+    }
+
+private:
+    // 重新计算指定秒的前缀
+    void refreshPrefix(int64_t seconds);
+
+    static const size_t PREFIX_LEN = 19;   // "YYYY-MM-DD HH:MM:SS"
+
+    TimestampPrecision precision_;         // 小数部分精度
+    TimestampZone zone_;                   // 时区
+    int64_t cachedSecond_;                 // 缓存前缀对应的秒（自纪元起）
+    bool cacheValid_;                      // 缓存是否有效
+    char prefix_[PREFIX_LEN + 1];          // 缓存的前缀
+};
+
+#endif // TIMESTAMP_FORMATTER_H
@@ -1,9 +1,13 @@
 #ifndef WINLOG_H
 #define WINLOG_H
 
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <cstdarg>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 // Windows DLL导出宏定义
 #ifdef WINLOG_EXPORTS
@@ -12,6 +16,10 @@
 #define WINLOG_API __declspec(dllimport)
 #endif
 
+#include "log_args.h"
+#include "timestamp_formatter.h"
+#include "log_clock.h"
+
 // 版本号宏定义（语义化版本号：Major.Minor.Patch.Build）
 #define WINLOG_VERSION_MAJOR    1
 #define WINLOG_VERSION_MINOR    0
@@ -33,6 +41,50 @@ enum class LogLevel {
     off = 6
 };
 
+// 异步队列引擎类型
+enum class QueueEngine {
+    mutex = 0,      // 互斥锁保护的 std::queue（默认）
+    lockFree = 1,   // 无锁有界多生产者单消费者环形缓冲区
+    recordRing = 2, // 变长记录字节环形缓冲区（按实际长度存储，容量由queueBytes限定）
+    perThreadLanes = 3 // 每个生产者线程独享一条SPSC通道，工作线程按时间戳合并
+};
+
+// 异步队列已满时的处理策略
+enum class OverflowPolicy {
+    blockWithTimeout = 0, // 等待空位，超过overflowTimeoutMs仍无空位时丢弃本条（默认）
+    block = 1,            // 一直等待空位，不丢弃（直到队列停止）
+    dropNewest = 2,       // 立即丢弃本条
+    dropOldest = 3,       // 丢弃队列中最早的日志，为本条腾出空位（无锁引擎中同dropNewest）
+    dropByLevel = 4,      // 低于warn的日志在队列用量达到7/8时即丢弃，剩余空间留给warn及以上的日志（按blockWithTimeout等待）
+    spill = 5             // 写入内存映射的溢出文件，工作线程追上后按顺序读回；溢出文件也写满时丢弃本条
+};
+
+// 优先级通道的输出顺序
+enum class PriorityOrdering {
+    perSink = 0,    // 每个输出目标内保持入队顺序：只有级别不低于priorityLevel的输出目标提前收到高优先级日志（默认）
+    relaxed = 1     // 所有输出目标都提前收到高优先级日志，可能排在更早入队的低级别日志之前
+};
+
+// 异步工作线程在队列为空时的等待策略
+enum class WaitStrategy {
+    park = 0,       // 立即在条件变量上休眠，生产者只在工作线程确实休眠时才通知（默认）
+    busySpin = 1,   // 从不休眠，一直轮询队列：延迟最低，但独占一个CPU核心
+    spinYield = 2,  // 先自旋spinIterations次，之后反复让出CPU，从不休眠
+    spinPark = 3,   // 先自旋spinIterations次、再让出CPU若干次，仍为空时休眠（唤醒方式同park）
+    timedBatch = 4  // 生产者从不通知，工作线程每隔batchIntervalUs微秒醒来处理一次积累的日志
+};
+
+// 日志文件的持久化策略
+enum class DurabilityPolicy {
+    none = 0,           // 写入进程内缓冲区，缓冲区满、flush或关闭时才交给操作系统
+    flushPerBatch = 1,  // 每批日志合并为一次写入交给操作系统（默认）
+    syncInterval = 2,   // 每批写入，并每隔syncIntervalMs毫秒或syncIntervalBytes字节调用FlushFileBuffers落盘
+    syncOnError = 3     // 每批写入，批次中含error/critical级别日志时调用FlushFileBuffers落盘
+};
+
+// 日志级别数量（不含off），用于按级别统计
+#define LOG_LEVEL_COUNT 6
+
 // 预定义的缓冲区大小
 #define LOG_MESSAGE_BUFFER_SIZE 512
 #define LOG_FILE_BUFFER_SIZE 256
@@ -47,6 +99,10 @@ struct WINLOG_API LogEntry {
     size_t messageLen;                               // 实际消息长度
     size_t fileLen;                                  // 实际文件名长度
     size_t timeLen;                                  // 实际时间戳长度
+    uint64_t timestamp;                              // 调用点取得的原始时钟计数（LogClock），由工作线程换算为墙上时间
+    const char* format;                              // 延迟格式化的格式字符串（非空时message中保存的是编码后的参数）
+    uint32_t siteId;                                 // 调用点ID（非0时文件名和行号从调用点登记表中获取）
+    bool expedited;                                  // 副本已经由优先级通道提前交给输出目标
     
     LogEntry();
     LogEntry(LogLevel level, const std::string& message);
@@ -62,6 +118,9 @@ struct WINLOG_API LogEntry {
     // 安全地设置消息，防止缓冲区溢出
     void setMessage(const char* msg, size_t len);
     
+    // 直接在消息缓冲区中格式化，避免经过临时缓冲区再复制
+    void formatMessage(const char* format, va_list args);
+    
     // 安全地设置文件名
     void setFile(const char* filename, size_t len);
     
@@ -84,30 +143,113 @@ struct WINLOG_API LogEntry {
     }
 };
 
+// 调用点登记表的容量上限
+#define WINLOG_MAX_LOG_SITES 65536
+
+// 日志调用点的静态元数据，由WINLOG_xxx宏在首次执行时登记，之后每条日志只携带调用点ID
+struct WINLOG_API LogSite {
+    uint32_t id;                  // 调用点ID（从1开始，0表示登记表已满、未能登记）
+    LogLevel level;               // 日志级别
+    const char* format;           // 格式字符串
+    const char* file;             // 源文件名（已去除目录部分）
+    int line;                     // 行号
+    std::atomic<bool> enabled;    // 是否启用该调用点
+    
+    LogSite() : id(0), level(LogLevel::info), format(nullptr), file(nullptr), line(0), enabled(true) {}
+};
+
+// 日志调用点登记表（进程内全局唯一，调用点登记后永不移除）
+class WINLOG_API LogSiteRegistry {
+public:
+    // 登记调用点，返回的指针在进程生命周期内有效；登记表已满时返回id为0的独立调用点
+    static LogSite* registerSite(LogLevel level, const char* format, const char* file, int line);
+    
+    // 按ID查找调用点，不存在时返回nullptr（无锁，可在工作线程中调用）
+    static const LogSite* find(uint32_t id);
+    
+    // 已登记的调用点数量（ID范围为1..count）
+    static size_t count();
+    
+    // 启用或禁用调用点，ID不存在时返回false
+    static bool setEnabled(uint32_t id, bool enabled);
+};
+
 // 统计信息结构体
 struct WINLOG_API Stats {
     size_t totalLogEntries;       // 总日志条目数
     size_t droppedEntries;        // 丢弃的条目数
-    size_t queueOverflows;        // 队列溢出次数
+    size_t queueOverflows;        // 队列溢出次数（入队时队列已满，或dropByLevel策略下低级别日志超出其可用空间）
+    size_t droppedByLevel[LOG_LEVEL_COUNT]; // 按级别统计的丢弃条目数（下标为LogLevel的值）
+    size_t spilledEntries;        // 写入溢出文件的条目数（spill策略）
+    size_t spillBytes;            // 写入溢出文件的字节数
+    uint64_t totalSpillNanos;     // 生产者写入溢出文件的累计耗时（纳秒，含等待溢出文件锁）
+    uint64_t maxSpillNanos;       // 单条写入溢出文件的最长耗时（纳秒）
+    size_t spillDrainedEntries;   // 工作线程从溢出文件读回并处理的条目数
+    uint64_t spillDrainNanos;     // 工作线程读回并处理溢出条目的累计耗时（纳秒），排空速率为条目数/耗时
+    size_t expeditedEntries;      // 经优先级通道提前输出的条目数
+    size_t expediteMisses;        // 优先级通道已满或暂停、只能按常规顺序输出的高优先级条目数
+    size_t producerWakeups;       // 生产者唤醒休眠中的工作线程的次数（每次通常对应一次系统调用）
+    size_t consumerParks;         // 工作线程因队列为空而休眠的次数
     size_t totalAllocations;      // 总内存分配次数
     size_t totalDeallocations;    // 总内存释放次数
     size_t peakPoolSize;          // 峰值内存池大小
     size_t currentPoolSize;       // 当前内存池大小
     size_t threadCacheHits;       // 线程缓存命中次数
     size_t threadCacheMisses;     // 线程缓存未命中次数
-    size_t batchOperations;       // 批量操作次数
+    size_t batchOperations;       // 异步模式下交给输出目标的批次数
+    size_t batchSize;             // 工作线程当前选择的每批上限（未启用自适应批量时为maxBatchSize）
+    double batchesPerSecond;      // 自初始化或上次重置统计以来平均每秒处理的批次数
+    size_t durableWaits;          // waitDurable/flushDurable的调用次数
+    size_t durableSyncs;          // 为满足这些等待实际执行的落盘次数（组提交时远少于等待次数）
     
     Stats() : 
         totalLogEntries(0),
         droppedEntries(0),
         queueOverflows(0),
+        droppedByLevel(),
+        spilledEntries(0),
+        spillBytes(0),
+        totalSpillNanos(0),
+        maxSpillNanos(0),
+        spillDrainedEntries(0),
+        spillDrainNanos(0),
+        expeditedEntries(0),
+        expediteMisses(0),
+        producerWakeups(0),
+        consumerParks(0),
         totalAllocations(0),
         totalDeallocations(0),
         peakPoolSize(0),
         currentPoolSize(0),
         threadCacheHits(0),
         threadCacheMisses(0),
-        batchOperations(0) {}
+        batchOperations(0),
+        batchSize(0),
+        batchesPerSecond(0),
+        durableWaits(0),
+        durableSyncs(0) {}
+};
+
+// 日志文件轮转配置
+struct WINLOG_API RotationConfig {
+    uint64_t maxFileBytes;        // 单个文件达到该字节数后轮转，0表示不按大小轮转
+    int rotateIntervalSec;        // 按时间轮转的间隔(秒)，按本地时间对齐（3600为整点，86400为零点），0表示不按时间轮转
+    int maxFiles;                 // 保留的历史文件个数，更早的文件被删除
+    bool compress;                // 是否在后台低优先级线程中压缩历史文件（.wlz）
+    uint64_t preallocateBytes;    // 为下一个文件预留的磁盘空间，0表示不预分配
+    
+    // 默认构造函数（不轮转）
+    RotationConfig() :
+        maxFileBytes(0),
+        rotateIntervalSec(0),
+        maxFiles(5),
+        compress(true),
+        preallocateBytes(0) {}
+    
+    // 是否启用了轮转
+    bool enabled() const {
+        return maxFileBytes > 0 || rotateIntervalSec > 0;
+    }
 };
 
 // 异步配置结构体
@@ -115,11 +257,35 @@ struct WINLOG_API AsyncConfig {
     bool enabled;                 // 是否启用异步模式
     size_t queueSize;             // 异步队列大小
     int flushIntervalMs;          // 自动刷新间隔(毫秒)
-    size_t maxBatchSize;          // 最大批量处理大小
+    size_t maxBatchSize;          // 最大批量处理大小（启用自适应批量时为每批上限的上界）
+    bool adaptiveBatching;        // 是否按到达速率与处理耗时自动调整每批的上限
+    size_t minBatchSize;          // 自适应批量时每批上限的下界
+    int batchLatencyTargetUs;     // 自适应批量时一批处理耗时的目标(微秒)
     size_t memoryPoolSize;        // 内存池大小
-    bool dropOnOverflow;          // 队列满时是否丢弃日志
+    bool dropOnOverflow;          // 兼容旧配置：为true时等同于overflowPolicy为dropNewest
+    OverflowPolicy overflowPolicy;// 队列已满时的处理策略（每个队列独立）
+    int overflowTimeoutMs;        // blockWithTimeout与dropByLevel策略等待空位的最长时间(毫秒)
+    size_t spillBytes;            // spill策略的溢出文件容量（字节，向上取整为2的幂）
+    const char* spillPath;        // spill策略的溢出文件路径，nullptr表示在系统临时目录中创建（关闭队列时删除）
+    LogLevel priorityLevel;       // 不低于该级别的日志另经优先级通道提前输出（off表示不启用）
+    PriorityOrdering priorityOrdering; // 优先级通道的输出顺序
+    size_t priorityQueueSize;     // 优先级通道的容量（条）
+    WaitStrategy waitStrategy;    // 工作线程在队列为空时的等待策略
+    int spinIterations;           // spinYield与spinPark策略让出CPU之前的自旋次数
+    int batchIntervalUs;          // timedBatch策略的处理间隔(微秒)，也是该策略下日志的最大额外延迟
     bool useMemoryPool;           // 是否使用内存池
     bool optimizeForThroughput;   // 是否优化吞吐量
+    QueueEngine queueEngine;      // 队列引擎类型（lockFree时容量向上取整为2的幂）
+    size_t queueBytes;            // 变长记录环形缓冲区的字节容量（仅recordRing引擎）
+    size_t laneSize;              // 每条生产者通道的容量（仅perThreadLanes引擎）
+    LogClockSource clockSource;   // 调用点时间戳使用的时钟源
+    DurabilityPolicy durability;  // 日志文件的持久化策略
+    int syncIntervalMs;           // syncInterval策略的落盘时间间隔(毫秒)
+    size_t syncIntervalBytes;     // syncInterval策略的落盘字节间隔
+    RotationConfig rotation;      // init创建的文件输出目标的轮转配置（默认不轮转）
+    size_t mappedWindowBytes;     // init创建的文件输出目标以内存映射方式写入时的窗口大小（0表示缓冲写入）
+    size_t overlappedWrites;      // init创建的文件输出目标以重叠I/O方式写入时同时进行的写入数（0表示同步写入）
+    size_t directPreallocateBytes;// init创建的文件输出目标以无缓冲方式写入时每次预留的文件空间（0表示经过系统缓存）
     
     // 默认构造函数
     AsyncConfig() : 
@@ -127,12 +293,58 @@ struct WINLOG_API AsyncConfig {
         queueSize(10000),
         flushIntervalMs(1000),
         maxBatchSize(100),
+        adaptiveBatching(false),
+        minBatchSize(16),
+        batchLatencyTargetUs(1000),
         memoryPoolSize(1000),
         dropOnOverflow(false),
+        overflowPolicy(OverflowPolicy::blockWithTimeout),
+        overflowTimeoutMs(100),
+        spillBytes(64 * 1024 * 1024),
+        spillPath(nullptr),
+        priorityLevel(LogLevel::off),
+        priorityOrdering(PriorityOrdering::perSink),
+        priorityQueueSize(1024),
+        waitStrategy(WaitStrategy::park),
+        spinIterations(4000),
+        batchIntervalUs(1000),
         useMemoryPool(true),
-        optimizeForThroughput(false) {}
+        optimizeForThroughput(false),
+        queueEngine(QueueEngine::mutex),
+        queueBytes(4 * 1024 * 1024),
+        laneSize(4096),
+        clockSource(LogClockSource::tsc),
+        durability(DurabilityPolicy::flushPerBatch),
+        syncIntervalMs(1000),
+        syncIntervalBytes(1024 * 1024),
+        mappedWindowBytes(0),
+        overlappedWrites(0),
+        directPreallocateBytes(0) {}
 };
 
+// 格式字符串是否为字符串字面量（const char数组）：只有这种格式字符串可以留给工作线程延迟使用。
+// 指针与可写的字符数组可能指向调用返回后即失效或被改写的缓冲区。
+// Format为转发引用推导出的类型：按const引用接收时字面量与可写数组都推导为char[N]，无法区分
+template <typename Format>
+struct IsLiteralFormat : std::integral_constant<bool,
+    std::is_array<typename std::remove_reference<Format>::type>::value &&
+    std::is_same<typename std::remove_extent<typename std::remove_reference<Format>::type>::type, const char>::value> {};
+
+// 在调用线程中按编码后的参数格式化消息到条目
+template <typename... Args>
+inline void formatLogEntry(LogEntry* entry, const char* format, const Args&... args) {
+    char encoded[LOG_MESSAGE_BUFFER_SIZE];
+    LogArgBuffer buffer(encoded, sizeof(encoded));
+    encodeLogArgs(buffer, args...);
+    entry->messageLen = formatLogArgs(format, encoded, buffer.size(), entry->message, LOG_MESSAGE_BUFFER_SIZE);
+}
+
+// 输出目标接口（定义见log_sink.h）
+class LogSink;
+
+// 日志批次（定义见下文）
+class LogEntryBatch;
+
 // 日志库的主要接口类
 class WINLOG_API WinLog {
 public:
@@ -153,15 +365,91 @@ public:
     void error(const char* format, ...);
     void critical(const char* format, ...);
     
+    // 类型安全的格式化接口（带参数时匹配）：参数按实际类型编码，字符串参数按值复制，调用返回后即可释放。
+    // 格式字符串为字符串字面量（const char数组）时只记录其指针，由工作线程在输出前完成格式化；
+    // 为指针或可写的字符数组（运行时生成的格式）时在调用线程中立即格式化，工作线程不再访问它
+    template <typename Format, typename... Args>
+    void trace(Format&& format, const Args&... args) {
+        logTyped<Format>(LogLevel::trace, format, args...);
+    }
+    
+    template <typename Format, typename... Args>
+    void debug(Format&& format, const Args&... args) {
+        logTyped<Format>(LogLevel::debug, format, args...);
+    }
+    
+    template <typename Format, typename... Args>
+    void info(Format&& format, const Args&... args) {
+        logTyped<Format>(LogLevel::info, format, args...);
+    }
+    
+    template <typename Format, typename... Args>
+    void warn(Format&& format, const Args&... args) {
+        logTyped<Format>(LogLevel::warn, format, args...);
+    }
+    
+    template <typename Format, typename... Args>
+    void error(Format&& format, const Args&... args) {
+        logTyped<Format>(LogLevel::error, format, args...);
+    }
+    
+    template <typename Format, typename... Args>
+    void critical(Format&& format, const Args&... args) {
+        logTyped<Format>(LogLevel::critical, format, args...);
+    }
+    
+    // 调用点接口（由WINLOG_xxx宏调用）：条目只携带调用点ID和编码后的参数
+    template <typename... Args>
+    void logSite(const LogSite* site, const Args&... args) {
+        LogEntry* entry = beginSite(site);
+        if (!entry) {
+            return;
+        }
+        LogArgBuffer buffer(entry->message, LOG_MESSAGE_BUFFER_SIZE - 1);
+        encodeLogArgs(buffer, args...);
+        entry->messageLen = buffer.size();
+        commitDeferred(entry);
+    }
+    
+    // 使用va_list输出日志（在调用线程中立即格式化）
+    void logv(LogLevel level, const char* format, va_list args);
+    
+    // 提交日志批次：异步模式下整批只占用一次队列预留、唤醒一次工作线程，同步模式下一次加锁写出；
+    // 批次中的日志在输出中保持连续。提交后批次被清空，全部条目被接受时返回true
+    bool logBatch(LogEntryBatch& batch);
+    
     // 设置日志级别
     void setLevel(LogLevel level);
     
+    // 设置时间戳格式（小数部分精度与时区），所有输出目标共用
+    void setTimestampFormat(TimestampPrecision precision, TimestampZone zone = TimestampZone::local);
+    
+    // 注册输出目标，每条日志只格式化一次，由所有输出目标共享。
+    // init时若尚未注册任何输出目标，会自动添加默认的控制台输出目标；logFilePath非空时总会添加文件输出目标
+    void addSink(const std::shared_ptr<LogSink>& sink);
+    
+    // 移除输出目标
+    void removeSink(const std::shared_ptr<LogSink>& sink);
+    
+    // 移除全部输出目标（包括init创建的默认输出目标）
+    void clearSinks();
+    
     // 关闭日志库
     void shutdown();
     
     // 刷新日志缓冲区（立即写入所有待处理日志）
     bool flush(int timeoutMs = -1);
     
+    // 落盘凭据：调用线程最近一次记录的日志的凭据（0表示没有），交给waitDurable等待其落盘
+    uint64_t getDurabilityTicket() const;
+    
+    // 等待凭据之前（含）的全部日志写入输出目标并落盘（文件输出目标调用FlushFileBuffers）。
+    // 同时等待的多个线程共享一次落盘（组提交）；超时、落盘失败或日志库关闭时返回false
+    bool waitDurable(uint64_t ticket, int timeoutMs = -1);
+    
+    // 等待此刻之前记录的全部日志落盘
+    bool flushDurable(int timeoutMs = -1);
+    
     // 设置异步配置（必须在init之前调用）
     void setAsyncConfig(const AsyncConfig& config);
     
@@ -192,6 +480,53 @@ private:
     WinLog(const WinLog&) = delete;
     WinLog& operator=(const WinLog&) = delete;
     
+    // 延迟格式化：取出一个条目并记录格式字符串，日志级别被过滤时返回nullptr
+    LogEntry* beginDeferred(LogLevel level, const char* format);
+    
+    // 调用点日志：取出一个条目并记录调用点ID，日志级别被过滤时返回nullptr
+    LogEntry* beginSite(const LogSite* site);
+    
+    // 延迟格式化：提交已写入编码参数的条目
+    void commitDeferred(LogEntry* entry);
+    
+    // 日志批次：取出一个条目（异步模式下来自内存池），日志级别被过滤时返回nullptr；归还未提交的条目
+    LogEntry* allocateBatchEntry(LogLevel level);
+    void freeBatchEntries(std::vector<LogEntry*>& entries);
+    friend class LogEntryBatch;
+    
+    // 按格式字符串的类型选择延迟格式化或立即格式化
+    template <typename Format, typename... Args>
+    void logTyped(LogLevel level, const typename std::remove_reference<Format>::type& format, const Args&... args) {
+        if (IsLiteralFormat<Format>::value) {
+            logDeferred(level, format, args...);
+        } else {
+            logFormatted(level, format, args...);
+        }
+    }
+    
+    template <typename... Args>
+    void logDeferred(LogLevel level, const char* format, const Args&... args) {
+        LogEntry* entry = beginDeferred(level, format);
+        if (!entry) {
+            return;
+        }
+        LogArgBuffer buffer(entry->message, LOG_MESSAGE_BUFFER_SIZE - 1);
+        encodeLogArgs(buffer, args...);
+        entry->messageLen = buffer.size();
+        commitDeferred(entry);
+    }
+    
+    // 运行时的格式字符串：参数编码后在调用线程中立即格式化，条目不保留格式字符串指针
+    template <typename... Args>
+    void logFormatted(LogLevel level, const char* format, const Args&... args) {
+        LogEntry* entry = beginDeferred(level, nullptr);
+        if (!entry) {
+            return;
+        }
+        formatLogEntry(entry, format, args...);
+        commitDeferred(entry);
+    }
+    
     // 内部实现类
     class Impl;
     Impl* pImpl;
@@ -200,6 +535,78 @@ private:
     AsyncConfig asyncConfig;
 };
 
+// 日志批次：把一组相关的日志（例如一次请求的摘要或一张状态表）逐条格式化进池化的条目，
+// 再由WinLog::logBatch一次提交。批次只能在一个线程中使用；未提交的条目在clear或析构时归还
+class WINLOG_API LogEntryBatch {
+public:
+    explicit LogEntryBatch(WinLog& log = WinLog::getInstance());
+    ~LogEntryBatch();
+    
+    // 禁止拷贝构造和赋值操作
+    LogEntryBatch(const LogEntryBatch&) = delete;
+    LogEntryBatch& operator=(const LogEntryBatch&) = delete;
+    
+    // 在调用线程中立即格式化一条日志并加入批次（日志级别被过滤时忽略）
+    void add(LogLevel level, const char* format, ...);
+    void addv(LogLevel level, const char* format, va_list args);
+    
+    // 类型安全的版本（带参数时匹配）：与WinLog::info等模板接口相同，字符串字面量格式延迟格式化，
+    // 运行时的格式字符串在调用线程中立即格式化
+    template <typename Format, typename... Args>
+    void add(LogLevel level, Format&& format, const Args&... args) {
+        bool literal = IsLiteralFormat<Format>::value;
+        LogEntry* entry = beginEntry(level, literal ? format : nullptr);
+        if (!entry) {
+            return;
+        }
+        if (literal) {
+            LogArgBuffer buffer(entry->message, LOG_MESSAGE_BUFFER_SIZE - 1);
+            encodeLogArgs(buffer, args...);
+            entry->messageLen = buffer.size();
+        } else {
+            formatLogEntry(entry, format, args...);
+        }
+    }
+    
+    // 批次中的条目数
+    size_t size() const {
+        return entries_.size();
+    }
+    
+    bool empty() const {
+        return entries_.empty();
+    }
+    
+    // 丢弃尚未提交的条目
+    void clear();
+    
+private:
+    friend class WinLog;
+    
+    // 取出一个条目、记录格式字符串并加入批次，日志级别被过滤时返回nullptr
+    LogEntry* beginEntry(LogLevel level, const char* format);
+    
+    WinLog& log_;
+    std::vector<LogEntry*> entries_;  // 已格式化、尚未提交的条目
+};
+
+// 调用点日志宏：调用点的格式字符串、文件名、行号和级别只在首次执行时登记一次，
+// 之后每条日志只携带调用点ID与参数；被禁用的调用点只需一次原子读取即可跳过
+#define WINLOG_LOG(level, format, ...) \
+    do { \
+        static LogSite* const winlogSite_ = LogSiteRegistry::registerSite((level), (format), __FILE__, __LINE__); \
+        if (winlogSite_->enabled.load(std::memory_order_relaxed)) { \
+            WinLog::getInstance().logSite(winlogSite_, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define WINLOG_TRACE(format, ...)    WINLOG_LOG(LogLevel::trace, format, ##__VA_ARGS__)
+#define WINLOG_DEBUG(format, ...)    WINLOG_LOG(LogLevel::debug, format, ##__VA_ARGS__)
+#define WINLOG_INFO(format, ...)     WINLOG_LOG(LogLevel::info, format, ##__VA_ARGS__)
+#define WINLOG_WARN(format, ...)     WINLOG_LOG(LogLevel::warn, format, ##__VA_ARGS__)
+#define WINLOG_ERROR(format, ...)    WINLOG_LOG(LogLevel::error, format, ##__VA_ARGS__)
+#define WINLOG_CRITICAL(format, ...) WINLOG_LOG(LogLevel::critical, format, ##__VA_ARGS__)
+
 // 便捷的全局日志函数
 extern "C" {
     WINLOG_API void logTrace(const char* format, ...);
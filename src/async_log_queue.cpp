@@ -4,17 +4,150 @@
 #include <functional>
 #include <cstring>
 #include <algorithm>
+#include <iterator>
 
 // 注意：LogEntry的实现已经在winlog.cpp中，这里不需要重复实现
 
+namespace {
+
+// 变长记录头：紧随其后依次是文件名字节和消息字节（均不含结尾'\0'）
+struct QueuedRecordHeader {
+    const char* format;    // 延迟格式化的格式字符串（消息为编码后的参数时非空）
+    uint64_t timestamp;    // 调用点时间戳（原始时钟计数）
+    uint32_t messageLen;   // 消息实际长度
+    uint16_t fileLen;      // 文件名实际长度
+    uint8_t level;         // 日志级别
+    uint8_t flags;         // 标记（QUEUED_RECORD_EXPEDITED）
+    int32_t line;          // 行号
+    uint32_t siteId;       // 调用点ID
+};
+
+// 记录标记：副本已经由优先级通道提前输出
+const uint8_t QUEUED_RECORD_EXPEDITED = 0x01;
+
+// 记录标记：批量入队的打包记录，记录头的messageLen为条目数，随后依次是各条目的[长度(uint32) | 变长记录]
+const uint8_t QUEUED_RECORD_BATCH = 0x02;
+
+// 变长记录的负载长度
+size_t queuedRecordSize(const LogEntry* entry) {
+    return sizeof(QueuedRecordHeader) + entry->fileLen + entry->messageLen;
+}
+
+// 按实际长度编码：[记录头 | 文件名 | 消息]（变长记录引擎与溢出文件共用）
+void encodeQueuedRecord(char* payload, const LogEntry* entry) {
+    QueuedRecordHeader header;
+    header.format = entry->format;
+    header.timestamp = entry->timestamp;
+    header.messageLen = static_cast<uint32_t>(entry->messageLen);
+    header.fileLen = static_cast<uint16_t>(entry->fileLen);
+    header.level = static_cast<uint8_t>(entry->level);
+    header.flags = entry->expedited ? QUEUED_RECORD_EXPEDITED : 0;
+    header.line = entry->line;
+    header.siteId = entry->siteId;
+    memcpy(payload, &header, sizeof(header));
+    memcpy(payload + sizeof(header), entry->file, entry->fileLen);
+    memcpy(payload + sizeof(header) + entry->fileLen, entry->message, entry->messageLen);
+}
+
+// 将多个条目编码为一条打包记录（payload的长度为queuedBatchSize的结果）
+void encodeQueuedBatch(char* payload, LogEntry* const* entries, size_t count) {
+    QueuedRecordHeader header;
+    memset(&header, 0, sizeof(header));
+    header.messageLen = static_cast<uint32_t>(count);
+    header.flags = QUEUED_RECORD_BATCH;
+    memcpy(payload, &header, sizeof(header));
+    
+    char* cursor = payload + sizeof(header);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t length = static_cast<uint32_t>(queuedRecordSize(entries[i]));
+        memcpy(cursor, &length, sizeof(length));
+        encodeQueuedRecord(cursor + sizeof(length), entries[i]);
+        cursor += sizeof(length) + length;
+    }
+}
+
+// 批次中级别最高的日志级别（溢出策略据此决定是否整批丢弃）
+LogLevel highestLevel(LogEntry* const* entries, size_t count) {
+    LogLevel level = LogLevel::trace;
+    for (size_t i = 0; i < count; ++i) {
+        level = std::max(level, entries[i]->level);
+    }
+    return level;
+}
+
+// 将一条变长记录解码到条目中
+void decodeQueuedRecord(const char* payload, LogEntry* entry) {
+    QueuedRecordHeader header;
+    memcpy(&header, payload, sizeof(header));
+    
+    entry->reset();
+    entry->level = static_cast<LogLevel>(header.level);
+    entry->line = header.line;
+    entry->format = header.format;
+    entry->timestamp = header.timestamp;
+    entry->siteId = header.siteId;
+    entry->expedited = (header.flags & QUEUED_RECORD_EXPEDITED) != 0;
+    entry->setFile(payload + sizeof(header), header.fileLen);
+    entry->setMessage(payload + sizeof(header) + header.fileLen, header.messageLen);
+}
+
+} // namespace
+
 // 初始化线程本地存储静态成员
 thread_local std::unique_ptr<AsyncLogQueue::ThreadLocalCache> AsyncLogQueue::threadLocalCache = nullptr;
+thread_local std::unique_ptr<AsyncLogQueue::ThreadLaneRegistry> AsyncLogQueue::threadLanes = nullptr;
+thread_local AsyncLogQueue::ThreadSequence AsyncLogQueue::threadSequence;
+
+// 队列实例ID生成器（从1开始，0表示线程登记表中尚无最近使用的队列）
+std::atomic<uint64_t> AsyncLogQueue::nextQueueId_(1);
 
 // AsyncLogQueue 构造函数
-AsyncLogQueue::AsyncLogQueue(size_t queueSize, size_t maxBatchSize, size_t memoryPoolSize, bool dropOnOverflow, int flushIntervalMs) :
+AsyncLogQueue::AsyncLogQueue(size_t queueSize, size_t maxBatchSize, size_t memoryPoolSize, bool dropOnOverflow, int flushIntervalMs,
+                             QueueEngine engine, bool useMemoryPool, size_t queueBytes, size_t laneSize) :
     queueSize_(queueSize),
     maxBatchSize_(maxBatchSize),
-    memoryPoolSize_(memoryPoolSize),
+    batchLimit_(maxBatchSize),
+    memoryPoolSize_(useMemoryPool ? memoryPoolSize : 0),
+    useMemoryPool_(useMemoryPool),
+    overflowPolicy_(dropOnOverflow ? OverflowPolicy::dropNewest : OverflowPolicy::blockWithTimeout),
+    overflowTimeoutMs_(100),
+    engine_(engine),
+    queuedEntries_(0),
+    waitStrategy_(WaitStrategy::park),
+    spinIterations_(4000),
+    batchIntervalUs_(1000),
+    consumerSleeping_(false),
+    enqueueBase_(0),
+    queueId_(nextQueueId_.fetch_add(1)),
+    laneSize_(laneSize),
+    lanesVersion_(0),
+    workerLanesVersion_(0),
+    retiredLaneEnqueued_(0),
+    drainingLanes_(false),
+    laneWatermark_(0),
+    enqueueSequence_(0),
+    dequeuedSequence_(0),
+    processedSequence_(0),
+    sequenceWaiters_(0),
+    spillActive_(false),
+    spillFence_(0),
+    spillDoneSequence_(0),
+    batchFromSpill_(false),
+    priorityLevel_(LogLevel::off),
+    priorityCapacity_(0),
+    priorityPending_(0),
+    expediteHeld_(false),
+    expediteMissesInFlight_(0),
+    expediteFence_(0),
+    expeditedEntries_(0),
+    expediteMisses_(0),
+    enqueueBytesBase_(0),
+    adaptiveBatching_(false),
+    minBatchSize_(maxBatchSize),
+    batchLatencyNanos_(1000000),
+    entryCostNanos_(0),
+    arrivalPerNano_(0),
+    statsSince_(std::chrono::steady_clock::now()),
     stopRequested_(false),
     totalAllocations_(0),
     totalDeallocations_(0),
@@ -23,18 +156,27 @@ AsyncLogQueue::AsyncLogQueue(size_t queueSize, size_t maxBatchSize, size_t memor
     tlsCacheHits_(0),
     stats_() {
     // 设置静态配置（仅当传入的参数与默认值不同时）
-    if (dropOnOverflow != dropOnOverflow_) {
-        dropOnOverflow_ = dropOnOverflow;
-    }
     if (flushIntervalMs > 0 && flushIntervalMs != flushIntervalMs_) {
         flushIntervalMs_ = flushIntervalMs;
     }
     
+    // 无锁引擎：预分配环形缓冲区（容量向上取整为2的幂）
+    if (engine_ == QueueEngine::lockFree) {
+        ring_.reset(new MpscRingBuffer<LogEntry*>(queueSize));
+        queueSize_ = ring_->capacity();
+    }
+    
+    // 变长记录引擎：内存上限按字节计算，与条目数量无关
+    if (engine_ == QueueEngine::recordRing) {
+        records_.reset(new RecordRingBuffer(queueBytes));
+        decoded_.reserve(maxBatchSize_);
+    }
+    
     // 初始化全局内存池
     {  
         std::lock_guard<std::mutex> lock(poolMutex_);
-        freeList_.reserve(memoryPoolSize); // 预分配空间，减少内存碎片
-        for (size_t i = 0; i < memoryPoolSize; ++i) {
+        freeList_.reserve(memoryPoolSize_); // 预分配空间，减少内存碎片
+        for (size_t i = 0; i < memoryPoolSize_; ++i) {
             freeList_.push_back(new LogEntry());
         }
         currentPoolSize_ = freeList_.size();
@@ -45,192 +187,1468 @@ AsyncLogQueue::AsyncLogQueue(size_t queueSize, size_t maxBatchSize, size_t memor
     }
     }
     
-    // 启动工作线程
-    workerThread_ = std::thread(&AsyncLogQueue::workerThread, this);
-}
-
-// AsyncLogQueue 析构函数
-AsyncLogQueue::~AsyncLogQueue() {
-    stop();
+    // 预分配批次缓冲区，工作线程取批次时不再分配内存
+    batchBuffer_.reserve(maxBatchSize_);
+    
+    // 运行期间登记为时钟计数的使用者，队列中有计数在途时不允许切换时钟源
+    LogClock::addConsumer();
+    
+    // 启动工作线程
+    workerThread_ = std::thread(&AsyncLogQueue::workerThread, this);
+}
+
+// 根据异步配置构造
+AsyncLogQueue::AsyncLogQueue(const AsyncConfig& config) :
+    AsyncLogQueue(config.queueSize, config.maxBatchSize, config.memoryPoolSize,
+                  config.dropOnOverflow, config.flushIntervalMs, config.queueEngine, config.useMemoryPool,
+                  config.queueBytes, config.laneSize) {
+    setOverflowPolicy(config.dropOnOverflow ? OverflowPolicy::dropNewest : config.overflowPolicy,
+                      config.overflowTimeoutMs, config.spillPath, config.spillBytes);
+    setPriorityLane(config.priorityLevel, config.priorityQueueSize);
+    setWaitStrategy(config.waitStrategy, config.spinIterations, config.batchIntervalUs);
+    setAdaptiveBatching(config.adaptiveBatching, config.minBatchSize, config.batchLatencyTargetUs);
+}
+
+// AsyncLogQueue 析构函数
+AsyncLogQueue::~AsyncLogQueue() {
+    stop();
+    
+    // 释放停止后仍滞留在队列中的条目（例如未设置处理回调时）
+    if (engine_ == QueueEngine::lockFree) {
+        LogEntry* entry = nullptr;
+        while (ring_->tryPop(entry)) {
+            delete entry;
+        }
+    } else if (engine_ == QueueEngine::perThreadLanes) {
+        // 通道可能仍被生产者线程的登记表引用，标记为已关闭以便其丢弃
+        std::lock_guard<std::mutex> lanesLock(lanesMutex_);
+        for (auto& lane : lanes_) {
+            LogEntry** entry = nullptr;
+            while ((entry = lane->ring.front()) != nullptr) {
+                delete *entry;
+                lane->ring.pop();
+            }
+            lane->closed.store(true, std::memory_order_release);
+        }
+    } else {
+        while (!queue_.empty()) {
+            delete queue_.front();
+            queue_.pop();
+        }
+    }
+    for (LogEntry* entry : priorityQueue_) {
+        delete entry;
+    }
+    priorityQueue_.clear();
+    
+    // 释放全局内存池中的对象
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    for (auto entry : freeList_) {
+        delete entry;
+    }
+    freeList_.clear();
+    currentPoolSize_ = 0;
+    
+    // 清理线程本地缓存
+    std::lock_guard<std::mutex> threadLock(threadCacheMutex_);
+    // 注意：线程本地缓存通常会在线程结束时自动销毁，这里只是为了确保所有资源都被释放
+}
+
+// 线程退出时释放本地缓存中的对象
+AsyncLogQueue::ThreadLocalCache::~ThreadLocalCache() {
+    for (auto entry : entries) {
+        delete entry;
+    }
+    entries.clear();
+}
+
+// 生产者通道构造函数
+AsyncLogQueue::ProducerLane::ProducerLane(size_t capacity) :
+    ring(capacity),
+    inFlightSince(UINT64_MAX),
+    retired(false),
+    closed(false) {
+}
+
+// 线程退出时将其拥有的通道全部标记为退役，由工作线程排空后回收
+AsyncLogQueue::ThreadLaneRegistry::~ThreadLaneRegistry() {
+    for (auto& item : lanes) {
+        item.second->retired.store(true, std::memory_order_release);
+    }
+}
+
+// 查找当前线程在本队列中已注册的通道，尚未注册时返回nullptr
+AsyncLogQueue::ProducerLane* AsyncLogQueue::findProducerLane() const {
+    if (!threadLanes) {
+        return nullptr;
+    }
+    ThreadLaneRegistry& registry = *threadLanes;
+    
+    // 绝大多数线程只写一个队列，优先命中最近使用的通道
+    if (registry.lastQueueId == queueId_) {
+        return registry.lastLane;
+    }
+    for (auto& item : registry.lanes) {
+        if (item.first == queueId_) {
+            registry.lastQueueId = queueId_;
+            registry.lastLane = item.second.get();
+            return registry.lastLane;
+        }
+    }
+    return nullptr;
+}
+
+// 获取当前线程在本队列中的通道
+AsyncLogQueue::ProducerLane* AsyncLogQueue::getProducerLane() {
+    ProducerLane* existing = findProducerLane();
+    if (existing) {
+        return existing;
+    }
+    if (!threadLanes) {
+        threadLanes.reset(new ThreadLaneRegistry());
+    }
+    ThreadLaneRegistry& registry = *threadLanes;
+    
+    // 丢弃已销毁队列遗留的通道
+    registry.lanes.erase(std::remove_if(registry.lanes.begin(), registry.lanes.end(),
+        [](const std::pair<uint64_t, std::shared_ptr<ProducerLane>>& item) {
+            return item.second->closed.load(std::memory_order_acquire);
+        }), registry.lanes.end());
+    
+    // 首次在本队列写日志，注册新通道
+    std::shared_ptr<ProducerLane> lane(new ProducerLane(laneSize_));
+    {
+        std::lock_guard<std::mutex> lock(lanesMutex_);
+        lanes_.push_back(lane);
+        // 与dequeueLanes中的水位线读写同属单一全序，新通道不会被工作线程遗漏而不提升时间戳
+        lanesVersion_.fetch_add(1, std::memory_order_seq_cst);
+    }
+    registry.lanes.emplace_back(queueId_, lane);
+    registry.lastQueueId = queueId_;
+    registry.lastLane = lane.get();
+    return registry.lastLane;
+}
+
+// 获取当前线程的本地缓存
+AsyncLogQueue::ThreadLocalCache& AsyncLogQueue::getThreadLocalCache() {
+    if (!threadLocalCache) {
+        threadLocalCache = std::make_unique<ThreadLocalCache>();
+        threadLocalCache->entries.reserve(ThreadLocalCache::CACHE_SIZE);
+        
+        // 注册到全局线程缓存映射中，以便后续管理
+        std::lock_guard<std::mutex> lock(threadCacheMutex_);
+        threadCaches_[std::this_thread::get_id()] = threadLocalCache.get();
+    }
+    return *threadLocalCache;
+}
+
+// 从本地缓存批量转移对象到全局池
+void AsyncLogQueue::refillGlobalPool(ThreadLocalCache& cache) {
+    if (cache.entries.empty()) return;
+    
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    
+    // 批量转移，减少锁争用
+    freeList_.insert(freeList_.end(), cache.entries.begin(), cache.entries.end());
+    
+    // 更新当前池大小
+    currentPoolSize_ = freeList_.size();
+    size_t current = currentPoolSize_.load();
+    size_t peak = peakPoolSize_.load();
+    if (current > peak) {
+        peakPoolSize_.store(current);
+    }
+    
+    // 清空本地缓存
+    cache.entries.clear();
+}
+
+// AsyncLogQueue 静态成员变量定义
+int AsyncLogQueue::flushIntervalMs_ = 1000;
+
+// 设置日志处理回调函数
+void AsyncLogQueue::setLogHandler(AsyncLogQueue::LogHandler handler) {
+    logHandler_ = std::move(handler);
+}
+
+// 设置本队列的溢出策略（应在开始入队前调用）
+bool AsyncLogQueue::setOverflowPolicy(OverflowPolicy policy, int timeoutMs, const char* spillPath, size_t spillBytes) {
+    overflowTimeoutMs_ = timeoutMs > 0 ? timeoutMs : 0;
+    if (policy == OverflowPolicy::spill && !spill_) {
+        std::unique_ptr<SpillFile> spill(new SpillFile());
+        if (!spill->open(spillPath, spillBytes)) {
+            overflowPolicy_ = OverflowPolicy::blockWithTimeout;
+            return false;
+        }
+        spillDecoded_.reserve(maxBatchSize_);
+        spill_ = std::move(spill);
+    }
+    overflowPolicy_ = policy;
+    return true;
+}
+
+OverflowPolicy AsyncLogQueue::overflowPolicy() const {
+    return overflowPolicy_;
+}
+
+// 启用优先级通道（应在开始入队前调用）
+void AsyncLogQueue::setPriorityLane(LogLevel level, size_t capacity) {
+    std::lock_guard<std::mutex> lock(priorityMutex_);
+    priorityCapacity_ = capacity > 0 ? capacity : 1;
+    priorityQueue_.reserve(priorityCapacity_);
+    priorityBatch_.reserve(priorityCapacity_);
+    priorityLevel_ = level;
+}
+
+// 设置等待策略（应在开始入队前调用）
+void AsyncLogQueue::setWaitStrategy(WaitStrategy strategy, int spinIterations, int batchIntervalUs) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    waitStrategy_.store(strategy, std::memory_order_relaxed);
+    spinIterations_.store(spinIterations > 0 ? spinIterations : 0, std::memory_order_relaxed);
+    batchIntervalUs_.store(batchIntervalUs > 0 ? batchIntervalUs : 1, std::memory_order_relaxed);
+    // 工作线程可能正按原策略休眠（构造时工作线程先于策略设置启动），唤醒它并清除休眠标志，
+    // 避免随后的生产者再按原策略通知一次
+    consumerSleeping_.store(false, std::memory_order_relaxed);
+    notEmpty_.notify_one();
+}
+
+WaitStrategy AsyncLogQueue::waitStrategy() const {
+    return waitStrategy_.load(std::memory_order_relaxed);
+}
+
+// 启用自适应批量大小（应在开始入队前调用）
+void AsyncLogQueue::setAdaptiveBatching(bool enabled, size_t minBatchSize, int latencyTargetUs) {
+    size_t lower = std::max<size_t>(1, std::min(minBatchSize, maxBatchSize_));
+    minBatchSize_.store(enabled ? lower : maxBatchSize_, std::memory_order_relaxed);
+    batchLatencyNanos_.store(static_cast<uint64_t>(latencyTargetUs > 0 ? latencyTargetUs : 1) * 1000,
+                             std::memory_order_relaxed);
+    // 尚无耗时估计时从下界开始，积压时每批成倍放大
+    batchLimit_.store(enabled ? lower : maxBatchSize_, std::memory_order_relaxed);
+    adaptiveBatching_.store(enabled, std::memory_order_release);
+}
+
+// 设置优先级通道的处理回调
+void AsyncLogQueue::setPriorityHandler(AsyncLogQueue::LogHandler handler) {
+    priorityHandler_ = std::move(handler);
+}
+
+// 将高优先级日志复制一份放入优先级通道
+bool AsyncLogQueue::expedite(const LogEntry& entry) {
+    // 已暂停或通道已满时直接按未提前处理，不必先复制条目
+    LogEntry* copy = nullptr;
+    if (!expediteHeld_.load(std::memory_order_acquire) &&
+        priorityPending_.load(std::memory_order_relaxed) < priorityCapacity_) {
+        copy = allocateEntry();
+        copy->level = entry.level;
+        copy->line = entry.line;
+        copy->timestamp = entry.timestamp;
+        copy->format = entry.format;
+        copy->siteId = entry.siteId;
+        copy->setFile(entry.file, entry.fileLen);
+        copy->setMessage(entry.message, entry.messageLen);
+    }
+    
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(priorityMutex_);
+        if (copy && !expediteHeld_.load(std::memory_order_relaxed) && priorityQueue_.size() < priorityCapacity_) {
+            priorityQueue_.push_back(copy);
+            priorityPending_.fetch_add(1, std::memory_order_relaxed);
+            queued = true;
+        } else {
+            // 未能提前：暂停提前输出，直到工作线程处理到这一条，否则后续条目会先于它到达优先级输出目标
+            expediteHeld_.store(true, std::memory_order_relaxed);
+            expediteMissesInFlight_++;
+        }
+    }
+    
+    if (!queued) {
+        // 只按常规顺序输出，不阻塞生产者；调用方入队后须调用finishExpediteMisses
+        expediteMisses_.fetch_add(1, std::memory_order_relaxed);
+        if (copy) {
+            freeEntry(copy);
+        }
+        return false;
+    }
+    expeditedEntries_.fetch_add(1, std::memory_order_relaxed);
+    wakeConsumer();
+    return true;
+}
+
+// 未能提前的条目已按常规顺序入队：记下需等待处理到的序号
+void AsyncLogQueue::finishExpediteMisses(size_t count) {
+    uint64_t sequence = lastSequence();
+    std::lock_guard<std::mutex> lock(priorityMutex_);
+    expediteFence_ = std::max(expediteFence_, sequence);
+    expediteMissesInFlight_ -= count;
+}
+
+// 工作线程公布已处理的序号后，未能提前的条目都已处理完时恢复提前输出
+void AsyncLogQueue::resumeExpedite() {
+    if (!expediteHeld_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(priorityMutex_);
+    if (expediteMissesInFlight_ == 0 && processedSequence_.load(std::memory_order_acquire) >= expediteFence_) {
+        expediteHeld_.store(false, std::memory_order_release);
+    }
+}
+
+// 把优先级通道中的日志交给优先级回调
+void AsyncLogQueue::deliverPriority() {
+    if (priorityPending_.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(priorityMutex_);
+        priorityBatch_.swap(priorityQueue_);
+        priorityPending_.store(0, std::memory_order_relaxed);
+    }
+    
+    const LogHandler& handler = priorityHandler_ ? priorityHandler_ : logHandler_;
+    if (handler) {
+        try {
+            handler(priorityBatch_);
+        } catch (const std::exception& e) {
+            std::cerr << "Error in priority log handler: " << e.what() << std::endl;
+        }
+    }
+    freeBatch(priorityBatch_);
+    priorityBatch_.clear();
+}
+
+// 记录一次溢出
+void AsyncLogQueue::recordOverflow() {
+    std::lock_guard<std::mutex> statsLock(statsMutex_);
+    stats_.totalOverflows++;
+}
+
+// 记录一条因溢出而丢弃的日志
+void AsyncLogQueue::recordDrop(LogLevel level) {
+    std::lock_guard<std::mutex> statsLock(statsMutex_);
+    stats_.totalDropped++;
+    size_t index = static_cast<size_t>(level);
+    if (index < LOG_LEVEL_COUNT) {
+        stats_.droppedByLevel[index]++;
+    }
+}
+
+// dropByLevel策略：低于warn的日志只能使用容量的7/8
+bool AsyncLogQueue::shedLowLevel(LogLevel level, size_t used, size_t capacity) const {
+    return overflowPolicy_ == OverflowPolicy::dropByLevel && level < LogLevel::warn &&
+           used >= capacity - capacity / 8;
+}
+
+// 无锁引擎队列已满时按溢出策略处理
+template <typename TryPush>
+bool AsyncLogQueue::handleOverflow(LogLevel level, TryPush&& tryPush) {
+    recordOverflow();
+    OverflowPolicy policy = overflowPolicy_;
+    // 生产者不能从单消费者结构中取出最早的条目，dropOldest在无锁引擎中与dropNewest相同，丢弃本条而不等待
+    if (policy == OverflowPolicy::dropNewest || policy == OverflowPolicy::dropOldest ||
+        (policy == OverflowPolicy::dropByLevel && level < LogLevel::warn)) {
+        return false;
+    }
+    
+    // 让出CPU等待消费者腾出空间；只有block策略不设期限
+    bool bounded = (policy == OverflowPolicy::blockWithTimeout || policy == OverflowPolicy::dropByLevel);
+    wakeConsumer();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(overflowTimeoutMs_);
+    while (!tryPush()) {
+        if (isStopped() || (bounded && std::chrono::steady_clock::now() >= deadline)) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+// 写入溢出文件
+AsyncLogQueue::SpillResult AsyncLogQueue::spillEntry(LogEntry* entry, bool start, uint64_t fence) {
+    size_t stored = 0;
+    if (!spillEntries(&entry, 1, start, fence, stored)) {
+        return SpillResult::inactive;
+    }
+    return stored > 0 ? SpillResult::spilled : SpillResult::dropped;
+}
+
+// 在一次加锁中将多个条目依次写入溢出文件
+bool AsyncLogQueue::spillEntries(LogEntry* const* entries, size_t count, bool start, uint64_t fence, size_t& stored) {
+    auto begin = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    stored = 0;
+    {
+        std::lock_guard<std::mutex> lock(spillMutex_);
+        if (!spillActive_.load(std::memory_order_relaxed)) {
+            if (!start) {
+                return false;
+            }
+            spillFence_ = fence;
+            spillActive_.store(true, std::memory_order_release);
+        }
+        
+        for (; stored < count; ++stored) {
+            size_t payloadLen = queuedRecordSize(entries[stored]);
+            char* payload = spill_->reserve(payloadLen);
+            if (!payload) {
+                break;
+            }
+            encodeQueuedRecord(payload, entries[stored]);
+            spill_->commit();
+            bytes += payloadLen;
+        }
+        if (stored > 0) {
+            threadSequence.queueId = queueId_;
+            threadSequence.sequence = (spillFence_ << 1) | 1;
+        }
+    }
+    
+    // 溢出文件已写满：丢弃剩余的条目（不能改写内存队列，否则会越过溢出文件中更早的日志）
+    dropEntries(entries + stored, count - stored);
+    if (stored == 0) {
+        return true;
+    }
+    
+    uint64_t nanos = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+    {
+        std::lock_guard<std::mutex> statsLock(statsMutex_);
+        stats_.spilledEntries += stored;
+        stats_.spilledBytes += bytes;
+        stats_.totalSpillNanos += nanos;
+        stats_.maxSpillNanos = std::max(stats_.maxSpillNanos, nanos);
+    }
+    
+    // 条目内容已复制进溢出文件，立即归还内存池
+    for (size_t i = 0; i < stored; ++i) {
+        freeEntry(entries[i]);
+    }
+    wakeConsumer();
+    return true;
+}
+
+// 内存队列已满：开始（或继续）溢出
+bool AsyncLogQueue::spillOverflow(LogEntry* entry, uint64_t fence) {
+    recordOverflow();
+    return spillEntry(entry, true, fence) == SpillResult::spilled;
+}
+
+size_t AsyncLogQueue::spillOverflow(LogEntry* const* entries, size_t count, uint64_t fence) {
+    recordOverflow();
+    size_t stored = 0;
+    spillEntries(entries, count, true, fence, stored);
+    return stored;
+}
+
+// 溢出中：新日志一律写入溢出文件，保持入队顺序
+bool AsyncLogQueue::continueSpill(LogEntry* entry, bool& accepted) {
+    if (!spillActive_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    SpillResult result = spillEntry(entry, false, 0);
+    if (result == SpillResult::inactive) {
+        return false;
+    }
+    accepted = (result == SpillResult::spilled);
+    return true;
+}
+
+bool AsyncLogQueue::continueSpill(LogEntry* const* entries, size_t count, size_t& accepted) {
+    if (!spillActive_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    return spillEntries(entries, count, false, 0, accepted);
+}
+
+// 将条目计入丢弃并归还内存池
+void AsyncLogQueue::dropEntries(LogEntry* const* entries, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        recordDrop(entries[i]->level);
+        freeEntry(entries[i]);
+    }
+}
+
+// dropByLevel策略：队列用量已进入保留区时丢弃批次中的低级别日志，其余条目保持原有顺序
+size_t AsyncLogQueue::shedBatch(LogEntry** entries, size_t count, size_t used, size_t capacity) {
+    if (!shedLowLevel(LogLevel::trace, used, capacity)) {
+        return count;
+    }
+    size_t kept = 0;
+    bool shed = false;
+    for (size_t i = 0; i < count; ++i) {
+        if (entries[i]->level < LogLevel::warn) {
+            dropEntries(entries + i, 1);
+            shed = true;
+        } else {
+            entries[kept++] = entries[i];
+        }
+    }
+    if (shed) {
+        recordOverflow();
+    }
+    return kept;
+}
+
+// 设置自动刷新间隔
+void AsyncLogQueue::setFlushIntervalMs(int ms) {
+    if (ms > 0) {
+        flushIntervalMs_ = ms;
+    }
+}
+
+// 添加日志到队列（拷贝版本）
+bool AsyncLogQueue::enqueue(const LogEntry& entry) {
+    // 由于LogEntry的拷贝构造函数被删除，从内存池取出一个条目并手动复制必要的字段
+    LogEntry* pooled = allocateEntry();
+    pooled->level = entry.level;
+    pooled->setMessage(entry.message, entry.messageLen);
+    pooled->setFile(entry.file, entry.fileLen);
+    pooled->line = entry.line;
+    pooled->timestamp = entry.timestamp;
+    pooled->format = entry.format;
+    pooled->siteId = entry.siteId;
+    return enqueue(pooled);
+}
+
+// 添加日志到队列（移动版本）
+bool AsyncLogQueue::enqueue(LogEntry&& entry) {
+    LogEntry* pooled = allocateEntry();
+    *pooled = std::move(entry);
+    return enqueue(pooled);
+}
+
+// 添加日志到队列（指针交接版本）
+bool AsyncLogQueue::enqueue(LogEntry* entry) {
+    if (!entry) {
+        return false;
+    }
+    
+    // 高优先级日志先把副本放入优先级通道，原条目仍按常规顺序入队
+    if (entry->level >= priorityLevel_ && !isStopped()) {
+        entry->expedited = expedite(*entry);
+        if (!entry->expedited) {
+            bool accepted = enqueueRegular(entry);
+            finishExpediteMisses(1);
+            return accepted;
+        }
+    }
+    return enqueueRegular(entry);
+}
+
+// 按队列引擎把条目放入常规队列
+bool AsyncLogQueue::enqueueRegular(LogEntry* entry) {
+    if (engine_ == QueueEngine::lockFree) {
+        return enqueueLockFree(entry);
+    }
+    if (engine_ == QueueEngine::recordRing) {
+        return enqueueRecord(entry);
+    }
+    if (engine_ == QueueEngine::perThreadLanes) {
+        return enqueueLane(entry);
+    }
+    
+    bool accepted = false;
+    if (!isStopped() && continueSpill(entry, accepted)) {
+        return accepted;
+    }
+    
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    
+    // 检查队列是否已满且已停止
+    if (isStopped()) {
+        lock.unlock();
+        freeEntry(entry);
+        return false;
+    }
+    
+    // dropByLevel策略：低级别日志超出其可用空间时丢弃
+    if (shedLowLevel(entry->level, queue_.size(), queueSize_)) {
+        recordOverflow();
+        recordDrop(entry->level);
+        lock.unlock();
+        freeEntry(entry);
+        return false;
+    }
+    
+    // 检查队列是否已满，按溢出策略处理
+    if (queue_.size() >= queueSize_) {
+        OverflowPolicy policy = overflowPolicy_;
+        if (policy == OverflowPolicy::spill) {
+            uint64_t fence = enqueueSequence_;
+            lock.unlock();
+            return spillOverflow(entry, fence);
+        }
+        recordOverflow();
+        bool dropped = false;
+        if (policy == OverflowPolicy::dropNewest) {
+            dropped = true;
+        } else if (policy == OverflowPolicy::dropOldest) {
+            // 在锁内直接丢弃最早的条目，序号随取出位置一起推进
+            LogEntry* oldest = queue_.front();
+            queue_.pop();
+            recordDrop(oldest->level);
+            freeEntry(oldest);
+        } else {
+            auto hasSpace = [this] { return queue_.size() < queueSize_ || isStopped(); };
+            if (policy == OverflowPolicy::block) {
+                notFull_.wait(lock, hasSpace);
+            } else {
+                notFull_.wait_for(lock, std::chrono::milliseconds(overflowTimeoutMs_), hasSpace);
+            }
+            dropped = queue_.size() >= queueSize_ || isStopped();
+        }
+        
+        if (dropped) {
+            recordDrop(entry->level);
+            lock.unlock();
+            freeEntry(entry);
+            return false;
+        }
+    }
+    
+    // 添加到队列（只传递指针）
+    queue_.push(entry);
+    queuedEntries_.store(queue_.size(), std::memory_order_relaxed);
+    setLastSequence(++enqueueSequence_);
+    
+    // 更新统计信息（消费者休眠的标志在queueMutex_内设置，锁内检查即可，不会丢失唤醒；
+    // 由第一个发现它的生产者清除，消费者被调度之前到达的其他生产者不再重复通知）
+    bool wake = consumerSleeping_.exchange(false, std::memory_order_relaxed);
+    { 
+        std::lock_guard<std::mutex> statsLock(statsMutex_);
+        stats_.totalEnqueued++;
+        stats_.currentQueueSize = queue_.size();
+        if (wake) {
+            stats_.producerWakeups++;
+        }
+    }
+    
+    // 只在消费者确实休眠时通知，避免每次入队都进行一次系统调用
+    if (wake) {
+        notEmpty_.notify_one();
+    }
+    return true;
+}
+
+// 无锁引擎的入队实现
+bool AsyncLogQueue::enqueueLockFree(LogEntry* entry) {
+    if (isStopped()) {
+        freeEntry(entry);
+        return false;
+    }
+    
+    bool accepted = false;
+    if (continueSpill(entry, accepted)) {
+        return accepted;
+    }
+    
+    if (shedLowLevel(entry->level, ring_->size(), queueSize_)) {
+        recordOverflow();
+        recordDrop(entry->level);
+        freeEntry(entry);
+        return false;
+    }
+    
+    size_t position = 0;
+    LogLevel level = entry->level;
+    if (!ring_->tryPush(std::move(entry), &position)) {
+        if (overflowPolicy_ == OverflowPolicy::spill) {
+            return spillOverflow(entry, ring_->totalPushed());
+        }
+        if (!handleOverflow(level, [&] { return ring_->tryPush(std::move(entry), &position); })) {
+            recordDrop(level);
+            freeEntry(entry);
+            return false;
+        }
+    }
+    
+    // 入队计数由环形缓冲区的写入位置推导，这里不再更新共享统计，避免缓存行争用
+    setLastSequence(position + 1);
+    wakeConsumer();
+    return true;
+}
+
+// 变长记录引擎的入队实现
+bool AsyncLogQueue::enqueueRecord(LogEntry* entry) {
+    if (isStopped()) {
+        freeEntry(entry);
+        return false;
+    }
+    
+    bool accepted = false;
+    if (continueSpill(entry, accepted)) {
+        return accepted;
+    }
+    
+    if (shedLowLevel(entry->level, records_->bytesUsed(), records_->capacity())) {
+        recordOverflow();
+        recordDrop(entry->level);
+        freeEntry(entry);
+        return false;
+    }
+    
+    size_t payloadLen = queuedRecordSize(entry);
+    size_t endPosition = 0;
+    char* payload = records_->tryReserve(payloadLen, &endPosition);
+    if (!payload) {
+        if (overflowPolicy_ == OverflowPolicy::spill) {
+            return spillOverflow(entry, records_->totalBytesReserved());
+        }
+        if (!handleOverflow(entry->level, [&] {
+                return (payload = records_->tryReserve(payloadLen, &endPosition)) != nullptr;
+            })) {
+            recordDrop(entry->level);
+            freeEntry(entry);
+            return false;
+        }
+    }
+    
+    // 按实际长度写入：[记录头 | 文件名 | 消息]
+    encodeQueuedRecord(payload, entry);
+    records_->commit(payload);
+    setLastSequence(endPosition);
+    
+    // 条目内容已复制进字节环，立即归还到当前线程的本地缓存，保持其在缓存中的热度
+    freeEntry(entry);
+    wakeConsumer();
+    return true;
+}
+
+// 通道引擎的入队实现
+bool AsyncLogQueue::enqueueLane(LogEntry* entry) {
+    ProducerLane* lane = getProducerLane();
+    if (isStopped()) {
+        freeEntry(entry);
+        return false;
+    }
+    bool accepted = false;
+    if (continueSpill(entry, accepted)) {
+        return accepted;
+    }
+    if (shedLowLevel(entry->level, lane->ring.size(), lane->ring.capacity())) {
+        recordOverflow();
+        recordDrop(entry->level);
+        freeEntry(entry);
+        return false;
+    }
+    
+    // 条目通常已在调用点取得时间戳，先将其公布为本通道的在途下界
+    uint64_t timestamp = entry->timestamp != 0 ? entry->timestamp : LogClock::now();
+    lane->inFlightSince.store(timestamp, std::memory_order_seq_cst);
+    // 公布下界之后复查停止标志（与fenceLaneProducers配对）：停止后的最终排空只等待此前已公布下界的生产者
+    if (isStopped()) {
+        lane->inFlightSince.store(UINT64_MAX, std::memory_order_release);
+        freeEntry(entry);
+        return false;
+    }
+    // 公布下界之前，工作线程可能已按更晚的水位线输出了其他通道的条目，
+    // 此时把本条目的时间戳提升到该水位线，保证合并结果仍然全局有序
+    entry->timestamp = std::max(timestamp, laneWatermark_.load(std::memory_order_seq_cst));
+    // 入队后条目可能立即被工作线程取走，先取得序号
+    uint64_t sequence = entry->timestamp + 1;
+    
+    if (!lane->ring.tryPush(entry)) {
+        if (overflowPolicy_ == OverflowPolicy::spill) {
+            lane->inFlightSince.store(UINT64_MAX, std::memory_order_release);
+            return spillOverflow(entry, sequence);
+        }
+        if (!handleOverflow(entry->level, [&] { return lane->ring.tryPush(entry); })) {
+            lane->inFlightSince.store(UINT64_MAX, std::memory_order_release);
+            recordDrop(entry->level);
+            freeEntry(entry);
+            return false;
+        }
+    }
+    
+    lane->inFlightSince.store(UINT64_MAX, std::memory_order_release);
+    setLastSequence(sequence);
+    wakeConsumer();
+    return true;
+}
+
+// 批量入队
+size_t AsyncLogQueue::enqueueBatch(LogEntry** entries, size_t count) {
+    if (!entries || count == 0) {
+        return 0;
+    }
+    
+    // 高优先级日志先把副本放入优先级通道，原条目仍随批次按常规顺序入队
+    size_t misses = 0;
+    if (!isStopped()) {
+        for (size_t i = 0; i < count; ++i) {
+            if (entries[i]->level >= priorityLevel_) {
+                entries[i]->expedited = expedite(*entries[i]);
+                misses += entries[i]->expedited ? 0 : 1;
+            }
+        }
+    }
+    
+    // 每段不超过队列容量，队列取空后总能整段放下（变长记录引擎按字节在内部分段）
+    size_t segment = count;
+    if (engine_ == QueueEngine::perThreadLanes) {
+        segment = laneSize_;
+    } else if (engine_ != QueueEngine::recordRing) {
+        segment = queueSize_;
+    }
+    segment = std::max<size_t>(segment, 1);
+    
+    size_t accepted = 0;
+    for (size_t offset = 0; offset < count; offset += segment) {
+        LogEntry** part = entries + offset;
+        size_t n = std::min(segment, count - offset);
+        if (engine_ == QueueEngine::lockFree) {
+            accepted += enqueueBatchLockFree(part, n);
+        } else if (engine_ == QueueEngine::recordRing) {
+            accepted += enqueueBatchRecord(part, n);
+        } else if (engine_ == QueueEngine::perThreadLanes) {
+            accepted += enqueueBatchLane(part, n);
+        } else {
+            accepted += enqueueBatchLocked(part, n);
+        }
+    }
+    if (misses > 0) {
+        finishExpediteMisses(misses);
+    }
+    return accepted;
+}
+
+// 互斥锁引擎的批量入队：一次加锁、一次统计更新、一次通知
+size_t AsyncLogQueue::enqueueBatchLocked(LogEntry** entries, size_t count) {
+    size_t accepted = 0;
+    if (!isStopped() && continueSpill(entries, count, accepted)) {
+        return accepted;
+    }
+    
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    if (isStopped()) {
+        lock.unlock();
+        for (size_t i = 0; i < count; ++i) {
+            freeEntry(entries[i]);
+        }
+        return 0;
+    }
+    
+    count = shedBatch(entries, count, queue_.size(), queueSize_);
+    if (count == 0) {
+        return 0;
+    }
+    
+    // 放不下整批时按溢出策略处理，整批一起等待或丢弃，不拆开
+    if (queue_.size() + count > queueSize_) {
+        OverflowPolicy policy = overflowPolicy_;
+        if (policy == OverflowPolicy::spill) {
+            uint64_t fence = enqueueSequence_;
+            lock.unlock();
+            return spillOverflow(entries, count, fence);
+        }
+        recordOverflow();
+        bool dropped = false;
+        if (policy == OverflowPolicy::dropNewest) {
+            dropped = true;
+        } else if (policy == OverflowPolicy::dropOldest) {
+            while (!queue_.empty() && queue_.size() + count > queueSize_) {
+                LogEntry* oldest = queue_.front();
+                queue_.pop();
+                recordDrop(oldest->level);
+                freeEntry(oldest);
+            }
+        } else {
+            auto hasSpace = [this, count] { return queue_.size() + count <= queueSize_ || isStopped(); };
+            if (policy == OverflowPolicy::block) {
+                notFull_.wait(lock, hasSpace);
+            } else {
+                notFull_.wait_for(lock, std::chrono::milliseconds(overflowTimeoutMs_), hasSpace);
+            }
+            dropped = queue_.size() + count > queueSize_ || isStopped();
+        }
+        
+        if (dropped) {
+            lock.unlock();
+            dropEntries(entries, count);
+            return 0;
+        }
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        queue_.push(entries[i]);
+    }
+    queuedEntries_.store(queue_.size(), std::memory_order_relaxed);
+    enqueueSequence_ += count;
+    setLastSequence(enqueueSequence_);
+    
+    bool wake = consumerSleeping_.exchange(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> statsLock(statsMutex_);
+        stats_.totalEnqueued += count;
+        stats_.currentQueueSize = queue_.size();
+        if (wake) {
+            stats_.producerWakeups++;
+        }
+    }
+    
+    if (wake) {
+        notEmpty_.notify_one();
+    }
+    return count;
+}
+
+// 无锁引擎的批量入队：一次CAS抢占连续的写入位置
+size_t AsyncLogQueue::enqueueBatchLockFree(LogEntry** entries, size_t count) {
+    if (isStopped()) {
+        for (size_t i = 0; i < count; ++i) {
+            freeEntry(entries[i]);
+        }
+        return 0;
+    }
+    
+    size_t accepted = 0;
+    if (continueSpill(entries, count, accepted)) {
+        return accepted;
+    }
+    
+    count = shedBatch(entries, count, ring_->size(), queueSize_);
+    if (count == 0) {
+        return 0;
+    }
+    
+    size_t position = 0;
+    if (!ring_->tryPushBatch(entries, count, &position)) {
+        if (overflowPolicy_ == OverflowPolicy::spill) {
+            return spillOverflow(entries, count, ring_->totalPushed());
+        }
+        if (!handleOverflow(highestLevel(entries, count), [&] { return ring_->tryPushBatch(entries, count, &position); })) {
+            dropEntries(entries, count);
+            return 0;
+        }
+    }
+    
+    setLastSequence(position + count);
+    wakeConsumer();
+    return count;
+}
+
+// 变长记录引擎的批量入队：整批编码进一条打包记录，只预留一次空间
+size_t AsyncLogQueue::enqueueBatchRecord(LogEntry** entries, size_t count) {
+    if (isStopped()) {
+        for (size_t i = 0; i < count; ++i) {
+            freeEntry(entries[i]);
+        }
+        return 0;
+    }
+    
+    size_t accepted = 0;
+    if (continueSpill(entries, count, accepted)) {
+        return accepted;
+    }
+    
+    count = shedBatch(entries, count, records_->bytesUsed(), records_->capacity());
+    
+    // 单条记录不能超过字节环容量的一半，更大的批次拆成多条打包记录
+    size_t maxPayload = records_->capacity() / 2 - 16;
+    size_t committed = 0;
+    while (committed < count) {
+        LogEntry** part = entries + committed;
+        size_t payloadLen = sizeof(QueuedRecordHeader);
+        size_t n = 0;
+        while (committed + n < count) {
+            size_t length = sizeof(uint32_t) + queuedRecordSize(part[n]);
+            if (n > 0 && payloadLen + length > maxPayload) {
+                break;
+            }
+            payloadLen += length;
+            n++;
+        }
+        
+        size_t endPosition = 0;
+        char* payload = records_->tryReserve(payloadLen, &endPosition);
+        if (!payload) {
+            if (overflowPolicy_ == OverflowPolicy::spill) {
+                accepted = spillOverflow(part, count - committed, records_->totalBytesReserved());
+                break;
+            }
+            if (!handleOverflow(highestLevel(part, n), [&] {
+                    return (payload = records_->tryReserve(payloadLen, &endPosition)) != nullptr;
+                })) {
+                dropEntries(part, count - committed);
+                break;
+            }
+        }
+        
+        encodeQueuedBatch(payload, part, n);
+        records_->commit(payload, n);
+        setLastSequence(endPosition);
+        committed += n;
+    }
+    
+    // 已编码的条目立即归还内存池
+    for (size_t i = 0; i < committed; ++i) {
+        freeEntry(entries[i]);
+    }
+    if (committed > 0) {
+        wakeConsumer();
+    }
+    return committed + accepted;
+}
+
+// 通道引擎的批量入队：整批共用一个时间戳，合并时同一通道内时间戳相同的条目保持连续
+size_t AsyncLogQueue::enqueueBatchLane(LogEntry** entries, size_t count) {
+    ProducerLane* lane = getProducerLane();
+    if (isStopped()) {
+        for (size_t i = 0; i < count; ++i) {
+            freeEntry(entries[i]);
+        }
+        return 0;
+    }
+    size_t accepted = 0;
+    if (continueSpill(entries, count, accepted)) {
+        return accepted;
+    }
+    count = shedBatch(entries, count, lane->ring.size(), lane->ring.capacity());
+    if (count == 0) {
+        return 0;
+    }
+    
+    // 取批次中第一条（最早）的时间戳作为在途下界，与单条入队相同地按水位线提升
+    uint64_t timestamp = entries[0]->timestamp != 0 ? entries[0]->timestamp : LogClock::now();
+    lane->inFlightSince.store(timestamp, std::memory_order_seq_cst);
+    if (isStopped()) {
+        lane->inFlightSince.store(UINT64_MAX, std::memory_order_release);
+        for (size_t i = 0; i < count; ++i) {
+            freeEntry(entries[i]);
+        }
+        return 0;
+    }
+    timestamp = std::max(timestamp, laneWatermark_.load(std::memory_order_seq_cst));
+    for (size_t i = 0; i < count; ++i) {
+        entries[i]->timestamp = timestamp;
+    }
+    uint64_t sequence = timestamp + 1;
     
-    // 释放全局内存池中的对象
-    std::lock_guard<std::mutex> lock(poolMutex_);
-    for (auto entry : freeList_) {
-        delete entry;
+    if (!lane->ring.tryPushBatch(entries, count)) {
+        if (overflowPolicy_ == OverflowPolicy::spill) {
+            lane->inFlightSince.store(UINT64_MAX, std::memory_order_release);
+            return spillOverflow(entries, count, sequence);
+        }
+        if (!handleOverflow(highestLevel(entries, count), [&] { return lane->ring.tryPushBatch(entries, count); })) {
+            lane->inFlightSince.store(UINT64_MAX, std::memory_order_release);
+            dropEntries(entries, count);
+            return 0;
+        }
     }
-    freeList_.clear();
-    currentPoolSize_ = 0;
     
-    // 清理线程本地缓存
-    std::lock_guard<std::mutex> threadLock(threadCacheMutex_);
-    // 注意：线程本地缓存通常会在线程结束时自动销毁，这里只是为了确保所有资源都被释放
+    lane->inFlightSince.store(UINT64_MAX, std::memory_order_release);
+    setLastSequence(sequence);
+    wakeConsumer();
+    return count;
 }
 
-// 获取当前线程的本地缓存
-AsyncLogQueue::ThreadLocalCache& AsyncLogQueue::getThreadLocalCache() {
-    if (!threadLocalCache) {
-        threadLocalCache = std::make_unique<ThreadLocalCache>();
-        threadLocalCache->entries.reserve(ThreadLocalCache::CACHE_SIZE);
-        
-        // 注册到全局线程缓存映射中，以便后续管理
-        std::lock_guard<std::mutex> lock(threadCacheMutex_);
-        threadCaches_[std::this_thread::get_id()] = threadLocalCache.get();
+// 通道引擎的出队实现
+void AsyncLogQueue::dequeueLanes(std::vector<LogEntry*>& batch) {
+    // 先公布本轮水位线的上界：此后才公布在途下界的生产者能够看到它并据此提升时间戳
+    uint64_t watermark = LogClock::now();
+    laneWatermark_.store(watermark, std::memory_order_seq_cst);
+    
+    // 通道列表有变化时才加锁刷新快照
+    if (lanesVersion_.load(std::memory_order_seq_cst) != workerLanesVersion_) {
+        std::lock_guard<std::mutex> lock(lanesMutex_);
+        workerLanes_ = lanes_;
+        workerLanesVersion_ = lanesVersion_.load(std::memory_order_relaxed);
+        // 归并堆最多每个通道一项：只在通道列表变化时扩容，之后每轮复用
+        mergeHeap_.reserve(workerLanes_.size());
     }
-    return *threadLocalCache;
-}
-
-// 从本地缓存批量转移对象到全局池
-void AsyncLogQueue::refillGlobalPool(ThreadLocalCache& cache) {
-    if (cache.entries.empty()) return;
     
-    std::lock_guard<std::mutex> lock(poolMutex_);
+    // 水位线：当前时间与所有正在入队的生产者时间下界中的最小值，
+    // 只输出早于水位线的条目，之后到达的条目时间戳一定不小于水位线，从而保证全局有序
+    uint64_t inFlight = UINT64_MAX;
+    for (const auto& lane : workerLanes_) {
+        inFlight = std::min(inFlight, lane->inFlightSince.load(std::memory_order_seq_cst));
+    }
+    // 时间戳等于在途下界的条目也可以输出：在途条目的时间戳不会小于该下界，相等的时间戳先后不影响有序。
+    // 否则粗粒度时钟下通道写满时，其中的条目与阻塞的生产者同属一个计数，通道永远无法排空。
+    // 停止后的最终排空不再有新条目，与当前时刻同一计数的条目也要取出
+    uint64_t mergeLimit = watermark;
+    if (drainingLanes_) {
+        mergeLimit = UINT64_MAX;
+    } else if (inFlight < watermark) {
+        mergeLimit = inFlight + 1;
+    }
+    watermark = std::min(watermark, inFlight);
     
-    // 批量转移，减少锁争用
-    freeList_.insert(freeList_.end(), cache.entries.begin(), cache.entries.end());
+    // 按(时间戳, 通道下标)做k路归并，同一通道内时间戳相同的条目保持连续
+    typedef std::pair<uint64_t, size_t> HeapItem;
+    std::vector<HeapItem>& heap = mergeHeap_;
+    heap.clear();
+    for (size_t i = 0; i < workerLanes_.size(); ++i) {
+        LogEntry** head = workerLanes_[i]->ring.front();
+        if (head && (*head)->timestamp < mergeLimit) {
+            heap.emplace_back((*head)->timestamp, i);
+        }
+    }
+    std::make_heap(heap.begin(), heap.end(), std::greater<HeapItem>());
     
-    // 更新当前池大小
-    currentPoolSize_ = freeList_.size();
-    size_t current = currentPoolSize_.load();
-    size_t peak = peakPoolSize_.load();
-    if (current > peak) {
-        peakPoolSize_.store(current);
+    uint64_t lastTimestamp = 0;
+    size_t maxCount = batchLimit_.load(std::memory_order_relaxed);
+    while (!heap.empty() && batch.size() < maxCount) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<HeapItem>());
+        lastTimestamp = heap.back().first;
+        size_t index = heap.back().second;
+        heap.pop_back();
+        
+        SpscRingBuffer<LogEntry*>& ring = workerLanes_[index]->ring;
+        batch.push_back(*ring.front());
+        ring.pop();
+        
+        LogEntry** next = ring.front();
+        if (next && (*next)->timestamp < mergeLimit) {
+            heap.emplace_back((*next)->timestamp, index);
+            std::push_heap(heap.begin(), heap.end(), std::greater<HeapItem>());
+        }
+    }
+    // 序号为时间戳加1：早于水位线的条目已全部取出；批次已满时只能确定早于最后一条时间戳的条目已全部取出
+    // （与在途下界相等的条目虽已取出，在途条目可能取同一时间戳，仍只公布到水位线；最终排空时取出的条目可能晚于水位线）
+    if (!heap.empty()) {
+        dequeuedSequence_ = lastTimestamp;
+    } else {
+        dequeuedSequence_ = drainingLanes_ ? std::max(watermark, lastTimestamp + 1) : watermark;
     }
     
-    // 清空本地缓存
-    cache.entries.clear();
+    // 回收所属线程已退出且已排空的通道
+    bool hasRetired = false;
+    for (const auto& lane : workerLanes_) {
+        if (lane->retired.load(std::memory_order_acquire) && lane->ring.empty()) {
+            hasRetired = true;
+            break;
+        }
+    }
+    if (hasRetired) {
+        std::lock_guard<std::mutex> lock(lanesMutex_);
+        auto isDrained = [](const std::shared_ptr<ProducerLane>& lane) {
+            return lane->retired.load(std::memory_order_acquire) && lane->ring.empty();
+        };
+        for (const auto& lane : lanes_) {
+            if (isDrained(lane)) {
+                retiredLaneEnqueued_ += lane->ring.totalPushed();
+            }
+        }
+        lanes_.erase(std::remove_if(lanes_.begin(), lanes_.end(), isDrained), lanes_.end());
+        workerLanes_ = lanes_;
+        workerLanesVersion_ = lanesVersion_.fetch_add(1, std::memory_order_release) + 1;
+    }
 }
 
-// AsyncLogQueue 静态成员变量定义
-bool AsyncLogQueue::dropOnOverflow_ = false;
-int AsyncLogQueue::flushIntervalMs_ = 1000;
+// 停止后等待在途的生产者完成入队
+void AsyncLogQueue::fenceLaneProducers() {
+    // 停止标志已先于此处设置：此后注册通道或公布下界的生产者复查时都会看到它而放弃入队，
+    // 只需等待此前已公布下界的生产者（阻塞中的生产者看到停止标志后也会放弃）
+    std::vector<std::shared_ptr<ProducerLane>> lanes;
+    {
+        std::lock_guard<std::mutex> lock(lanesMutex_);
+        lanes = lanes_;
+    }
+    for (const auto& lane : lanes) {
+        while (lane->inFlightSince.load(std::memory_order_seq_cst) != UINT64_MAX) {
+            std::this_thread::yield();
+        }
+    }
+    drainingLanes_ = true;
+}
 
-// 设置日志处理回调函数
-void AsyncLogQueue::setLogHandler(AsyncLogQueue::LogHandler handler) {
-    logHandler_ = std::move(handler);
+// 通道引擎的队列大小
+size_t AsyncLogQueue::laneQueueSize() const {
+    std::lock_guard<std::mutex> lock(lanesMutex_);
+    size_t total = 0;
+    for (const auto& lane : lanes_) {
+        total += lane->ring.size();
+    }
+    return total;
 }
 
-// 设置队列溢出时是否丢弃日志
-void AsyncLogQueue::setDropOnOverflow(bool drop) {
-    dropOnOverflow_ = drop;
+// 处理完成后归还批次
+void AsyncLogQueue::releaseBatch(const std::vector<LogEntry*>& batch) {
+    // 变长记录引擎与溢出文件的批次都是工作线程私有的解码条目
+    if (engine_ == QueueEngine::recordRing || batchFromSpill_) {
+        return;
+    }
+    freeBatch(batch);
 }
 
-// 设置自动刷新间隔
-void AsyncLogQueue::setFlushIntervalMs(int ms) {
-    if (ms > 0) {
-        flushIntervalMs_ = ms;
+// 唤醒正在休眠的消费者
+void AsyncLogQueue::wakeConsumer() {
+    // 与parkConsumer中设置consumerSleeping_后的栅栏配对，保证不会丢失唤醒；
+    // 自旋中的消费者和timedBatch策略下的消费者不设置该标志，生产者不需要任何通知。
+    // 标志由第一个发现它的生产者清除，消费者被调度之前到达的其他生产者不再重复通知
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumerSleeping_.load(std::memory_order_relaxed) &&
+        consumerSleeping_.exchange(false, std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            notEmpty_.notify_one();
+        }
+        std::lock_guard<std::mutex> statsLock(statsMutex_);
+        stats_.producerWakeups++;
     }
 }
 
-// 添加日志到队列（拷贝版本）
-bool AsyncLogQueue::enqueue(const LogEntry& entry) {
-    // 由于LogEntry的拷贝构造函数被删除，我们需要创建一个新的LogEntry对象并手动复制必要的字段
-    LogEntry tempEntry;
-    tempEntry.level = entry.level;
-    // 复制message字段
-    memcpy(tempEntry.message, entry.message, sizeof(tempEntry.message));
-    tempEntry.message[sizeof(tempEntry.message) - 1] = '\0'; // 确保字符串以null结尾
-    // 复制其他字段
-    tempEntry.line = entry.line;
-    tempEntry.file[0] = '\0'; // 清空file字段
-    // 调用移动版本的enqueue方法
-    return enqueue(std::move(tempEntry));
+// 队列为空时按等待策略等待新的日志
+void AsyncLogQueue::waitForEntries() {
+    WaitStrategy strategy = waitStrategy_.load(std::memory_order_relaxed);
+    if (strategy == WaitStrategy::timedBatch) {
+        // 生产者从不通知，按固定间隔醒来处理积累的日志（waitProcessed与stop仍会提前唤醒）
+        std::unique_lock<std::mutex> lock(queueMutex_);
+        if (!stopRequested_ && sequenceWaiters_.load(std::memory_order_seq_cst) == 0) {
+            notEmpty_.wait_for(lock, std::chrono::microseconds(batchIntervalUs_.load(std::memory_order_relaxed)));
+        }
+        return;
+    }
+    if (strategy == WaitStrategy::park) {
+        parkConsumer();
+        return;
+    }
+    
+    // 自旋阶段只反复检查队列；有线程等待序号推进时立即返回，通道引擎需要新一轮合并才能推进水位线
+    auto idle = [this] {
+        return isQueueEmptyUnlocked() && !stopRequested_ && sequenceWaiters_.load(std::memory_order_relaxed) == 0;
+    };
+    const int PARK_YIELDS = 64;  // spinPark策略休眠之前让出CPU的次数
+    int spinIterations = spinIterations_.load(std::memory_order_relaxed);
+    for (int i = 0; idle(); ++i) {
+        if (strategy == WaitStrategy::busySpin || i < spinIterations) {
+            continue;
+        }
+        if (strategy == WaitStrategy::spinPark && i >= spinIterations + PARK_YIELDS) {
+            parkConsumer();
+            return;
+        }
+        std::this_thread::yield();
+    }
 }
 
-// 添加日志到队列（移动版本）
-bool AsyncLogQueue::enqueue(LogEntry&& entry) {
+// 工作线程休眠
+void AsyncLogQueue::parkConsumer() {
     std::unique_lock<std::mutex> lock(queueMutex_);
-    
-    // 检查队列是否已满且已停止
-    if (isStopped()) {
+    // 先声明即将休眠，再复查队列，生产者只在该标志置位时才通知
+    consumerSleeping_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    WaitStrategy strategy = waitStrategy_.load(std::memory_order_relaxed);
+    bool parking = strategy == WaitStrategy::park || strategy == WaitStrategy::spinPark;
+    if (parking && isQueueEmpty() && !stopRequested_) {
+        {
+            std::lock_guard<std::mutex> statsLock(statsMutex_);
+            stats_.consumerParks++;
+        }
+        if (sequenceWaiters_.load(std::memory_order_seq_cst) > 0) {
+            // 有线程在等待序号推进时只短暂休眠，通道引擎需要新一轮合并才能推进水位线
+            notEmpty_.wait_for(lock, std::chrono::milliseconds(1));
+        } else {
+            // 空闲时一直休眠到生产者通知，不再按刷新间隔定时醒来
+            notEmpty_.wait(lock);
+        }
+    }
+    consumerSleeping_.store(false, std::memory_order_relaxed);
+}
+
+// 判断队列是否为空（含溢出文件）
+bool AsyncLogQueue::isQueueEmpty() const {
+    return isMemoryEmpty() && !spillActive_.load(std::memory_order_acquire) &&
+           priorityPending_.load(std::memory_order_acquire) == 0;
+}
+
+// 判断内存队列是否为空（按引擎类型分派）
+bool AsyncLogQueue::isMemoryEmpty() const {
+    if (engine_ == QueueEngine::lockFree) {
+        return ring_->empty();
+    }
+    if (engine_ == QueueEngine::recordRing) {
+        return records_->empty();
+    }
+    if (engine_ == QueueEngine::perThreadLanes) {
+        return laneQueueSize() == 0;
+    }
+    return queuedEntries_.load(std::memory_order_relaxed) == 0;
+}
+
+// 自旋检查用的队列判空（只由工作线程调用）
+bool AsyncLogQueue::isQueueEmptyUnlocked() const {
+    if (spillActive_.load(std::memory_order_acquire) || priorityPending_.load(std::memory_order_acquire) != 0) {
         return false;
     }
-    
-    // 检查队列是否已满
-    if (queue_.size() >= queueSize_) {
-        // 根据配置决定是丢弃还是等待
-        if (dropOnOverflow_) {
-            // 更新统计信息
-            { 
-                std::lock_guard<std::mutex> statsLock(statsMutex_);
-                stats_.totalDropped++;
-            }
+    if (engine_ == QueueEngine::lockFree) {
+        return ring_->empty();
+    }
+    if (engine_ == QueueEngine::recordRing) {
+        return records_->empty();
+    }
+    if (engine_ == QueueEngine::perThreadLanes) {
+        // 只查看工作线程私有的通道快照；通道列表有变化时结束自旋，由下一轮出队刷新快照
+        if (lanesVersion_.load(std::memory_order_acquire) != workerLanesVersion_) {
             return false;
         }
-        
-        // 不丢弃时等待队列不满
-        bool success = notFull_.wait_for(lock, std::chrono::milliseconds(100), 
-            [this] { return queue_.size() < queueSize_ || isStopped(); });
-        
-        if (!success || isStopped()) {
-            // 更新统计信息
-            { 
-                std::lock_guard<std::mutex> statsLock(statsMutex_);
-                stats_.totalDropped++;
+        for (const auto& lane : workerLanes_) {
+            if (!lane->ring.empty()) {
+                return false;
             }
-            return false;
         }
+        return true;
     }
-    
-    // 添加到队列（使用移动语义）
-    queue_.push(std::move(entry));
-    
-    // 更新统计信息
-    { 
-        std::lock_guard<std::mutex> statsLock(statsMutex_);
-        stats_.totalEnqueued++;
-        stats_.currentQueueSize = queue_.size();
-    }
-    
-    // 通知消费者
-    notEmpty_.notify_one();
-    return true;
+    return queuedEntries_.load(std::memory_order_relaxed) == 0;
 }
 
 // 刷新队列中的所有日志
+// 记下此刻的入队序号，等待工作线程处理完该序号之前的全部日志（不等待队列清空，持续写入时也能返回）
 bool AsyncLogQueue::flush(int timeoutMs) {
-    std::unique_lock<std::mutex> lock(queueMutex_);
-    
     if (isStopped()) {
         return false;
     }
     
-    // 通知工作线程有数据需要处理
-    notEmpty_.notify_one();
-    
-    // 等待队列清空
-    bool flushed = notFull_.wait_for(lock, std::chrono::milliseconds(timeoutMs == -1 ? 5000 : timeoutMs), 
-        [this] { return queue_.empty() || isStopped(); });
+    return waitProcessed(currentSequence(), timeoutMs);
+}
+
+// 调用线程最近一次入队的序号
+uint64_t AsyncLogQueue::lastSequence() const {
+    return threadSequence.queueId == queueId_ ? threadSequence.sequence : 0;
+}
+
+void AsyncLogQueue::setLastSequence(uint64_t sequence) {
+    threadSequence.queueId = queueId_;
+    threadSequence.sequence = sequence << 1;
+}
+
+// 此刻之前入队的全部日志都不超过的序号
+uint64_t AsyncLogQueue::currentSequence() const {
+    uint64_t sequence = rawCurrentSequence() << 1;
+    if (spillActive_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(spillMutex_);
+        if (spillActive_.load(std::memory_order_relaxed)) {
+            sequence = std::max(sequence, (spillFence_ << 1) | 1);
+        }
+    }
+    return sequence;
+}
+
+// 内存队列此刻的原始序号
+uint64_t AsyncLogQueue::rawCurrentSequence() const {
+    if (engine_ == QueueEngine::lockFree) {
+        // 已抢占但尚未写入的位置也计算在内，工作线程等其写入后按顺序取出
+        return ring_->totalPushed();
+    }
+    if (engine_ == QueueEngine::recordRing) {
+        return records_->totalBytesReserved();
+    }
+    if (engine_ == QueueEngine::perThreadLanes) {
+        // 已入队条目的时间戳不晚于此刻（被提升时也只提升到工作线程已公布的水位线）
+        return LogClock::now() + 1;
+    }
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return enqueueSequence_;
+}
+
+uint64_t AsyncLogQueue::processedSequence() const {
+    return processedSequence_.load(std::memory_order_acquire);
+}
+
+// 等待序号推进到sequence
+bool AsyncLogQueue::waitProcessed(uint64_t sequence, int timeoutMs) {
+    if (processedSequence_.load(std::memory_order_seq_cst) >= sequence) {
+        return true;
+    }
+    sequenceWaiters_.fetch_add(1, std::memory_order_seq_cst);
+    {
+        // 工作线程在队列为空时可能正在休眠，通道引擎需要它再合并一轮才能推进水位线
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        notEmpty_.notify_one();
+    }
     
-    return flushed;
+    std::unique_lock<std::mutex> lock(sequenceMutex_);
+    auto done = [this, sequence] {
+        return processedSequence_.load(std::memory_order_seq_cst) >= sequence || isStopped();
+    };
+    if (timeoutMs < 0) {
+        sequenceDone_.wait(lock, done);
+    } else {
+        sequenceDone_.wait_for(lock, std::chrono::milliseconds(timeoutMs), done);
+    }
+    sequenceWaiters_.fetch_sub(1, std::memory_order_relaxed);
+    return processedSequence_.load(std::memory_order_acquire) >= sequence;
+}
+
+// 公布已处理的序号（sequence为内存队列的原始序号）
+void AsyncLogQueue::publishProcessed(uint64_t rawSequence) {
+    uint64_t sequence = rawSequence << 1;
+    if (spill_) {
+        // 溢出中不能越过溢出文件中尚未处理的日志；溢出排空后至少推进到该轮溢出的序号
+        std::lock_guard<std::mutex> lock(spillMutex_);
+        if (spillActive_.load(std::memory_order_relaxed)) {
+            sequence = std::min(sequence, spillFence_ << 1);
+        }
+        sequence = std::max(sequence, spillDoneSequence_);
+    }
+    if (sequence <= processedSequence_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    processedSequence_.store(sequence, std::memory_order_seq_cst);
+    // 与waitProcessed中先登记再检查序号配对，没有等待者时不加锁
+    if (sequenceWaiters_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(sequenceMutex_);
+        sequenceDone_.notify_all();
+    }
 }
 
 // 停止日志处理线程
 void AsyncLogQueue::stop() {
-    if (stopRequested_) {
+    // 设置停止标志（只有第一次调用继续执行）
+    if (stopRequested_.exchange(true)) {
         return;
     }
     
-    // 设置停止标志
-    stopRequested_ = true;
-    
-    // 通知所有等待的线程
-    notEmpty_.notify_all();
-    notFull_.notify_all();
+    // 通知所有等待的线程（在锁内通知：工作线程空闲时不限时休眠，不能错过这次通知）
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(sequenceMutex_);
+        sequenceDone_.notify_all();
+    }
     
     // 等待工作线程结束
     if (workerThread_.joinable()) {
         workerThread_.join();
     }
+    LogClock::removeConsumer();
 }
 
 // 获取队列当前大小
 size_t AsyncLogQueue::size() const {
+    if (engine_ == QueueEngine::lockFree) {
+        return ring_->size();
+    }
+    if (engine_ == QueueEngine::recordRing) {
+        return records_->size();
+    }
+    if (engine_ == QueueEngine::perThreadLanes) {
+        return laneQueueSize();
+    }
     std::lock_guard<std::mutex> lock(queueMutex_);
     return queue_.size();
 }
 
 // 判断队列是否已满
 bool AsyncLogQueue::isFull() const {
+    if (engine_ == QueueEngine::lockFree) {
+        return ring_->size() >= queueSize_;
+    }
+    if (engine_ == QueueEngine::recordRing) {
+        // 剩余空间放不下一条最大长度的记录即视为已满
+        size_t maxRecord = RecordRingBuffer::recordSize(
+            sizeof(QueuedRecordHeader) + LOG_FILE_BUFFER_SIZE + LOG_MESSAGE_BUFFER_SIZE);
+        return records_->bytesUsed() + maxRecord > records_->capacity();
+    }
+    if (engine_ == QueueEngine::perThreadLanes) {
+        // 各通道分别以laneSize为界，queueSize不约束本引擎：只看调用线程自己的通道（尚未注册时为空）
+        ProducerLane* lane = findProducerLane();
+        return lane && lane->ring.size() >= lane->ring.capacity();
+    }
     std::lock_guard<std::mutex> lock(queueMutex_);
     return queue_.size() >= queueSize_;
 }
@@ -240,6 +1658,11 @@ bool AsyncLogQueue::isStopped() const {
     return stopRequested_;
 }
 
+// 获取队列引擎类型
+QueueEngine AsyncLogQueue::engine() const {
+    return engine_;
+}
+
 // 获取当前统计信息
 AsyncLogQueue::Stats AsyncLogQueue::getStats() const {
     std::lock_guard<std::mutex> lock(statsMutex_);
@@ -253,6 +1676,41 @@ AsyncLogQueue::Stats AsyncLogQueue::getStats() const {
     result.peakPoolSize = peakPoolSize_.load();
     result.currentPoolSize = currentPoolSize_.load();
     result.tlsCacheHits = tlsCacheHits_.load();
+    result.expeditedEntries = expeditedEntries_.load(std::memory_order_relaxed);
+    result.expediteMisses = expediteMisses_.load(std::memory_order_relaxed);
+    
+    // 批次速率按构造或上次重置统计以来的平均值计算
+    result.batchLimit = batchLimit_.load(std::memory_order_relaxed);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - statsSince_).count();
+    result.batchesPerSecond = seconds > 0 ? result.batchOperations / seconds : 0;
+    
+    // 无锁引擎的入队数和队列大小直接由环形缓冲区的位置计数器推导
+    if (engine_ == QueueEngine::lockFree) {
+        result.totalEnqueued = ring_->totalPushed() - enqueueBase_;
+        result.currentQueueSize = ring_->size();
+    }
+    
+    // 通道引擎的入队数为所有通道（含已回收通道）的写入计数之和
+    if (engine_ == QueueEngine::perThreadLanes) {
+        std::lock_guard<std::mutex> lanesLock(lanesMutex_);
+        size_t pushed = retiredLaneEnqueued_;
+        size_t pending = 0;
+        for (const auto& lane : lanes_) {
+            pushed += lane->ring.totalPushed();
+            pending += lane->ring.size();
+        }
+        result.totalEnqueued = pushed - enqueueBase_;
+        result.currentQueueSize = pending;
+    }
+    
+    // 变长记录引擎按实际写入的字节统计，定长槽位引擎每条日志占用一个完整的LogEntry
+    if (engine_ == QueueEngine::recordRing) {
+        result.totalEnqueued = records_->totalCommitted() - enqueueBase_;
+        result.currentQueueSize = records_->size();
+        result.totalQueueBytes = records_->totalBytesReserved() - enqueueBytesBase_;
+    } else {
+        result.totalQueueBytes = result.totalEnqueued * sizeof(LogEntry);
+    }
     
     return result;
 }
@@ -264,8 +1722,36 @@ void AsyncLogQueue::resetStats() {
     // 重置队列统计信息
     stats_.totalEnqueued = 0;
     stats_.totalDropped = 0;
+    stats_.totalOverflows = 0;
+    std::fill(std::begin(stats_.droppedByLevel), std::end(stats_.droppedByLevel), 0);
+    stats_.spilledEntries = 0;
+    stats_.spilledBytes = 0;
+    stats_.totalSpillNanos = 0;
+    stats_.maxSpillNanos = 0;
+    stats_.drainedEntries = 0;
+    stats_.totalDrainNanos = 0;
+    expeditedEntries_ = 0;
+    expediteMisses_ = 0;
+    stats_.producerWakeups = 0;
+    stats_.consumerParks = 0;
+    stats_.batchOperations = 0;
+    statsSince_ = std::chrono::steady_clock::now();
     stats_.totalProcessed = 0;
     stats_.currentQueueSize = 0;
+    if (engine_ == QueueEngine::lockFree) {
+        enqueueBase_ = ring_->totalPushed();
+    }
+    if (engine_ == QueueEngine::recordRing) {
+        enqueueBase_ = records_->totalCommitted();
+        enqueueBytesBase_ = records_->totalBytesReserved();
+    }
+    if (engine_ == QueueEngine::perThreadLanes) {
+        std::lock_guard<std::mutex> lanesLock(lanesMutex_);
+        enqueueBase_ = retiredLaneEnqueued_;
+        for (const auto& lane : lanes_) {
+            enqueueBase_ += lane->ring.totalPushed();
+        }
+    }
     
     // 重置内存池统计信息（原子操作）
     totalAllocations_ = 0;
@@ -276,94 +1762,240 @@ void AsyncLogQueue::resetStats() {
 
 // 日志处理工作线程函数
 void AsyncLogQueue::workerThread() {
-    auto lastFlushTime = std::chrono::steady_clock::now();
+    auto lastRoundTime = std::chrono::steady_clock::now();
+    
+    // 每轮复用同一个预分配的批次缓冲区：处理完并归还条目后才取下一批
+    std::vector<LogEntry*>& batch = batchBuffer_;
     
     while (!stopRequested_) {
-        // 检查是否需要自动刷新
+        // 定期重新建立时钟计数与系统时间的对应关系，本轮取出的条目都按同一组参数换算
+        LogClock::refresh();
+        
         auto now = std::chrono::steady_clock::now();
-        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastFlushTime).count();
+        uint64_t cycleNanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now - lastRoundTime).count());
+        lastRoundTime = now;
         
         // 从队列中批量获取日志
-        std::vector<LogEntry> batch = dequeueBatch();
+        dequeueBatch(batch);
+        // 先输出优先级通道中的日志：取出常规批次之后再取，批次中带expedited标记的条目其副本一定已在其中
+        deliverPriority();
         
         if (!batch.empty() && logHandler_) {
             try {
-                // 处理日志批次
+                // 处理日志批次（只传递指针，不复制条目内容）
                 logHandler_(batch);
                 
-                // 更新统计信息
+                // 更新统计信息（先取队列大小，避免在持有statsMutex_时获取queueMutex_）
+                size_t pending = size();
+                uint64_t processNanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - now).count());
                 { 
                     std::lock_guard<std::mutex> statsLock(statsMutex_);
                     stats_.totalProcessed += batch.size();
-                    stats_.currentQueueSize = queue_.size();
+                    stats_.currentQueueSize = pending;
+                    stats_.batchOperations++;
+                    if (batchFromSpill_) {
+                        // 排空耗时含读回、解码与处理
+                        stats_.drainedEntries += batch.size();
+                        stats_.totalDrainNanos += processNanos;
+                    }
+                }
+                if (adaptiveBatching_.load(std::memory_order_acquire)) {
+                    adaptBatchLimit(batch.size(), processNanos, cycleNanos);
                 }
-                
-                // 更新最后刷新时间
-                lastFlushTime = now;
             } catch (const std::exception& e) {
                 std::cerr << "Error in log handler: " << e.what() << std::endl;
             }
-        } else if (elapsedMs >= flushIntervalMs_ && !queue_.empty()) {
-            // 自动刷新间隔到达且队列非空，强制处理剩余日志
-            batch = dequeueBatch();
-            if (!batch.empty() && logHandler_) {
-                try {
-                    logHandler_(batch);
-                    { 
-                        std::lock_guard<std::mutex> statsLock(statsMutex_);
-                        stats_.totalProcessed += batch.size();
-                        stats_.currentQueueSize = queue_.size();
-                    }
-                } catch (const std::exception& e) {
-                    std::cerr << "Error in log handler: " << e.what() << std::endl;
-                }
-            }
-            lastFlushTime = now;
         }
         
-        // 如果队列为空，等待新的日志或超时
-        if (queue_.empty() && !stopRequested_) {
-            std::unique_lock<std::mutex> lock(queueMutex_);
-            if (queue_.empty() && !stopRequested_) {
-                // 等待直到有新日志或超时（自动刷新间隔）
-                notEmpty_.wait_for(lock, std::chrono::milliseconds(flushIntervalMs_));
+        // 处理完成后将条目批量归还内存池（未设置处理回调时也要归还，避免内存池泄漏）
+        releaseBatch(batch);
+        
+        // 取出的批次都已处理完
+        publishProcessed(dequeuedSequence_);
+        resumeExpedite();
+        
+        // 如果队列为空，按等待策略等待新的日志
+        if (isQueueEmpty() && !stopRequested_) {
+            waitForEntries();
+        }
+    }
+    
+    // 处理剩余的日志（不再受自适应上限限制；通道引擎先等待在途的生产者，再不受水位线限制地排空各通道）
+    batchLimit_.store(maxBatchSize_, std::memory_order_relaxed);
+    if (engine_ == QueueEngine::perThreadLanes) {
+        fenceLaneProducers();
+    }
+    dequeueBatch(batch);
+    deliverPriority();
+    while (!batch.empty()) {
+        if (logHandler_) {
+            try {
+                logHandler_(batch);
+            } catch (const std::exception& e) {
+                std::cerr << "Error in log handler: " << e.what() << std::endl;
             }
         }
+        releaseBatch(batch);
+        publishProcessed(dequeuedSequence_);
+        resumeExpedite();
+        dequeueBatch(batch);
+        deliverPriority();
     }
+}
+
+// 自适应批量上限：一个延迟目标内到达的条目数决定跟上到达速率所需的批量，
+// 输出目标在延迟目标内能处理完的条目数决定批量的上界，结果限制在[minBatchSize, maxBatchSize]内
+void AsyncLogQueue::adaptBatchLimit(size_t batchSize, uint64_t processNanos, uint64_t cycleNanos) {
+    const double SMOOTHING = 0.125;  // 滑动平均中新样本的权重
+    double cost = static_cast<double>(processNanos) / batchSize;
+    double rate = cycleNanos > 0 ? static_cast<double>(batchSize) / cycleNanos : 0;
+    entryCostNanos_ = entryCostNanos_ > 0 ? entryCostNanos_ + SMOOTHING * (cost - entryCostNanos_) : cost;
+    arrivalPerNano_ += SMOOTHING * (rate - arrivalPerNano_);
     
-    // 处理剩余的日志
-    std::vector<LogEntry> remaining = dequeueBatch();
-    while (!remaining.empty() && logHandler_) {
-        try {
-            logHandler_(remaining);
-            remaining = dequeueBatch();
-        } catch (const std::exception& e) {
-            std::cerr << "Error in log handler: " << e.what() << std::endl;
-            break;
+    size_t limit = batchLimit_.load(std::memory_order_relaxed);
+    double latencyNanos = static_cast<double>(batchLatencyNanos_.load(std::memory_order_relaxed));
+    double target = arrivalPerNano_ * latencyNanos;
+    if (batchSize >= limit) {
+        // 本批已达上限，队列中仍有积压：成倍放大以摊薄每次回调的固定开销
+        target = std::max(target, limit * 2.0);
+    }
+    double chosen = std::min(target, latencyNanos / std::max(entryCostNanos_, 1.0));
+    
+    size_t lower = minBatchSize_.load(std::memory_order_relaxed);
+    size_t next = chosen <= lower ? lower : chosen >= maxBatchSize_ ? maxBatchSize_ : static_cast<size_t>(chosen);
+    batchLimit_.store(next, std::memory_order_relaxed);
+}
+
+// 从队列中批量获取日志：先取内存队列，内存队列取空后再按顺序读回溢出文件
+void AsyncLogQueue::dequeueBatch(std::vector<LogEntry*>& batch) {
+    batch.clear();
+    batchFromSpill_ = false;
+    if (!spillActive_.load(std::memory_order_acquire)) {
+        dequeueMemoryBatch(batch);
+        return;
+    }
+    
+    // 先取溢出文件此刻的写入位置再检查内存队列：此前写入溢出文件的日志，
+    // 其所属线程更早写入内存队列的日志此时一定可见，只读取该位置之前的记录就不会越过它们
+    uint64_t spillLimit = spill_->writePosition();
+    dequeueMemoryBatch(batch);
+    if (batch.empty() && isMemoryEmpty()) {
+        dequeueSpill(batch, spillLimit);
+    }
+}
+
+// 按顺序读回溢出文件中的日志
+void AsyncLogQueue::dequeueSpill(std::vector<LogEntry*>& batch, uint64_t limit) {
+    size_t count = 0;
+    size_t maxCount = batchLimit_.load(std::memory_order_relaxed);
+    size_t payloadLen = 0;
+    const char* payload = nullptr;
+    while (count < maxCount && spill_->readPosition() < limit &&
+           (payload = spill_->peek(payloadLen)) != nullptr) {
+        if (count == spillDecoded_.size()) {
+            spillDecoded_.emplace_back(new LogEntry());
         }
+        LogEntry* entry = spillDecoded_[count].get();
+        decodeQueuedRecord(payload, entry);
+        spill_->pop();
+        
+        batch.push_back(entry);
+        count++;
+    }
+    if (count > 0) {
+        batchFromSpill_ = true;
+        return;
+    }
+    
+    // 内存队列与溢出文件都已取空：结束本轮溢出，之后的日志回到内存队列
+    std::lock_guard<std::mutex> lock(spillMutex_);
+    if (spill_->empty()) {
+        spillActive_.store(false, std::memory_order_release);
+        spillDoneSequence_ = (spillFence_ << 1) | 1;
     }
 }
 
-// 从队列中批量获取日志
-std::vector<LogEntry> AsyncLogQueue::dequeueBatch() {
-    std::vector<LogEntry> batch;
+// 从内存队列中批量获取日志
+void AsyncLogQueue::dequeueMemoryBatch(std::vector<LogEntry*>& batch) {
     size_t count = 0;
+    size_t maxCount = batchLimit_.load(std::memory_order_relaxed);
+    
+    // 变长记录引擎：原地解析字节环中的记录，按实际长度解码到工作线程私有的条目中
+    if (engine_ == QueueEngine::recordRing) {
+        size_t payloadLen = 0;
+        const char* payload = nullptr;
+        while (count < maxCount && (payload = records_->peek(payloadLen)) != nullptr) {
+            QueuedRecordHeader header;
+            memcpy(&header, payload, sizeof(header));
+            if (header.flags & QUEUED_RECORD_BATCH) {
+                // 打包记录整体取出以保持批次连续，本批可能因此超过上限
+                const char* cursor = payload + sizeof(header);
+                for (uint32_t i = 0; i < header.messageLen; ++i) {
+                    uint32_t length = 0;
+                    memcpy(&length, cursor, sizeof(length));
+                    if (count == decoded_.size()) {
+                        decoded_.emplace_back(new LogEntry());
+                    }
+                    decodeQueuedRecord(cursor + sizeof(length), decoded_[count].get());
+                    cursor += sizeof(length) + length;
+                    
+                    batch.push_back(decoded_[count].get());
+                    count++;
+                }
+                records_->pop(header.messageLen);
+                continue;
+            }
+            
+            if (count == decoded_.size()) {
+                decoded_.emplace_back(new LogEntry());
+            }
+            
+            LogEntry* entry = decoded_[count].get();
+            decodeQueuedRecord(payload, entry);
+            records_->pop();
+            
+            batch.push_back(entry);
+            count++;
+        }
+        dequeuedSequence_ = records_->totalBytesPopped();
+        return;
+    }
+    
+    // 通道引擎：按时间戳合并各生产者通道
+    if (engine_ == QueueEngine::perThreadLanes) {
+        dequeueLanes(batch);
+        return;
+    }
+    
+    // 无锁引擎：消费者独占读取位置，直接按序号读取，无需加锁
+    if (engine_ == QueueEngine::lockFree) {
+        LogEntry* entry = nullptr;
+        while (count < maxCount && ring_->tryPop(entry)) {
+            batch.push_back(entry);
+            count++;
+        }
+        dequeuedSequence_ = ring_->totalPopped();
+        return;
+    }
     
     std::lock_guard<std::mutex> lock(queueMutex_);
     
     // 限制最大批量大小
-    while (!queue_.empty() && count < maxBatchSize_) {
-        batch.push_back(std::move(queue_.front()));
+    while (!queue_.empty() && count < maxCount) {
+        batch.push_back(queue_.front());
         queue_.pop();
         count++;
     }
+    queuedEntries_.store(queue_.size(), std::memory_order_relaxed);
+    // 按入队顺序取出，序号即已离开队列的条目数（含dropOldest策略在入队时丢弃的条目）
+    dequeuedSequence_ = enqueueSequence_ - queue_.size();
     
-    // 通知生产者队列不满
-    if (!queue_.empty() && queue_.size() < queueSize_) {
-        notFull_.notify_one();
+    // 取出了条目就有了空位，通知等待空位的生产者
+    if (count > 0) {
+        notFull_.notify_all();
     }
-    
-    return batch;
 }
 
 // 分配日志条目（优化版）
@@ -371,6 +2003,11 @@ LogEntry* AsyncLogQueue::allocateEntry() {
     // 增加总分配计数
     totalAllocations_++;
     
+    // 禁用内存池时直接从堆上分配
+    if (!useMemoryPool_) {
+        return new LogEntry();
+    }
+    
     // 首先尝试从线程本地缓存获取，避免加锁
     ThreadLocalCache& cache = getThreadLocalCache();
     if (!cache.entries.empty()) {
@@ -436,6 +2073,12 @@ void AsyncLogQueue::freeEntry(LogEntry* entry) {
     // 增加总释放计数
     totalDeallocations_++;
     
+    // 禁用内存池时直接释放
+    if (!useMemoryPool_) {
+        delete entry;
+        return;
+    }
+    
     // 首先尝试放入线程本地缓存
     ThreadLocalCache& cache = getThreadLocalCache();
     
@@ -462,6 +2105,14 @@ std::vector<LogEntry*> AsyncLogQueue::allocateBatch(size_t count) {
     // 增加总分配计数
     totalAllocations_ += count;
     
+    // 禁用内存池时直接从堆上分配
+    if (!useMemoryPool_) {
+        for (size_t i = 0; i < count; ++i) {
+            result.push_back(new LogEntry());
+        }
+        return result;
+    }
+    
     // 首先尝试从线程本地缓存获取
     ThreadLocalCache& cache = getThreadLocalCache();
     
@@ -531,6 +2182,14 @@ void AsyncLogQueue::freeBatch(const std::vector<LogEntry*>& entries) {
     // 增加总释放计数
     totalDeallocations_ += entries.size();
     
+    // 禁用内存池时直接释放
+    if (!useMemoryPool_) {
+        for (auto entry : entries) {
+            delete entry;
+        }
+        return;
+    }
+    
     // 首先尝试放入线程本地缓存
     ThreadLocalCache& cache = getThreadLocalCache();
     
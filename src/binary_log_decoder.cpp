@@ -0,0 +1,281 @@
+#include "binary_log_decoder.h"
+#include "binary_log_format.h"
+#include "log_args.h"
+#include <Windows.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const size_t READ_CHUNK_SIZE = 1024 * 1024;         // 每次读取的字节数
+const size_t MAX_RECORD_SIZE = 16 * 1024 * 1024;    // 单条记录的长度上限（超过视为格式错误）
+const size_t OUTPUT_FLUSH_SIZE = 256 * 1024;        // 解码结果累积到该长度后写出
+
+// 关闭时自动释放的文件句柄
+struct ScopedHandle {
+    HANDLE handle;
+    bool owned;
+
+    ScopedHandle(HANDLE h, bool own) : handle(h), owned(own) {}
+
+    ~ScopedHandle() {
+        if (owned && valid()) {
+            CloseHandle(handle);
+        }
+    }
+
+    bool valid() const {
+        return handle != INVALID_HANDLE_VALUE && handle != nullptr;
+    }
+};
+
+bool writeFull(HANDLE handle, const char* data, size_t len) {
+    while (len > 0) {
+        DWORD written = 0;
+        if (!WriteFile(handle, data, static_cast<DWORD>(len), &written, nullptr) || written == 0) {
+            return false;
+        }
+        data += written;
+        len -= written;
+    }
+    return true;
+}
+
+// 读取长度前缀的字符串
+bool readString(const char*& p, const char* end, const char*& str, size_t& len) {
+    uint64_t value;
+    if (!readVarint(p, end, value) || static_cast<uint64_t>(end - p) < value) {
+        return false;
+    }
+    str = p;
+    len = static_cast<size_t>(value);
+    p += len;
+    return true;
+}
+
+} // namespace
+
+BinaryLogDecoder::BinaryLogDecoder(TimestampPrecision precision, TimestampZone zone) :
+    formatter_(precision, zone),
+    headerRead_(false),
+    clockKnown_(false),
+    tickBase_(0),
+    epochBase_(0),
+    nanosPerTick_(1.0),
+    lastTimestamp_(0),
+    entries_(0) {
+}
+
+bool BinaryLogDecoder::decodeFile(const char* inputPath, const char* outputPath) {
+    ScopedHandle source(CreateFileA(inputPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr), true);
+    if (!source.valid()) {
+        error_ = std::string("cannot open ") + inputPath;
+        return false;
+    }
+    ScopedHandle target(outputPath ? CreateFileA(outputPath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                                 FILE_ATTRIBUTE_NORMAL, nullptr)
+                                   : GetStdHandle(STD_OUTPUT_HANDLE), outputPath != nullptr);
+    if (!target.valid()) {
+        error_ = std::string("cannot create ") + (outputPath ? outputPath : "stdout");
+        return false;
+    }
+
+    // 读缓冲区中[0, pending)为上一段剩下的不完整记录，新读入的数据接在后面
+    std::vector<char> buffer(READ_CHUNK_SIZE);
+    size_t pending = 0;
+    LogOutputBuffer out(OUTPUT_FLUSH_SIZE + 64 * 1024);
+    bool ok = true;
+    while (ok) {
+        if (buffer.size() - pending < READ_CHUNK_SIZE / 2) {
+            if (buffer.size() >= MAX_RECORD_SIZE) {
+                error_ = "record too large";
+                ok = false;
+                break;
+            }
+            buffer.resize(buffer.size() * 2);
+        }
+        DWORD read = 0;
+        if (!ReadFile(source.handle, buffer.data() + pending, static_cast<DWORD>(buffer.size() - pending), &read, nullptr)) {
+            error_ = "read failed";
+            ok = false;
+            break;
+        }
+        if (read == 0) {
+            if (pending > 0 && error_.empty()) {
+                // 写入中途退出时最后一条记录可能不完整，之前的日志仍然有效
+                error_ = "truncated record at end of file";
+                ok = false;
+            }
+            break;
+        }
+        size_t available = pending + read;
+        size_t used = decode(buffer.data(), available, out);
+        if (!error_.empty()) {
+            ok = false;
+        }
+        pending = available - used;
+        memmove(buffer.data(), buffer.data() + used, pending);
+
+        if (out.size() >= OUTPUT_FLUSH_SIZE) {
+            if (!writeFull(target.handle, out.data(), out.size())) {
+                error_ = "write failed";
+                return false;
+            }
+            out.clear();
+        }
+    }
+    if (!headerRead_ && error_.empty()) {
+        error_ = "not a binary log file";
+        ok = false;
+    }
+    if (out.size() > 0 && !writeFull(target.handle, out.data(), out.size())) {
+        error_ = "write failed";
+        return false;
+    }
+    return ok;
+}
+
+size_t BinaryLogDecoder::decode(const char* data, size_t len, LogOutputBuffer& out) {
+    const char* p = data;
+    const char* end = data + len;
+
+    if (!headerRead_) {
+        if (len < BINARY_LOG_HEADER_SIZE) {
+            return 0;
+        }
+        uint32_t version;
+        memcpy(&version, p + 8, sizeof(version));
+        if (memcmp(p, BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC)) != 0) {
+            error_ = "not a binary log file";
+            return 0;
+        }
+        if (version != BINARY_LOG_VERSION) {
+            error_ = "unsupported version " + std::to_string(version);
+            return 0;
+        }
+        headerRead_ = true;
+        p += BINARY_LOG_HEADER_SIZE;
+    }
+
+    while (p < end) {
+        const char* record = p;
+        int result = decodeRecord(p, end, out);
+        if (result <= 0) {
+            p = record;
+            break;
+        }
+    }
+    return static_cast<size_t>(p - data);
+}
+
+int BinaryLogDecoder::decodeRecord(const char*& p, const char* end, LogOutputBuffer& out) {
+    uint8_t tag = static_cast<uint8_t>(*p++);
+    BinaryRecordType type = static_cast<BinaryRecordType>(tag >> 4);
+    int levelValue = tag & 0x0F;
+
+    if (type == BinaryRecordType::clock) {
+        if (end - p < 24) {
+            return 0;
+        }
+        memcpy(&tickBase_, p, sizeof(tickBase_));
+        memcpy(&epochBase_, p + 8, sizeof(epochBase_));
+        memcpy(&nanosPerTick_, p + 16, sizeof(nanosPerTick_));
+        p += 24;
+        lastTimestamp_ = tickBase_;
+        clockKnown_ = true;
+        return 1;
+    }
+
+    if (type == BinaryRecordType::site) {
+        uint64_t id;
+        uint64_t line;
+        const char* format;
+        size_t formatLen;
+        const char* file;
+        size_t fileLen;
+        const char* types;
+        size_t typeCount;
+        if (!readVarint(p, end, id) || !readVarint(p, end, line) || !readString(p, end, format, formatLen) ||
+            !readString(p, end, file, fileLen) || !readString(p, end, types, typeCount)) {
+            return 0;
+        }
+        Site& site = sites_[static_cast<uint32_t>(id)];
+        site.format.assign(format, formatLen);
+        site.file.assign(file, fileLen);
+        site.line = static_cast<uint32_t>(line);
+        site.types.assign(types, typeCount);
+        return 1;
+    }
+
+    if (type != BinaryRecordType::entry && type != BinaryRecordType::text) {
+        error_ = "unknown record type " + std::to_string(tag >> 4);
+        return -1;
+    }
+    if (levelValue >= static_cast<int>(LogLevel::off)) {
+        error_ = "invalid log level " + std::to_string(levelValue);
+        return -1;
+    }
+    if (!clockKnown_) {
+        error_ = "log record before clock record";
+        return -1;
+    }
+    LogLevel level = static_cast<LogLevel>(levelValue);
+
+    uint64_t delta;
+    if (!readVarint(p, end, delta)) {
+        return 0;
+    }
+    uint64_t timestamp = lastTimestamp_ + static_cast<uint64_t>(zigzagDecode(delta));
+
+    const char* file = nullptr;
+    size_t fileLen = 0;
+    int line = 0;
+    char message[LOG_MESSAGE_BUFFER_SIZE];
+    const char* text;
+    size_t textLen;
+    if (type == BinaryRecordType::entry) {
+        uint64_t siteId;
+        if (!readVarint(p, end, siteId)) {
+            return 0;
+        }
+        auto it = sites_.find(static_cast<uint32_t>(siteId));
+        if (it == sites_.end()) {
+            error_ = "unknown site " + std::to_string(siteId);
+            return -1;
+        }
+        const Site& site = it->second;
+        char args[LOG_MESSAGE_BUFFER_SIZE * 2];
+        size_t argsLen = 0;
+        // 记录中没有长度前缀，参数值不完整时等待下一段数据（真正损坏的数据最终在文件末尾报错）
+        if (!unpackLogArgs(p, end, site.types.data(), site.types.size(), args, sizeof(args), argsLen)) {
+            return 0;
+        }
+        textLen = formatLogArgs(site.format.c_str(), args, argsLen, message, sizeof(message));
+        text = message;
+        file = site.file.data();
+        fileLen = site.file.size();
+        line = static_cast<int>(site.line);
+    } else {
+        uint64_t lineNo;
+        if (!readVarint(p, end, lineNo) || !readString(p, end, file, fileLen) || !readString(p, end, text, textLen)) {
+            return 0;
+        }
+        line = static_cast<int>(lineNo);
+    }
+
+    char timeStr[TIMESTAMP_BUFFER_SIZE];
+    size_t timeLen = formatTime(timestamp, timeStr);
+    out.appendLine(timeStr, timeLen, level, file, fileLen, line, text, textLen);
+    lastTimestamp_ = timestamp;
+    entries_++;
+    return 1;
+}
+
+size_t BinaryLogDecoder::formatTime(uint64_t ticks, char* out) {
+    // 与LogClock::toEpochNanos相同的换算，保证与文本输出的时间戳一致
+    int64_t delta = static_cast<int64_t>(ticks - tickBase_);
+    int64_t nanos = epochBase_ + static_cast<int64_t>(static_cast<double>(delta) * nanosPerTick_);
+    return formatter_.format(nanos, out);
+}
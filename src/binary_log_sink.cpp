@@ -0,0 +1,207 @@
+#include "binary_log_sink.h"
+#include <cstring>
+
+BinaryLogSink::BinaryLogSink(const char* path, LogLevel level, DurabilityPolicy durability,
+                             int syncIntervalMs, size_t syncIntervalBytes) :
+    LogSink(level),
+    nextDynamicSite_(BINARY_LOG_DYNAMIC_SITE_BASE),
+    lastTimestamp_(0),
+    clockWritten_(false) {
+    if (path && file_.open(path)) {
+        // 新文件写入文件头；追加到已有文件时，调用点表和时钟在本次会话中重新写入
+        if (file_.fileSize() == 0) {
+            char header[BINARY_LOG_HEADER_SIZE] = {};
+            uint32_t version = BINARY_LOG_VERSION;
+            memcpy(header, BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC));
+            memcpy(header + 8, &version, sizeof(version));
+            file_.append(header, sizeof(header));
+        }
+    }
+    file_.setDurability(durability, syncIntervalMs, syncIntervalBytes);
+}
+
+BinaryLogSink::~BinaryLogSink() {
+    file_.close();
+}
+
+bool BinaryLogSink::isOpen() const {
+    return file_.isOpen();
+}
+
+void BinaryLogSink::write(const LogBatch& batch) {
+    LogLevel level = getLevel();
+    if (!file_.isOpen() || batch.count == 0 || batch.maxLevel < level) {
+        return;
+    }
+
+    if (!clockWritten_) {
+        BinaryEntryHeader first;
+        memcpy(&first, batch.data + batch.lines[0].offset, sizeof(first));
+        writeClock(first.timestamp);
+    }
+
+    // 每条记录最长为标记字节、3个varint、文件名和两倍长度的参数
+    char record[32 + 2 * LOG_MESSAGE_BUFFER_SIZE + LOG_FILE_BUFFER_SIZE];
+    for (size_t i = 0; i < batch.count; ++i) {
+        const LogLine& line = batch.lines[i];
+        if (line.level < level) {
+            continue;
+        }
+        BinaryEntryHeader header;
+        memcpy(&header, batch.data + line.offset, sizeof(header));
+        const char* message = batch.data + line.offset + sizeof(header);
+        const char* file = message + header.messageLen;
+
+        // 时间戳按与上一条记录的差值写入，同一批内通常只有1~3个字节
+        int64_t delta = static_cast<int64_t>(header.timestamp - lastTimestamp_);
+        lastTimestamp_ = header.timestamp;
+
+        size_t n = 0;
+        if (header.format) {
+            // 参数类型随调用点表项写入，记录中只有参数值
+            char types[LOG_MESSAGE_BUFFER_SIZE / 2];
+            size_t typeCount;
+            record[n++] = static_cast<char>((static_cast<uint8_t>(BinaryRecordType::entry) << 4) |
+                                            static_cast<uint8_t>(line.level));
+            n += writeVarint(record + n, zigzagEncode(delta));
+            char* idPos = record + n;
+            // 调用点ID最多5字节，参数值先写在其后，取得参数类型并确定ID后再移到ID之后
+            size_t packedLen = packLogArgs(message, header.messageLen, idPos + 5, types, typeCount);
+            uint32_t siteId = resolveSite(header, file, types, typeCount);
+            size_t idLen = writeVarint(idPos, siteId);
+            memmove(idPos + idLen, idPos + 5, packedLen);
+            n += idLen + packedLen;
+        } else {
+            // 已格式化的消息：文件名和行号随记录写入（登记的调用点从登记表中取得）
+            const char* fileName = file;
+            size_t fileLen = header.fileLen;
+            uint32_t lineNo = header.line;
+            const LogSite* site = header.siteId ? LogSiteRegistry::find(header.siteId) : nullptr;
+            if (site) {
+                fileName = site->file;
+                fileLen = strlen(site->file);
+                lineNo = site->line > 0 ? static_cast<uint32_t>(site->line) : 0;
+            }
+            if (fileLen > LOG_FILE_BUFFER_SIZE) {
+                fileLen = LOG_FILE_BUFFER_SIZE;
+            }
+            record[n++] = static_cast<char>((static_cast<uint8_t>(BinaryRecordType::text) << 4) |
+                                            static_cast<uint8_t>(line.level));
+            n += writeVarint(record + n, zigzagEncode(delta));
+            n += writeVarint(record + n, lineNo);
+            n += writeVarint(record + n, fileLen);
+            memcpy(record + n, fileName, fileLen);
+            n += fileLen;
+            n += writeVarint(record + n, header.messageLen);
+            memcpy(record + n, message, header.messageLen);
+            n += header.messageLen;
+        }
+        out_.append(record, n);
+    }
+
+    file_.append(out_.data(), out_.size());
+    out_.clear();
+    file_.endBatch(batch.maxLevel >= LogLevel::error);
+}
+
+void BinaryLogSink::flush() {
+    file_.flush();
+}
+
+bool BinaryLogSink::sync() {
+    return file_.sync();
+}
+
+void BinaryLogSink::writeClock(uint64_t base) {
+    // 时间戳已是自1970年起的纳秒数：基准点取本次会话的第一条时间戳，使增量保持较小
+    uint64_t tickBase = base;
+    int64_t epochBase = static_cast<int64_t>(base);
+    double nanosPerTick = 1.0;
+    clockWritten_ = true;
+
+    char record[1 + 8 + 8 + 8];
+    record[0] = static_cast<char>(static_cast<uint8_t>(BinaryRecordType::clock) << 4);
+    memcpy(record + 1, &tickBase, sizeof(tickBase));
+    memcpy(record + 9, &epochBase, sizeof(epochBase));
+    memcpy(record + 17, &nanosPerTick, sizeof(nanosPerTick));
+    out_.append(record, sizeof(record));
+    lastTimestamp_ = tickBase;
+}
+
+void BinaryLogSink::writeSite(const SiteState& site) {
+    char prefix[1 + 10 + 10 + 10];
+    size_t n = 0;
+    size_t formatLen = strlen(site.format);
+    prefix[n++] = static_cast<char>(static_cast<uint8_t>(BinaryRecordType::site) << 4);
+    n += writeVarint(prefix + n, site.id);
+    n += writeVarint(prefix + n, site.line);
+    n += writeVarint(prefix + n, formatLen);
+    out_.append(prefix, n);
+    out_.append(site.format, formatLen);
+    n = writeVarint(prefix, site.file.size());
+    out_.append(prefix, n);
+    out_.append(site.file.data(), site.file.size());
+    n = writeVarint(prefix, site.types.size());
+    out_.append(prefix, n);
+    out_.append(site.types.data(), site.types.size());
+}
+
+uint32_t BinaryLogSink::resolveSite(const BinaryEntryHeader& header, const char* file,
+                                    const char* types, size_t typeCount) {
+    // 查找已写入的表项：登记的调用点按ID，未登记的格式字符串按指针（字符串字面量的地址在进程内不变）
+    const LogSite* registered = nullptr;
+    size_t slot = 0;
+    bool found = false;
+    if (header.siteId != 0) {
+        if (header.siteId < siteSlots_.size() && siteSlots_[header.siteId] != 0) {
+            slot = siteSlots_[header.siteId] - 1;
+            found = true;
+        } else {
+            registered = LogSiteRegistry::find(header.siteId);
+        }
+    }
+    if (!found && !registered) {
+        auto it = dynamicSites_.find(header.format);
+        if (it != dynamicSites_.end()) {
+            slot = it->second;
+            found = true;
+        }
+    }
+
+    if (found) {
+        SiteState& site = sites_[slot];
+        // 同一调用点的参数类型变化时（同一格式字符串用于不同的参数类型）重新写入表项
+        if (site.types.size() != typeCount || memcmp(site.types.data(), types, typeCount) != 0) {
+            site.types.assign(types, typeCount);
+            writeSite(site);
+        }
+        return site.id;
+    }
+
+    // 首次出现：登记的调用点从登记表取得文件名和行号，未登记的分配动态ID，文件名和行号取首次出现时的值
+    SiteState site;
+    if (registered) {
+        site.id = registered->id;
+        site.format = registered->format;
+        site.file = registered->file;
+        site.line = registered->line > 0 ? static_cast<uint32_t>(registered->line) : 0;
+    } else {
+        site.id = nextDynamicSite_++;
+        site.format = header.format;
+        site.file.assign(file, header.fileLen);
+        site.line = header.line;
+    }
+    site.types.assign(types, typeCount);
+    slot = sites_.size();
+    sites_.push_back(site);
+    if (registered) {
+        if (siteSlots_.size() <= registered->id) {
+            siteSlots_.resize(registered->id + 1, 0);
+        }
+        siteSlots_[registered->id] = static_cast<uint32_t>(slot + 1);
+    } else {
+        dynamicSites_.emplace(header.format, static_cast<uint32_t>(slot));
+    }
+    writeSite(sites_[slot]);
+    return site.id;
+}
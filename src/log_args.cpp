@@ -0,0 +1,342 @@
+#include "log_args.h"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <string>
+
+namespace {
+
+// 解码后的单个参数
+struct DecodedArg {
+    LogArgType type;
+    int64_t i;
+    uint64_t u;
+    double d;
+    const char* str;
+    size_t strLen;
+};
+
+// 依次读取编码缓冲区中的参数
+class LogArgReader {
+public:
+    LogArgReader(const char* data, size_t len) : data_(data), len_(len), pos_(0) {}
+
+    bool next(DecodedArg& arg) {
+        if (pos_ >= len_) {
+            return false;
+        }
+        arg.type = static_cast<LogArgType>(data_[pos_]);
+        arg.i = 0;
+        arg.u = 0;
+        arg.d = 0.0;
+        arg.str = nullptr;
+        arg.strLen = 0;
+        pos_++;
+
+        switch (arg.type) {
+            case LogArgType::signedInt:
+                if (!read(&arg.i, sizeof(arg.i))) return false;
+                arg.u = static_cast<uint64_t>(arg.i);
+                arg.d = static_cast<double>(arg.i);
+                return true;
+            case LogArgType::unsignedInt:
+            case LogArgType::pointer:
+                if (!read(&arg.u, sizeof(arg.u))) return false;
+                arg.i = static_cast<int64_t>(arg.u);
+                arg.d = static_cast<double>(arg.u);
+                return true;
+            case LogArgType::floating:
+                if (!read(&arg.d, sizeof(arg.d))) return false;
+                arg.i = static_cast<int64_t>(arg.d);
+                arg.u = static_cast<uint64_t>(arg.i);
+                return true;
+            case LogArgType::character: {
+                char c = 0;
+                if (!read(&c, sizeof(c))) return false;
+                arg.i = static_cast<unsigned char>(c);
+                arg.u = static_cast<uint64_t>(arg.i);
+                arg.d = static_cast<double>(arg.i);
+                return true;
+            }
+            case LogArgType::string: {
+                uint16_t len16 = 0;
+                if (!read(&len16, sizeof(len16))) return false;
+                if (pos_ + len16 > len_) {
+                    pos_ = len_;
+                    return false;
+                }
+                arg.str = data_ + pos_;
+                arg.strLen = len16;
+                pos_ += len16;
+                return true;
+            }
+            default:
+                // 无法识别的类型标记，停止解码
+                pos_ = len_;
+                return false;
+        }
+    }
+
+private:
+    bool read(void* out, size_t n) {
+        if (pos_ + n > len_) {
+            pos_ = len_;
+            return false;
+        }
+        memcpy(out, data_ + pos_, n);
+        pos_ += n;
+        return true;
+    }
+
+    const char* data_;
+    size_t len_;
+    size_t pos_;
+};
+
+// 有界输出缓冲区
+class FormatOutput {
+public:
+    FormatOutput(char* out, size_t capacity) : out_(out), capacity_(capacity), size_(0) {}
+
+    void append(const char* data, size_t len) {
+        if (capacity_ == 0) {
+            return;
+        }
+        size_t room = capacity_ - 1 - size_;
+        size_t n = std::min(len, room);
+        memcpy(out_ + size_, data, n);
+        size_ += n;
+    }
+
+    // 使用单个转换说明调用snprintf，结果追加到输出
+    template <typename T>
+    void appendFormatted(const char* spec, T value) {
+        char buffer[128];
+        int written = snprintf(buffer, sizeof(buffer), spec, value);
+        if (written <= 0) {
+            return;
+        }
+        if (static_cast<size_t>(written) < sizeof(buffer)) {
+            append(buffer, static_cast<size_t>(written));
+        } else {
+            // 宽度超出栈缓冲区时才使用堆内存（仅在工作线程中发生）
+            std::string large(static_cast<size_t>(written) + 1, '\0');
+            snprintf(&large[0], large.size(), spec, value);
+            append(large.data(), static_cast<size_t>(written));
+        }
+    }
+
+    size_t finish() {
+        if (capacity_ > 0) {
+            out_[size_] = '\0';
+        }
+        return size_;
+    }
+
+private:
+    char* out_;
+    size_t capacity_;
+    size_t size_;
+};
+
+// 按参数的实际类型输出（转换说明与参数类型不一致时使用）
+void appendNatural(FormatOutput& output, const DecodedArg& arg) {
+    switch (arg.type) {
+        case LogArgType::signedInt:
+            output.appendFormatted("%lld", static_cast<long long>(arg.i));
+            break;
+        case LogArgType::unsignedInt:
+            output.appendFormatted("%llu", static_cast<unsigned long long>(arg.u));
+            break;
+        case LogArgType::floating:
+            output.appendFormatted("%g", arg.d);
+            break;
+        case LogArgType::character: {
+            char c = static_cast<char>(arg.i);
+            output.append(&c, 1);
+            break;
+        }
+        case LogArgType::string:
+            output.append(arg.str, arg.strLen);
+            break;
+        case LogArgType::pointer:
+            output.appendFormatted("%p", reinterpret_cast<void*>(static_cast<uintptr_t>(arg.u)));
+            break;
+    }
+}
+
+// '*'宽度或精度：从参数中读取一个整数写入转换说明（与printf相同，负的宽度表示左对齐，负的精度表示省略精度）。
+// 超出输出缓冲区的宽度没有意义，绝对值限制为5位，保证转换说明不溢出
+void appendStarValue(LogArgReader& reader, char* spec, size_t& specLen, bool precision) {
+    DecodedArg arg;
+    if (!reader.next(arg)) {
+        // 参数不足：之后读取转换的参数同样会失败，转换说明原样输出
+        return;
+    }
+    long long value = std::max(-99999LL, std::min(99999LL, static_cast<long long>(arg.i)));
+    if (precision && value < 0) {
+        specLen--;  // 去掉'.'
+        return;
+    }
+    specLen += static_cast<size_t>(snprintf(spec + specLen, 8, "%lld", value));
+}
+
+} // namespace
+
+// 按printf风格的格式字符串解码参数并格式化
+size_t formatLogArgs(const char* format, const char* args, size_t argsLen, char* out, size_t outCapacity) {
+    FormatOutput output(out, outCapacity);
+    LogArgReader reader(args, argsLen);
+    if (!format) {
+        return output.finish();
+    }
+
+    const char* p = format;
+    while (*p) {
+        // 复制普通字符直到下一个'%'
+        const char* percent = strchr(p, '%');
+        if (!percent) {
+            output.append(p, strlen(p));
+            break;
+        }
+        output.append(p, percent - p);
+        p = percent + 1;
+
+        if (*p == '%') {
+            output.append("%", 1);
+            p++;
+            continue;
+        }
+
+        // 解析转换说明：标志、宽度、精度（长度修饰符会被忽略，由参数的实际类型决定）。
+        // 宽度与精度为'*'时依次从参数中读取，位于转换的参数之前
+        char spec[48];
+        size_t specLen = 0;
+        spec[specLen++] = '%';
+        const char* specStart = percent;
+        while (*p && strchr("-+ #0", *p) && specLen < 16) {
+            spec[specLen++] = *p++;
+        }
+        if (*p == '*') {
+            p++;
+            appendStarValue(reader, spec, specLen, false);
+        } else {
+            while (isdigit(static_cast<unsigned char>(*p)) && specLen < 24) {
+                spec[specLen++] = *p++;
+            }
+        }
+        if (*p == '.') {
+            spec[specLen++] = *p++;
+            if (*p == '*') {
+                p++;
+                appendStarValue(reader, spec, specLen, true);
+            } else {
+                while (isdigit(static_cast<unsigned char>(*p)) && specLen < 40) {
+                    spec[specLen++] = *p++;
+                }
+            }
+        }
+        while (*p && strchr("hljztLIq", *p)) {
+            // Windows风格的I64/I32修饰符
+            if (*p == 'I' && (p[1] == '6' || p[1] == '3')) {
+                p += 3;
+            } else {
+                p++;
+            }
+        }
+        char conversion = *p;
+        if (!conversion) {
+            output.append(specStart, p - specStart);
+            break;
+        }
+        p++;
+
+        DecodedArg arg;
+        if (conversion == 'n' || !reader.next(arg)) {
+            // 参数不足或不安全的%n，原样输出转换说明
+            output.append(specStart, p - specStart);
+            continue;
+        }
+
+        switch (conversion) {
+            case 'd':
+            case 'i':
+                if (arg.type == LogArgType::string || arg.type == LogArgType::floating) {
+                    appendNatural(output, arg);
+                } else {
+                    memcpy(spec + specLen, "lld", 4);
+                    output.appendFormatted(spec, static_cast<long long>(arg.i));
+                }
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                if (arg.type == LogArgType::string || arg.type == LogArgType::floating) {
+                    appendNatural(output, arg);
+                } else {
+                    spec[specLen] = 'l';
+                    spec[specLen + 1] = 'l';
+                    spec[specLen + 2] = conversion;
+                    spec[specLen + 3] = '\0';
+                    output.appendFormatted(spec, static_cast<unsigned long long>(arg.u));
+                }
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (arg.type == LogArgType::string) {
+                    appendNatural(output, arg);
+                } else {
+                    spec[specLen] = conversion;
+                    spec[specLen + 1] = '\0';
+                    output.appendFormatted(spec, arg.d);
+                }
+                break;
+            case 'c':
+                if (arg.type == LogArgType::string) {
+                    appendNatural(output, arg);
+                } else {
+                    spec[specLen] = 'c';
+                    spec[specLen + 1] = '\0';
+                    output.appendFormatted(spec, static_cast<int>(arg.i));
+                }
+                break;
+            case 's':
+                if (arg.type == LogArgType::string) {
+                    // 字符串已按长度编码，带宽度或精度时交给snprintf处理对齐与截断
+                    if (specLen == 1) {
+                        output.append(arg.str, arg.strLen);
+                    } else {
+                        std::string str(arg.str, arg.strLen);
+                        spec[specLen] = 's';
+                        spec[specLen + 1] = '\0';
+                        int needed = snprintf(nullptr, 0, spec, str.c_str());
+                        if (needed > 0) {
+                            std::string formatted(static_cast<size_t>(needed) + 1, '\0');
+                            snprintf(&formatted[0], formatted.size(), spec, str.c_str());
+                            output.append(formatted.data(), static_cast<size_t>(needed));
+                        }
+                    }
+                } else {
+                    appendNatural(output, arg);
+                }
+                break;
+            case 'p':
+                output.appendFormatted("%p", reinterpret_cast<void*>(static_cast<uintptr_t>(arg.u)));
+                break;
+            default:
+                // 无法识别的转换字符，原样输出转换说明
+                output.append(specStart, p - specStart);
+                break;
+        }
+    }
+
+    return output.finish();
+}
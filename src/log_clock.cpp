@@ -0,0 +1,214 @@
+#include "log_clock.h"
+#include <Windows.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define WINLOG_HAS_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace {
+
+// 原始计数与系统时间的对应关系：epochNanos = epochBase + (ticks - tickBase) * nanosPerTick
+struct ClockMapping {
+    uint64_t tickBase;
+    int64_t epochBase;
+    double nanosPerTick;
+};
+
+const uint64_t REFRESH_INTERVAL_NANOS = 1000000000;    // 工作线程重新建立对应关系的间隔（1秒）
+
+std::atomic<int> currentSource(static_cast<int>(LogClockSource::steady));
+std::mutex clockMutex;          // 串行化时钟源切换、重新校准与队列登记
+int activeConsumers = 0;        // 正在运行的异步队列数（受clockMutex保护）
+double tscNanosPerTick = 0.0;   // TSC校准结果（0表示尚未校准）
+uint64_t tscBaseSteady = 0;     // TSC校准起点，之后每次重新校准都从这里量起，基线越长结果越准
+uint64_t tscBaseTicks = 0;
+std::atomic<uint64_t> nextRefresh(0);   // 下次重新建立对应关系的steady_clock时刻
+
+// 换算参数以顺序锁发布：写者（持有clockMutex）先将序号置为奇数再写入各字段，
+// 读者只采用前后两次读到相同偶数序号时的值，读取时不加锁
+std::atomic<uint32_t> mappingSequence(0);
+std::atomic<uint64_t> mappingTickBase(0);
+std::atomic<int64_t> mappingEpochBase(0);
+std::atomic<double> mappingNanosPerTick(1.0);
+
+ClockMapping loadMapping() {
+    ClockMapping mapping;
+    for (;;) {
+        uint32_t sequence = mappingSequence.load(std::memory_order_acquire);
+        mapping.tickBase = mappingTickBase.load(std::memory_order_relaxed);
+        mapping.epochBase = mappingEpochBase.load(std::memory_order_relaxed);
+        mapping.nanosPerTick = mappingNanosPerTick.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((sequence & 1) == 0 && mappingSequence.load(std::memory_order_relaxed) == sequence) {
+            return mapping;
+        }
+    }
+}
+
+// 调用者持有clockMutex
+void storeMapping(const ClockMapping& mapping) {
+    uint32_t sequence = mappingSequence.load(std::memory_order_relaxed);
+    mappingSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    mappingTickBase.store(mapping.tickBase, std::memory_order_relaxed);
+    mappingEpochBase.store(mapping.epochBase, std::memory_order_relaxed);
+    mappingNanosPerTick.store(mapping.nanosPerTick, std::memory_order_relaxed);
+    mappingSequence.store(sequence + 2, std::memory_order_release);
+}
+
+inline uint64_t steadyTicks() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline int64_t systemNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+inline uint64_t readTicks(LogClockSource source) {
+    switch (source) {
+#ifdef WINLOG_HAS_TSC
+        case LogClockSource::tsc:
+            return __rdtsc();
+#endif
+        case LogClockSource::coarse:
+            return GetTickCount64();
+        default:
+            return steadyTicks();
+    }
+}
+
+// 以steady_clock为基准初次测量TSC频率（约20毫秒，每个进程只做一次，之后由refresh在更长的基线上修正）
+double calibrateTsc() {
+#ifdef WINLOG_HAS_TSC
+    tscBaseSteady = steadyTicks();
+    tscBaseTicks = __rdtsc();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    uint64_t steadyEnd = steadyTicks();
+    uint64_t tscEnd = __rdtsc();
+    if (tscEnd > tscBaseTicks && steadyEnd > tscBaseSteady) {
+        return static_cast<double>(steadyEnd - tscBaseSteady) / static_cast<double>(tscEnd - tscBaseTicks);
+    }
+#endif
+    return 0.0;
+}
+
+// 相邻读取两个时钟建立对应关系（调用者持有clockMutex）
+void anchorMapping(LogClockSource source, double nanosPerTick) {
+    ClockMapping mapping;
+    mapping.tickBase = readTicks(source);
+    mapping.epochBase = systemNanos();
+    mapping.nanosPerTick = nanosPerTick;
+    storeMapping(mapping);
+    nextRefresh.store(steadyTicks() + REFRESH_INTERVAL_NANOS, std::memory_order_relaxed);
+}
+
+// 默认时钟源（steady）的对应关系在模块加载时建立
+struct DefaultMappingInit {
+    DefaultMappingInit() {
+        std::lock_guard<std::mutex> lock(clockMutex);
+        anchorMapping(LogClockSource::steady, 1.0);
+    }
+} defaultMappingInit;
+
+} // namespace
+
+uint64_t LogClock::now() {
+    return readTicks(static_cast<LogClockSource>(currentSource.load(std::memory_order_relaxed)));
+}
+
+bool LogClock::setSource(LogClockSource source) {
+    std::lock_guard<std::mutex> lock(clockMutex);
+    if (activeConsumers > 0) {
+        // 队列中的计数都按当前时钟源取得，切换后无法再换算，也会打乱按计数排序的通道引擎
+        return false;
+    }
+
+    double nanosPerTick = 1.0;
+    if (source == LogClockSource::tsc) {
+        if (tscNanosPerTick == 0.0) {
+            tscNanosPerTick = calibrateTsc();
+        }
+        if (tscNanosPerTick == 0.0) {
+            // 平台不支持TSC或校准失败，退化为steady_clock
+            source = LogClockSource::steady;
+        } else {
+            nanosPerTick = tscNanosPerTick;
+        }
+    } else if (source == LogClockSource::coarse) {
+        nanosPerTick = 1000000.0;
+    }
+
+    anchorMapping(source, nanosPerTick);
+    currentSource.store(static_cast<int>(source), std::memory_order_release);
+    return true;
+}
+
+LogClockSource LogClock::getSource() {
+    return static_cast<LogClockSource>(currentSource.load(std::memory_order_acquire));
+}
+
+void LogClock::refresh() {
+    if (steadyTicks() < nextRefresh.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // 其他队列的工作线程正在重新校准时直接返回
+    std::unique_lock<std::mutex> lock(clockMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+
+    LogClockSource source = static_cast<LogClockSource>(currentSource.load(std::memory_order_relaxed));
+    double nanosPerTick = loadMapping().nanosPerTick;
+#ifdef WINLOG_HAS_TSC
+    if (source == LogClockSource::tsc) {
+        // 从首次校准的起点量到此刻，修正最初20毫秒采样的误差
+        uint64_t steadyNow = steadyTicks();
+        uint64_t tscNow = __rdtsc();
+        if (tscNow > tscBaseTicks && steadyNow > tscBaseSteady) {
+            tscNanosPerTick = static_cast<double>(steadyNow - tscBaseSteady) / static_cast<double>(tscNow - tscBaseTicks);
+            nanosPerTick = tscNanosPerTick;
+        }
+    }
+#endif
+    // 重新取系统时间作为基准点，跟上系统时间的调整和长时间运行积累的频率误差
+    anchorMapping(source, nanosPerTick);
+}
+
+void LogClock::addConsumer() {
+    std::lock_guard<std::mutex> lock(clockMutex);
+    activeConsumers++;
+}
+
+void LogClock::removeConsumer() {
+    std::lock_guard<std::mutex> lock(clockMutex);
+    activeConsumers--;
+}
+
+int64_t LogClock::toEpochNanos(uint64_t ticks) {
+    ClockMapping mapping = loadMapping();
+    // 差值按有符号数计算，允许早于基准点的计数
+    int64_t delta = static_cast<int64_t>(ticks - mapping.tickBase);
+    return mapping.epochBase + static_cast<int64_t>(static_cast<double>(delta) * mapping.nanosPerTick);
+}
+
+double LogClock::nanosPerTick() {
+    return loadMapping().nanosPerTick;
+}
+
+void LogClock::getMapping(uint64_t* tickBase, int64_t* epochBase, double* nanosPerTick) {
+    ClockMapping mapping = loadMapping();
+    *tickBase = mapping.tickBase;
+    *epochBase = mapping.epochBase;
+    *nanosPerTick = mapping.nanosPerTick;
+}
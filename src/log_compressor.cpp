@@ -0,0 +1,347 @@
+#include "log_compressor.h"
+#include <Windows.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const size_t MIN_MATCH = 4;                 // 最短匹配长度
+const size_t LAST_LITERALS = 5;             // 块末尾必须以字面量结束的字节数
+const size_t MATCH_SEARCH_LIMIT = 12;       // 距块末尾不足该长度时不再查找匹配
+const size_t MAX_OFFSET = 65535;            // 匹配窗口
+const int HASH_LOG = 14;
+const size_t FILE_BLOCK_SIZE = 256 * 1024;  // 文件压缩的分块大小
+const uint32_t STORED_FLAG = 0x80000000u;   // 块按原样存储
+const char FILE_MAGIC[4] = {'W', 'L', 'Z', '1'};
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t hash32(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_LOG);
+}
+
+// 写入扩展长度：每个255字节表示再加255，最后一个字节小于255
+inline bool writeLength(uint8_t*& op, const uint8_t* outEnd, size_t length) {
+    while (length >= 255) {
+        if (op >= outEnd) {
+            return false;
+        }
+        *op++ = 255;
+        length -= 255;
+    }
+    if (op >= outEnd) {
+        return false;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return true;
+}
+
+inline bool readLength(const uint8_t*& ip, const uint8_t* inEnd, size_t& length) {
+    uint8_t b;
+    do {
+        if (ip >= inEnd) {
+            return false;
+        }
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+// 输出一个序列：标记字节、字面量及（matchLen不为0时）匹配偏移与长度
+bool emitSequence(uint8_t*& op, const uint8_t* outEnd, const uint8_t* literals, size_t literalLen,
+                  size_t offset, size_t matchLen) {
+    if (op >= outEnd) {
+        return false;
+    }
+    uint8_t* token = op++;
+    size_t matchCode = matchLen > 0 ? matchLen - MIN_MATCH : 0;
+    *token = static_cast<uint8_t>(((literalLen >= 15 ? 15 : literalLen) << 4) | (matchCode >= 15 ? 15 : matchCode));
+    if (literalLen >= 15 && !writeLength(op, outEnd, literalLen - 15)) {
+        return false;
+    }
+    if (static_cast<size_t>(outEnd - op) < literalLen) {
+        return false;
+    }
+    memcpy(op, literals, literalLen);
+    op += literalLen;
+    if (matchLen == 0) {
+        return true;
+    }
+    if (outEnd - op < 2) {
+        return false;
+    }
+    *op++ = static_cast<uint8_t>(offset & 0xFF);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    if (matchCode >= 15 && !writeLength(op, outEnd, matchCode - 15)) {
+        return false;
+    }
+    return true;
+}
+
+// 读满len字节（遇到文件末尾时读到多少算多少）
+bool readFull(HANDLE handle, char* data, size_t len, size_t& got) {
+    got = 0;
+    while (got < len) {
+        DWORD read = 0;
+        if (!ReadFile(handle, data + got, static_cast<DWORD>(len - got), &read, nullptr)) {
+            return false;
+        }
+        if (read == 0) {
+            break;
+        }
+        got += read;
+    }
+    return true;
+}
+
+bool writeFull(HANDLE handle, const char* data, size_t len) {
+    while (len > 0) {
+        DWORD written = 0;
+        if (!WriteFile(handle, data, static_cast<DWORD>(len), &written, nullptr) || written == 0) {
+            return false;
+        }
+        data += written;
+        len -= written;
+    }
+    return true;
+}
+
+inline void put32(char* p, uint32_t value) {
+    memcpy(p, &value, sizeof(value));
+}
+
+inline uint32_t get32(const char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// 文件句柄的自动关闭
+struct ScopedHandle {
+    HANDLE handle;
+    explicit ScopedHandle(HANDLE h) : handle(h) {}
+    ~ScopedHandle() {
+        if (handle != INVALID_HANDLE_VALUE) {
+            CloseHandle(handle);
+        }
+    }
+    bool valid() const {
+        return handle != INVALID_HANDLE_VALUE;
+    }
+};
+
+} // namespace
+
+size_t logCompressBound(size_t inputLen) {
+    return inputLen + inputLen / 255 + 16;
+}
+
+size_t logCompressBlock(const char* input, size_t inputLen, char* output, size_t outputCapacity) {
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(input);
+    uint8_t* op = reinterpret_cast<uint8_t*>(output);
+    const uint8_t* outEnd = op + outputCapacity;
+
+    size_t anchor = 0;
+    if (inputLen > MATCH_SEARCH_LIMIT) {
+        // 哈希表记录每个4字节序列最近出现的位置（加1，0表示空）
+        std::vector<uint32_t> table(static_cast<size_t>(1) << HASH_LOG, 0);
+        const size_t searchEnd = inputLen - MATCH_SEARCH_LIMIT;
+        const size_t matchEnd = inputLen - LAST_LITERALS;
+        size_t ip = 0;
+        while (ip < searchEnd) {
+            uint32_t sequence = read32(in + ip);
+            uint32_t& slot = table[hash32(sequence)];
+            size_t ref = slot;
+            slot = static_cast<uint32_t>(ip + 1);
+            if (ref == 0 || ip - (ref - 1) > MAX_OFFSET || read32(in + ref - 1) != sequence) {
+                ip++;
+                continue;
+            }
+            ref -= 1;
+
+            size_t matchLen = MIN_MATCH;
+            while (ip + matchLen < matchEnd && in[ref + matchLen] == in[ip + matchLen]) {
+                matchLen++;
+            }
+            if (!emitSequence(op, outEnd, in + anchor, ip - anchor, ip - ref, matchLen)) {
+                return 0;
+            }
+            // 匹配区间内的位置也登记到哈希表（只登记末尾附近，兼顾速度）
+            size_t next = ip + matchLen;
+            if (next - 2 < searchEnd) {
+                table[hash32(read32(in + next - 2))] = static_cast<uint32_t>(next - 2 + 1);
+            }
+            ip = next;
+            anchor = ip;
+        }
+    }
+
+    // 最后的字面量
+    if (!emitSequence(op, outEnd, in + anchor, inputLen - anchor, 0, 0)) {
+        return 0;
+    }
+    return static_cast<size_t>(op - reinterpret_cast<uint8_t*>(output));
+}
+
+size_t logDecompressBlock(const char* input, size_t inputLen, char* output, size_t outputCapacity) {
+    const uint8_t* ip = reinterpret_cast<const uint8_t*>(input);
+    const uint8_t* inEnd = ip + inputLen;
+    uint8_t* out = reinterpret_cast<uint8_t*>(output);
+    uint8_t* op = out;
+    uint8_t* outEnd = out + outputCapacity;
+
+    while (ip < inEnd) {
+        uint8_t token = *ip++;
+        size_t literalLen = token >> 4;
+        if (literalLen == 15 && !readLength(ip, inEnd, literalLen)) {
+            return 0;
+        }
+        if (static_cast<size_t>(inEnd - ip) < literalLen || static_cast<size_t>(outEnd - op) < literalLen) {
+            return 0;
+        }
+        memcpy(op, ip, literalLen);
+        ip += literalLen;
+        op += literalLen;
+        if (ip == inEnd) {
+            // 最后一个序列只有字面量
+            break;
+        }
+
+        if (inEnd - ip < 2) {
+            return 0;
+        }
+        size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        size_t matchLen = token & 0x0F;
+        if (matchLen == 15 && !readLength(ip, inEnd, matchLen)) {
+            return 0;
+        }
+        matchLen += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<size_t>(op - out) || static_cast<size_t>(outEnd - op) < matchLen) {
+            return 0;
+        }
+        // 匹配可能与输出重叠，逐字节复制
+        const uint8_t* match = op - offset;
+        for (size_t i = 0; i < matchLen; ++i) {
+            op[i] = match[i];
+        }
+        op += matchLen;
+    }
+    return static_cast<size_t>(op - out);
+}
+
+bool logCompressFile(const char* sourcePath, const char* targetPath, uint64_t* bytesIn, uint64_t* bytesOut) {
+    ScopedHandle source(CreateFileA(sourcePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+    if (!source.valid()) {
+        return false;
+    }
+    ScopedHandle target(CreateFileA(targetPath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+    if (!target.valid()) {
+        return false;
+    }
+
+    std::unique_ptr<char[]> raw(new char[FILE_BLOCK_SIZE]);
+    std::unique_ptr<char[]> packed(new char[8 + logCompressBound(FILE_BLOCK_SIZE)]);
+    uint64_t totalIn = 0;
+    uint64_t totalOut = sizeof(FILE_MAGIC);
+    if (!writeFull(target.handle, FILE_MAGIC, sizeof(FILE_MAGIC))) {
+        return false;
+    }
+
+    while (true) {
+        size_t got = 0;
+        if (!readFull(source.handle, raw.get(), FILE_BLOCK_SIZE, got)) {
+            return false;
+        }
+        if (got == 0) {
+            break;
+        }
+        size_t packedLen = logCompressBlock(raw.get(), got, packed.get() + 8, logCompressBound(FILE_BLOCK_SIZE));
+        uint32_t storedLen;
+        const char* payload;
+        if (packedLen == 0 || packedLen >= got) {
+            // 压缩无效，按原样存储
+            storedLen = static_cast<uint32_t>(got) | STORED_FLAG;
+            payload = raw.get();
+            packedLen = got;
+        } else {
+            storedLen = static_cast<uint32_t>(packedLen);
+            payload = packed.get() + 8;
+        }
+        char header[8];
+        put32(header, static_cast<uint32_t>(got));
+        put32(header + 4, storedLen);
+        if (!writeFull(target.handle, header, sizeof(header)) || !writeFull(target.handle, payload, packedLen)) {
+            return false;
+        }
+        totalIn += got;
+        totalOut += sizeof(header) + packedLen;
+    }
+
+    char end[8] = {0};
+    if (!writeFull(target.handle, end, sizeof(end))) {
+        return false;
+    }
+    totalOut += sizeof(end);
+    if (bytesIn) {
+        *bytesIn = totalIn;
+    }
+    if (bytesOut) {
+        *bytesOut = totalOut;
+    }
+    return true;
+}
+
+bool logDecompressFile(const char* sourcePath, const char* targetPath) {
+    ScopedHandle source(CreateFileA(sourcePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL, nullptr));
+    if (!source.valid()) {
+        return false;
+    }
+    char magic[sizeof(FILE_MAGIC)];
+    size_t got = 0;
+    if (!readFull(source.handle, magic, sizeof(magic), got) || got != sizeof(magic) ||
+        memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0) {
+        return false;
+    }
+    ScopedHandle target(CreateFileA(targetPath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+    if (!target.valid()) {
+        return false;
+    }
+
+    std::unique_ptr<char[]> raw(new char[FILE_BLOCK_SIZE]);
+    std::unique_ptr<char[]> packed(new char[FILE_BLOCK_SIZE]);
+    while (true) {
+        char header[8];
+        if (!readFull(source.handle, header, sizeof(header), got) || got != sizeof(header)) {
+            return false;
+        }
+        uint32_t rawLen = get32(header);
+        uint32_t storedLen = get32(header + 4);
+        if (rawLen == 0) {
+            return true;
+        }
+        bool stored = (storedLen & STORED_FLAG) != 0;
+        storedLen &= ~STORED_FLAG;
+        if (rawLen > FILE_BLOCK_SIZE || storedLen > FILE_BLOCK_SIZE) {
+            return false;
+        }
+        char* payload = stored ? raw.get() : packed.get();
+        if (!readFull(source.handle, payload, storedLen, got) || got != storedLen) {
+            return false;
+        }
+        if (!stored && logDecompressBlock(packed.get(), storedLen, raw.get(), FILE_BLOCK_SIZE) != rawLen) {
+            return false;
+        }
+        if (!writeFull(target.handle, raw.get(), rawLen)) {
+            return false;
+        }
+    }
+}
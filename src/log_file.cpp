@@ -0,0 +1,668 @@
+#include "log_file.h"
+#include <Windows.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// 映射窗口的起始位置必须按系统的分配粒度（64KB）对齐
+const uint64_t MAP_GRANULARITY = 64 * 1024;
+
+// 无缓冲写入的长度和位置必须是扇区大小的整数倍，按4KB对齐同时满足512字节和4KB扇区的磁盘
+const size_t DIRECT_BLOCK_SIZE = 4096;
+
+// 重叠I/O方式每次将文件末尾向后扩展的长度：写入落在文件长度之内，不必在写入时扩展文件
+const uint64_t OVERLAPPED_EXTENT = 4 * 1024 * 1024;
+
+size_t alignToBlock(size_t bytes) {
+    return (bytes + DIRECT_BLOCK_SIZE - 1) / DIRECT_BLOCK_SIZE * DIRECT_BLOCK_SIZE;
+}
+
+} // namespace
+
+// 重叠I/O方式的一个缓冲区：填充完成后提交写入，写入完成前不能再使用
+struct LogFile::OverlappedSlot {
+    OVERLAPPED overlapped;
+    HANDLE event;                       // 写入完成时置位（手动重置）
+    char* data;                         // 按页对齐（VirtualAlloc），容量为按块对齐后的capacity_
+    size_t size;                        // 已填充或正在写入的字节数
+    size_t writeLen;                    // 提交的写入长度（无缓冲方式下补零到块边界）
+    bool pending;                       // 是否有尚未确认完成的写入
+};
+
+LogFile::LogFile(size_t bufferSize) :
+    handle_(INVALID_HANDLE_VALUE),
+    buffer_(new char[bufferSize > 0 ? bufferSize : 1]),
+    capacity_(bufferSize > 0 ? bufferSize : 1),
+    size_(0),
+    fileSize_(0),
+    policy_(DurabilityPolicy::flushPerBatch),
+    syncInterval_(1000),
+    syncIntervalBytes_(1024 * 1024),
+    lastSync_(std::chrono::steady_clock::now()),
+    bytesSinceSync_(0),
+    bytesWritten_(0),
+    writeCalls_(0),
+    syncCalls_(0),
+    slotCount_(0),
+    overlapped_(false),
+    currentSlot_(0),
+    writeOffset_(0),
+    endOfFile_(0),
+    overlappedWaits_(0),
+    synchronousWrites_(0),
+    directExtent_(0),
+    direct_(false),
+    directCarry_(0),
+    allocatedSize_(0),
+    preallocations_(0),
+    mapWindow_(0),
+    mapping_(nullptr),
+    view_(nullptr),
+    viewOffset_(0),
+    syncedSize_(0),
+    mapCalls_(0),
+    recoveredBytes_(0) {
+}
+
+LogFile::~LogFile() {
+    close();
+    releaseSlots();
+}
+
+bool LogFile::open(const char* path, bool truncate) {
+    close();
+    // FILE_APPEND_DATA保证每次写入都追加到文件末尾（内存映射需要读写权限，写入位置由fileSize_决定）；
+    // 允许其他进程同时读取日志，FILE_SHARE_DELETE允许在打开状态下重命名（日志轮转）
+    DWORD access = isMapped() ? GENERIC_READ | GENERIC_WRITE : FILE_APPEND_DATA;
+    DWORD share = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
+    DWORD disposition = truncate ? CREATE_ALWAYS : OPEN_ALWAYS;
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    overlapped_ = false;
+    direct_ = false;
+    recoveredBytes_ = 0;
+    if (directExtent_ > 0 && !isMapped() && openDirect(path, truncate)) {
+        lastSync_ = std::chrono::steady_clock::now();
+        bytesSinceSync_ = 0;
+        syncedSize_ = fileSize_;
+        return true;
+    }
+    if (slotCount_ > 0 && !isMapped() && openAndRecover(path, truncate)) {
+        // 重叠I/O按显式的写入位置追加，多个写入可以同时进行；无法以重叠方式打开时改用同步写入。
+        // 文件末尾按段超前扩展，先以普通方式打开截掉上次异常退出留下的零填充尾部，再以重叠方式重新打开
+        CloseHandle(static_cast<HANDLE>(handle_));
+        handle_ = INVALID_HANDLE_VALUE;
+        disposition = OPEN_ALWAYS;
+        handle = CreateFileA(path, GENERIC_WRITE, share, nullptr, disposition,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr);
+        overlapped_ = handle != INVALID_HANDLE_VALUE && createSlots();
+        if (handle != INVALID_HANDLE_VALUE && !overlapped_) {
+            CloseHandle(handle);
+            handle = INVALID_HANDLE_VALUE;
+        }
+    }
+    if (handle == INVALID_HANDLE_VALUE) {
+        handle = CreateFileA(path, access, share, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+    }
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    handle_ = handle;
+    LARGE_INTEGER size;
+    fileSize_ = GetFileSizeEx(handle, &size) ? static_cast<uint64_t>(size.QuadPart) : 0;
+    writeOffset_ = fileSize_;
+    endOfFile_ = fileSize_;
+    lastSync_ = std::chrono::steady_clock::now();
+    bytesSinceSync_ = 0;
+    if (isMapped()) {
+        recoverTail();
+        syncedSize_ = fileSize_;
+    }
+    return true;
+}
+
+bool LogFile::openAndRecover(const char* path, bool truncate) {
+    DWORD share = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
+    HANDLE handle = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, share, nullptr,
+                                truncate ? CREATE_ALWAYS : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    handle_ = handle;
+    LARGE_INTEGER size;
+    fileSize_ = GetFileSizeEx(handle, &size) ? static_cast<uint64_t>(size.QuadPart) : 0;
+    recoverTail();
+    return true;
+}
+
+bool LogFile::openDirect(const char* path, bool truncate) {
+    if (!openAndRecover(path, truncate)) {
+        return false;
+    }
+    HANDLE handle = static_cast<HANDLE>(handle_);
+    DWORD share = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
+
+    // 追加从最后一个块的边界开始，这个块中已有的数据随第一次写入一起重写
+    char tail[DIRECT_BLOCK_SIZE];
+    size_t tailLen = static_cast<size_t>(fileSize_ % DIRECT_BLOCK_SIZE);
+    bool ok = true;
+    if (tailLen > 0) {
+        LARGE_INTEGER pos;
+        pos.QuadPart = static_cast<long long>(fileSize_ - tailLen);
+        ok = SetFilePointerEx(handle, pos, nullptr, FILE_BEGIN) != FALSE;
+        size_t got = 0;
+        while (ok && got < tailLen) {
+            DWORD read = 0;
+            ok = ReadFile(handle, tail + got, static_cast<DWORD>(tailLen - got), &read, nullptr) && read > 0;
+            got += read;
+        }
+    }
+    CloseHandle(handle);
+    handle_ = INVALID_HANDLE_VALUE;
+    if (!ok) {
+        return false;
+    }
+
+    handle = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, share, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    if (!createSlots()) {
+        CloseHandle(handle);
+        return false;
+    }
+    handle_ = handle;
+    overlapped_ = true;
+    direct_ = true;
+    for (size_t i = 0; i < slotCount_; ++i) {
+        slots_[i].size = 0;
+    }
+    currentSlot_ = 0;
+    memcpy(slots_[0].data, tail, tailLen);
+    slots_[0].size = tailLen;
+    directCarry_ = tailLen;
+    writeOffset_ = fileSize_ - tailLen;
+    endOfFile_ = fileSize_;
+    allocatedSize_ = fileSize_;
+    return true;
+}
+
+void LogFile::setDirect(size_t preallocateBytes) {
+    directExtent_ = preallocateBytes;
+    // 双缓冲：一个缓冲区写入中时填充另一个
+    if (directExtent_ > 0 && slotCount_ < 2) {
+        setOverlapped(2);
+    }
+}
+
+void LogFile::setOverlapped(size_t inFlight) {
+    if (inFlight != slotCount_) {
+        releaseSlots();
+        slotCount_ = inFlight;
+    }
+}
+
+void LogFile::setMapping(size_t windowBytes) {
+    mapWindow_ = static_cast<size_t>((windowBytes + MAP_GRANULARITY - 1) / MAP_GRANULARITY * MAP_GRANULARITY);
+}
+
+void LogFile::close() {
+    if (!isOpen()) {
+        return;
+    }
+    flush();
+    // 需要落盘的策略在关闭前补做一次
+    if (policy_ == DurabilityPolicy::syncInterval || policy_ == DurabilityPolicy::syncOnError) {
+        if (bytesSinceSync_ > 0) {
+            sync();
+        }
+    }
+    if (isMapped()) {
+        // 文件长度停留在窗口末尾，截断为实际写入的长度
+        unmapWindow();
+        truncateToSize();
+    } else if (overlapped_) {
+        // 重叠I/O和无缓冲方式的文件末尾超前扩展了一段（无缓冲方式的最后一个块还补了零）
+        truncateToSize();
+    }
+    CloseHandle(static_cast<HANDLE>(handle_));
+    handle_ = INVALID_HANDLE_VALUE;
+    direct_ = false;
+    directCarry_ = 0;
+}
+
+bool LogFile::truncateToSize() {
+    bool ok = setEndOfFile(fileSize_);
+    // 截断同时释放了超出文件长度的预留空间
+    allocatedSize_ = fileSize_;
+    return ok;
+}
+
+bool LogFile::setEndOfFile(uint64_t size) {
+    // 直接设置文件长度，不移动文件指针（无缓冲方式的句柄上也不受对齐限制）
+    FILE_END_OF_FILE_INFO info;
+    info.EndOfFile.QuadPart = static_cast<long long>(size);
+    if (!SetFileInformationByHandle(static_cast<HANDLE>(handle_), FileEndOfFileInfo, &info, sizeof(info))) {
+        return false;
+    }
+    endOfFile_ = size;
+    return true;
+}
+
+void LogFile::extendEndOfFile(uint64_t end) {
+    if (end <= endOfFile_) {
+        return;
+    }
+    // 一次扩展一大段，写入落在文件长度之内时系统可以异步完成（写在文件末尾之后的写入总是同步完成）
+    setEndOfFile((end + OVERLAPPED_EXTENT - 1) / OVERLAPPED_EXTENT * OVERLAPPED_EXTENT);
+}
+
+void LogFile::reserveSpace(uint64_t end) {
+    if (end <= allocatedSize_) {
+        return;
+    }
+    // 一次预留一大段，避免每次写入扩展文件时都分配空间；文件末尾同时移到预留空间的末尾，写入不在文件末尾之后。
+    // 预留的空间在flush和sync之后仍然保留，只在关闭时截掉
+    uint64_t target = (end + directExtent_ - 1) / directExtent_ * directExtent_;
+    if (preallocate(target)) {
+        preallocations_++;
+    }
+    allocatedSize_ = target;
+    setEndOfFile(target);
+}
+
+bool LogFile::preallocate(uint64_t bytes) {
+    if (!isOpen()) {
+        return false;
+    }
+    FILE_ALLOCATION_INFO info;
+    info.AllocationSize.QuadPart = static_cast<long long>(bytes);
+    return SetFileInformationByHandle(static_cast<HANDLE>(handle_), FileAllocationInfo, &info, sizeof(info)) != FALSE;
+}
+
+bool LogFile::isOpen() const {
+    return handle_ != INVALID_HANDLE_VALUE;
+}
+
+void LogFile::setDurability(DurabilityPolicy policy, int syncIntervalMs, size_t syncIntervalBytes) {
+    policy_ = policy;
+    syncInterval_ = std::chrono::milliseconds(syncIntervalMs > 0 ? syncIntervalMs : 0);
+    syncIntervalBytes_ = syncIntervalBytes;
+}
+
+bool LogFile::writeBatch(const char* data, size_t len, bool containsError) {
+    if (!isOpen()) {
+        return false;
+    }
+    bool ok = append(data, len);
+    return endBatch(containsError) && ok;
+}
+
+bool LogFile::endBatch(bool containsError) {
+    if (!isOpen()) {
+        return false;
+    }
+
+    bool ok = true;
+    switch (policy_) {
+        case DurabilityPolicy::none:
+            // 由缓冲区满、flush或关闭触发写出
+            break;
+        case DurabilityPolicy::flushPerBatch:
+            ok = writeBuffer() && ok;
+            break;
+        case DurabilityPolicy::syncInterval: {
+            ok = writeBuffer() && ok;
+            bool bytesDue = syncIntervalBytes_ > 0 && bytesSinceSync_ >= syncIntervalBytes_;
+            bool timeDue = std::chrono::steady_clock::now() - lastSync_ >= syncInterval_;
+            if (bytesDue || timeDue) {
+                ok = sync() && ok;
+            }
+            break;
+        }
+        case DurabilityPolicy::syncOnError:
+            ok = writeBuffer() && ok;
+            if (containsError) {
+                ok = sync() && ok;
+            }
+            break;
+    }
+    return ok;
+}
+
+bool LogFile::flush() {
+    if (!isOpen()) {
+        return true;
+    }
+    bool ok = writeBuffer();
+    if (overlapped_) {
+        ok = waitAllSlots() && ok;
+    }
+    return ok;
+}
+
+bool LogFile::writeBuffer() {
+    if (overlapped_) {
+        return submitSlot();
+    }
+    if (size_ == 0) {
+        return true;
+    }
+    bool ok = writeToHandle(buffer_.get(), size_);
+    size_ = 0;
+    return ok;
+}
+
+bool LogFile::sync() {
+    if (!isOpen()) {
+        return false;
+    }
+    bool ok = isMapped() ? flushView() : flush();
+    ok = FlushFileBuffers(static_cast<HANDLE>(handle_)) && ok;
+    syncedSize_ = fileSize_;
+    syncCalls_++;
+    lastSync_ = std::chrono::steady_clock::now();
+    bytesSinceSync_ = 0;
+    return ok;
+}
+
+bool LogFile::append(const char* data, size_t len) {
+    if (!isOpen()) {
+        return false;
+    }
+    bytesSinceSync_ += len;
+    if (isMapped()) {
+        // 直接复制到映射内存，窗口写满时映射下一个窗口
+        while (len > 0) {
+            if (!view_ || fileSize_ >= viewOffset_ + mapWindow_) {
+                if (!mapNextWindow()) {
+                    return false;
+                }
+            }
+            size_t offset = static_cast<size_t>(fileSize_ - viewOffset_);
+            size_t chunk = std::min(len, mapWindow_ - offset);
+            memcpy(view_ + offset, data, chunk);
+            fileSize_ += chunk;
+            bytesWritten_ += chunk;
+            data += chunk;
+            len -= chunk;
+        }
+        return true;
+    }
+    fileSize_ += len;
+    bool ok = true;
+    if (overlapped_) {
+        // 填满一个缓冲区就提交，不等待写入完成
+        while (len > 0) {
+            OverlappedSlot& slot = slots_[currentSlot_];
+            size_t chunk = std::min(len, capacity_ - slot.size);
+            memcpy(slot.data + slot.size, data, chunk);
+            slot.size += chunk;
+            data += chunk;
+            len -= chunk;
+            if (slot.size == capacity_) {
+                ok = submitSlot() && ok;
+            }
+        }
+        return ok;
+    }
+    if (size_ + len > capacity_) {
+        ok = flush();
+        // 超过缓冲区容量的大块数据直接写出，不再经过缓冲区
+        if (len > capacity_) {
+            return writeToHandle(data, len) && ok;
+        }
+    }
+    memcpy(buffer_.get() + size_, data, len);
+    size_ += len;
+    return ok;
+}
+
+bool LogFile::writeToHandle(const char* data, size_t len) {
+    while (len > 0) {
+        DWORD chunk = static_cast<DWORD>(len > 0x40000000 ? 0x40000000 : len);
+        DWORD written = 0;
+        writeCalls_++;
+        if (!WriteFile(static_cast<HANDLE>(handle_), data, chunk, &written, nullptr) || written == 0) {
+            return false;
+        }
+        bytesWritten_ += written;
+        data += written;
+        len -= written;
+    }
+    return true;
+}
+
+bool LogFile::submitSlot() {
+    OverlappedSlot& slot = slots_[currentSlot_];
+    // 无缓冲方式下缓冲区中只有已写出过的尾部时不必重写
+    if (slot.size == 0 || (direct_ && slot.size == directCarry_)) {
+        return true;
+    }
+
+    bool ok = true;
+    slot.writeLen = slot.size;
+    if (direct_) {
+        // 本次写入的第一个块就是上一次写入的最后一个块，必须等上一次完成，否则两次写入可能乱序覆盖
+        if (directCarry_ > 0) {
+            ok = waitSlot((currentSlot_ + slotCount_ - 1) % slotCount_) && ok;
+        }
+        // 写入位置（writeOffset_）始终在块边界上，长度补零到块边界
+        slot.writeLen = alignToBlock(slot.size);
+        memset(slot.data + slot.size, 0, slot.writeLen - slot.size);
+        reserveSpace(writeOffset_ + slot.writeLen);
+    } else {
+        extendEndOfFile(writeOffset_ + slot.writeLen);
+    }
+    memset(&slot.overlapped, 0, sizeof(slot.overlapped));
+    slot.overlapped.Offset = static_cast<DWORD>(writeOffset_);
+    slot.overlapped.OffsetHigh = static_cast<DWORD>(writeOffset_ >> 32);
+    slot.overlapped.hEvent = slot.event;
+    writeCalls_++;
+    // 同步完成时同样按写入中处理，由GetOverlappedResult取得结果
+    if (WriteFile(static_cast<HANDLE>(handle_), slot.data, static_cast<DWORD>(slot.writeLen), nullptr,
+                  &slot.overlapped)) {
+        synchronousWrites_++;
+        slot.pending = true;
+    } else if (GetLastError() == ERROR_IO_PENDING) {
+        slot.pending = true;
+    } else {
+        slot.size = 0;
+        ok = false;
+    }
+    size_t tail = direct_ ? slot.size % DIRECT_BLOCK_SIZE : 0;
+    writeOffset_ += slot.size - tail;
+
+    // 切换到下一个缓冲区，它的上一次写入尚未完成时等待（全部缓冲区都在写入中）
+    currentSlot_ = (currentSlot_ + 1) % slotCount_;
+    OverlappedSlot& next = slots_[currentSlot_];
+    if (next.pending) {
+        overlappedWaits_++;
+        ok = waitSlot(currentSlot_) && ok;
+    }
+    // 不足一个块的尾部复制到下一个缓冲区开头（写入中的缓冲区只读不写）
+    memcpy(next.data, slot.data + slot.size - tail, tail);
+    next.size = tail;
+    directCarry_ = tail;
+    return ok;
+}
+
+bool LogFile::waitSlot(size_t index) {
+    OverlappedSlot& slot = slots_[index];
+    if (!slot.pending) {
+        return true;
+    }
+    DWORD written = 0;
+    bool ok = GetOverlappedResult(static_cast<HANDLE>(handle_), &slot.overlapped, &written, TRUE) != FALSE &&
+              written == slot.writeLen;
+    bytesWritten_ += written;
+    slot.pending = false;
+    slot.size = 0;
+    return ok;
+}
+
+bool LogFile::waitAllSlots() {
+    bool ok = true;
+    for (size_t i = 0; i < slotCount_; ++i) {
+        ok = waitSlot(i) && ok;
+    }
+    return ok;
+}
+
+bool LogFile::createSlots() {
+    if (slots_) {
+        return true;
+    }
+    std::unique_ptr<OverlappedSlot[]> slots(new OverlappedSlot[slotCount_]);
+    for (size_t i = 0; i < slotCount_; ++i) {
+        slots[i].event = nullptr;
+        slots[i].data = nullptr;
+        slots[i].size = 0;
+        slots[i].writeLen = 0;
+        slots[i].pending = false;
+    }
+    for (size_t i = 0; i < slotCount_; ++i) {
+        // 无缓冲写入要求缓冲区地址按扇区对齐，VirtualAlloc分配的内存按页对齐
+        slots[i].event = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+        slots[i].data = static_cast<char*>(VirtualAlloc(nullptr, alignToBlock(capacity_), MEM_COMMIT | MEM_RESERVE,
+                                                        PAGE_READWRITE));
+        if (!slots[i].event || !slots[i].data) {
+            for (size_t j = 0; j <= i; ++j) {
+                if (slots[j].event) {
+                    CloseHandle(slots[j].event);
+                }
+                if (slots[j].data) {
+                    VirtualFree(slots[j].data, 0, MEM_RELEASE);
+                }
+            }
+            return false;
+        }
+    }
+    slots_ = std::move(slots);
+    currentSlot_ = 0;
+    return true;
+}
+
+void LogFile::releaseSlots() {
+    if (!slots_) {
+        return;
+    }
+    for (size_t i = 0; i < slotCount_; ++i) {
+        if (slots_[i].event) {
+            CloseHandle(slots_[i].event);
+        }
+        if (slots_[i].data) {
+            VirtualFree(slots_[i].data, 0, MEM_RELEASE);
+        }
+    }
+    slots_.reset();
+    currentSlot_ = 0;
+}
+
+bool LogFile::mapNextWindow() {
+    unmapWindow();
+
+    // 映射长度超过文件长度时，CreateFileMapping将文件扩展到映射末尾
+    uint64_t offset = fileSize_ / MAP_GRANULARITY * MAP_GRANULARITY;
+    uint64_t end = offset + mapWindow_;
+    HANDLE mapping = CreateFileMappingA(static_cast<HANDLE>(handle_), nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(end >> 32), static_cast<DWORD>(end), nullptr);
+    if (!mapping) {
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, static_cast<DWORD>(offset >> 32),
+                               static_cast<DWORD>(offset), mapWindow_);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mapping_ = mapping;
+    view_ = static_cast<char*>(view);
+    viewOffset_ = offset;
+    mapCalls_++;
+    return true;
+}
+
+void LogFile::unmapWindow() {
+    if (!view_) {
+        return;
+    }
+    // 需要落盘的策略：离开窗口前先写回其中未落盘的部分，之后的FlushFileBuffers才能覆盖到
+    if (policy_ == DurabilityPolicy::syncInterval || policy_ == DurabilityPolicy::syncOnError) {
+        flushView();
+    }
+    UnmapViewOfFile(view_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    view_ = nullptr;
+    mapping_ = nullptr;
+}
+
+bool LogFile::flushView() {
+    if (!view_) {
+        return true;
+    }
+    uint64_t start = std::max(syncedSize_, viewOffset_);
+    if (fileSize_ <= start) {
+        return true;
+    }
+    return FlushViewOfFile(view_ + (start - viewOffset_), static_cast<size_t>(fileSize_ - start)) != FALSE;
+}
+
+void LogFile::recoverTail() {
+    // 异常退出时文件长度停留在最后一个窗口（无缓冲方式为最后一个块）的末尾，未写入的部分全为零：从末尾向前找到最后一个非零字节。
+    // 零填充部分通常不超过一个窗口（上次运行的窗口更大时可能更长），正常关闭的文件只需读取一块
+    HANDLE handle = static_cast<HANDLE>(handle_);
+    uint64_t end = fileSize_;
+    uint64_t dataEnd = 0;
+    bool found = false;
+    size_t chunkLen = 0;
+    while (end > 0 && !found) {
+        chunkLen = static_cast<size_t>(std::min<uint64_t>(capacity_, end));
+        LARGE_INTEGER pos;
+        pos.QuadPart = static_cast<long long>(end - chunkLen);
+        if (!SetFilePointerEx(handle, pos, nullptr, FILE_BEGIN)) {
+            return;
+        }
+        size_t got = 0;
+        while (got < chunkLen) {
+            DWORD read = 0;
+            if (!ReadFile(handle, buffer_.get() + got, static_cast<DWORD>(chunkLen - got), &read, nullptr) || read == 0) {
+                return;
+            }
+            got += read;
+        }
+        for (size_t i = chunkLen; i > 0; --i) {
+            if (buffer_[i - 1] != 0) {
+                dataEnd = end - chunkLen + i;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            end -= chunkLen;
+        }
+    }
+    if (dataEnd == fileSize_) {
+        // 正常关闭的文件（或由缓冲写入方式写入的文件）没有零填充的尾部
+        return;
+    }
+
+    // 映射内存中最后一批可能只写回了一部分（无缓冲方式的块写入不保证原子性）：退回到最后一个换行符之后，丢弃写了一半的行
+    if (found) {
+        size_t inChunk = static_cast<size_t>(dataEnd - (end - chunkLen));
+        size_t i = inChunk;
+        while (i > 0 && buffer_[i - 1] != '\n') {
+            --i;
+        }
+        if (i > 0) {
+            dataEnd = end - chunkLen + i;
+        }
+    }
+
+    if (setEndOfFile(dataEnd)) {
+        recoveredBytes_ = fileSize_ - dataEnd;
+        fileSize_ = dataEnd;
+    }
+}
@@ -0,0 +1,237 @@
+#include "log_sink.h"
+#include <chrono>
+#include <iostream>
+
+// LogSink
+LogSink::LogSink(LogLevel level) :
+    level_(level),
+    bufferCapacity_(1024 * 1024),
+    overflowPolicy_(SinkOverflowPolicy::block),
+    batchesWritten_(0),
+    linesWritten_(0),
+    bytesWritten_(0),
+    droppedLines_(0),
+    totalWriteNanos_(0),
+    maxWriteNanos_(0) {
+}
+
+LogSink::~LogSink() {
+}
+
+void LogSink::flush() {
+}
+
+bool LogSink::sync() {
+    flush();
+    return true;
+}
+
+void LogSink::submit(const LogBatch& batch) {
+    LogLevel level = getLevel();
+    if (batch.count == 0 || batch.maxLevel < level) {
+        return;
+    }
+    
+    // 统计通过本输出目标级别过滤的行数与字节数
+    uint64_t lines = 0;
+    uint64_t bytes = 0;
+    if (batch.minLevel >= level) {
+        lines = batch.count;
+        bytes = batch.size;
+    } else {
+        for (size_t i = 0; i < batch.count; ++i) {
+            if (batch.lines[i].level >= level) {
+                lines++;
+                bytes += batch.lines[i].length;
+            }
+        }
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    write(batch);
+    uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    
+    batchesWritten_.fetch_add(1, std::memory_order_relaxed);
+    linesWritten_.fetch_add(lines, std::memory_order_relaxed);
+    bytesWritten_.fetch_add(bytes, std::memory_order_relaxed);
+    totalWriteNanos_.fetch_add(nanos, std::memory_order_relaxed);
+    uint64_t maxNanos = maxWriteNanos_.load(std::memory_order_relaxed);
+    while (nanos > maxNanos && !maxWriteNanos_.compare_exchange_weak(maxNanos, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+SinkStats LogSink::getStats() const {
+    SinkStats stats;
+    stats.batchesWritten = batchesWritten_.load(std::memory_order_relaxed);
+    stats.linesWritten = linesWritten_.load(std::memory_order_relaxed);
+    stats.bytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+    stats.droppedLines = droppedLines_.load(std::memory_order_relaxed);
+    stats.totalWriteNanos = totalWriteNanos_.load(std::memory_order_relaxed);
+    stats.maxWriteNanos = maxWriteNanos_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void LogSink::resetStats() {
+    batchesWritten_.store(0, std::memory_order_relaxed);
+    linesWritten_.store(0, std::memory_order_relaxed);
+    bytesWritten_.store(0, std::memory_order_relaxed);
+    droppedLines_.store(0, std::memory_order_relaxed);
+    totalWriteNanos_.store(0, std::memory_order_relaxed);
+    maxWriteNanos_.store(0, std::memory_order_relaxed);
+}
+
+// FileLogSink
+FileLogSink::FileLogSink(const char* path, LogLevel level, DurabilityPolicy durability,
+                         int syncIntervalMs, size_t syncIntervalBytes, size_t mappedWindowBytes,
+                         size_t overlappedWrites, size_t directPreallocateBytes) :
+    LogSink(level) {
+    file_.setMapping(mappedWindowBytes);
+    file_.setOverlapped(overlappedWrites);
+    file_.setDirect(directPreallocateBytes);
+    if (path) {
+        file_.open(path);
+    }
+    file_.setDurability(durability, syncIntervalMs, syncIntervalBytes);
+}
+
+FileLogSink::~FileLogSink() {
+    file_.close();
+}
+
+bool FileLogSink::isOpen() const {
+    return file_.isOpen();
+}
+
+void FileLogSink::write(const LogBatch& batch) {
+    LogLevel level = getLevel();
+    if (!file_.isOpen() || batch.count == 0 || batch.maxLevel < level) {
+        return;
+    }
+    // 被过滤后剩余的各段依次追加到文件缓冲区，整批结束时按持久化策略写出一次
+    batch.forEachRun(level, [this](const char* data, size_t len) {
+        file_.append(data, len);
+    });
+    // 批次中最高级别的行一定通过了过滤，据此判断是否写入了error/critical日志
+    file_.endBatch(batch.maxLevel >= LogLevel::error);
+}
+
+void FileLogSink::flush() {
+    file_.flush();
+}
+
+bool FileLogSink::sync() {
+    return file_.sync();
+}
+
+// ConsoleLogSink
+ConsoleLogSink::ConsoleLogSink(LogLevel level) : LogSink(level) {
+}
+
+void ConsoleLogSink::write(const LogBatch& batch) {
+    LogLevel level = getLevel();
+    if (batch.count == 0 || batch.maxLevel < level) {
+        return;
+    }
+
+    // 连续写往同一个流且未被过滤的行合并为一次写入
+    size_t runStart = 0;
+    size_t runEnd = 0;
+    bool inRun = false;
+    bool runToStderr = false;
+    for (size_t i = 0; i < batch.count; ++i) {
+        const LogLine& line = batch.lines[i];
+        bool pass = line.level >= level;
+        bool toStderr = line.level >= LogLevel::warn;
+        if (inRun && (!pass || toStderr != runToStderr)) {
+            std::ostream& console = runToStderr ? std::cerr : std::cout;
+            console.write(batch.data + runStart, runEnd - runStart);
+            inRun = false;
+        }
+        if (pass) {
+            if (!inRun) {
+                runStart = line.offset;
+                runToStderr = toStderr;
+                inRun = true;
+            }
+            runEnd = line.offset + line.length;
+        }
+    }
+    if (inRun) {
+        std::ostream& console = runToStderr ? std::cerr : std::cout;
+        console.write(batch.data + runStart, runEnd - runStart);
+    }
+    std::cout.flush();
+}
+
+void ConsoleLogSink::flush() {
+    std::cout.flush();
+}
+
+// MemoryLogSink
+MemoryLogSink::MemoryLogSink(size_t capacity, LogLevel level) :
+    LogSink(level),
+    capacity_(capacity > 0 ? capacity : 1),
+    totalLines_(0) {
+}
+
+void MemoryLogSink::write(const LogBatch& batch) {
+    LogLevel level = getLevel();
+    if (batch.count == 0 || batch.maxLevel < level) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < batch.count; ++i) {
+        const LogLine& line = batch.lines[i];
+        if (line.level < level) {
+            continue;
+        }
+        // 去掉结尾的换行符
+        size_t length = line.length > 0 ? line.length - 1 : 0;
+        if (lines_.size() >= capacity_) {
+            lines_.pop_front();
+        }
+        lines_.emplace_back(batch.data + line.offset, length);
+        totalLines_++;
+    }
+}
+
+std::vector<std::string> MemoryLogSink::lines() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::vector<std::string>(lines_.begin(), lines_.end());
+}
+
+size_t MemoryLogSink::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lines_.size();
+}
+
+uint64_t MemoryLogSink::totalLines() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totalLines_;
+}
+
+void MemoryLogSink::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lines_.clear();
+}
+
+// CallbackLogSink
+CallbackLogSink::CallbackLogSink(Callback callback, LogLevel level) :
+    LogSink(level),
+    callback_(std::move(callback)) {
+}
+
+void CallbackLogSink::write(const LogBatch& batch) {
+    LogLevel level = getLevel();
+    if (!callback_ || batch.count == 0 || batch.maxLevel < level) {
+        return;
+    }
+    for (size_t i = 0; i < batch.count; ++i) {
+        const LogLine& line = batch.lines[i];
+        if (line.level >= level) {
+            callback_(line.level, batch.data + line.offset, line.length > 0 ? line.length - 1 : 0);
+        }
+    }
+}
@@ -0,0 +1,181 @@
+#include "log_sink_worker.h"
+#include <algorithm>
+#include <chrono>
+
+LogSinkWorker::LogSinkWorker(const std::shared_ptr<LogSink>& sink) :
+    sink_(sink),
+    capacity_(sink->getBufferCapacity() > 0 ? sink->getBufferCapacity() : 1),
+    policy_(sink->getOverflowPolicy()),
+    pending_(std::min(capacity_, static_cast<size_t>(64 * 1024))),
+    pendingMinLevel_(LogLevel::off),
+    pendingMaxLevel_(LogLevel::trace),
+    writing_(std::min(capacity_, static_cast<size_t>(64 * 1024))),
+    busy_(false),
+    requests_(0),
+    requestsDone_(0),
+    syncRequested_(false),
+    lastRequestOk_(true),
+    stop_(false) {
+    pendingLines_.reserve(1024);
+    writingLines_.reserve(1024);
+    thread_ = std::thread(&LogSinkWorker::writerThread, this);
+}
+
+LogSinkWorker::~LogSinkWorker() {
+    stop();
+}
+
+void LogSinkWorker::post(const LogBatch& batch) {
+    LogLevel level = sink_->getLevel();
+    if (batch.count == 0 || batch.maxLevel < level) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (policy_ == SinkOverflowPolicy::block) {
+        // 整批放不下时等待写线程取走待写缓冲区；缓冲区为空时总是接受，避免超大批次永远等待
+        size_t required = batch.minLevel >= level ? batch.size : 0;
+        if (required == 0) {
+            for (size_t i = 0; i < batch.count; ++i) {
+                if (batch.lines[i].level >= level) {
+                    required += batch.lines[i].length;
+                }
+            }
+        }
+        spaceReady_.wait(lock, [&] {
+            return stop_ || pending_.size() == 0 || pending_.size() + required <= capacity_;
+        });
+    }
+
+    uint64_t dropped = 0;
+    for (size_t i = 0; i < batch.count; ++i) {
+        const LogLine& line = batch.lines[i];
+        if (line.level < level) {
+            continue;
+        }
+        if (policy_ == SinkOverflowPolicy::drop && pending_.size() > 0 &&
+            pending_.size() + line.length > capacity_) {
+            dropped++;
+            continue;
+        }
+        LogLine copy;
+        copy.offset = pending_.size();
+        copy.length = line.length;
+        copy.level = line.level;
+        pending_.append(batch.data + line.offset, line.length);
+        pendingLines_.push_back(copy);
+        pendingMinLevel_ = std::min(pendingMinLevel_, line.level);
+        pendingMaxLevel_ = std::max(pendingMaxLevel_, line.level);
+    }
+    if (dropped > 0) {
+        sink_->droppedLines_.fetch_add(dropped, std::memory_order_relaxed);
+    }
+    bool wake = !busy_ && !pendingLines_.empty();
+    lock.unlock();
+
+    if (wake) {
+        dataReady_.notify_one();
+    }
+}
+
+bool LogSinkWorker::flush(int timeoutMs) {
+    return request(false, timeoutMs);
+}
+
+bool LogSinkWorker::sync(int timeoutMs) {
+    return request(true, timeoutMs);
+}
+
+bool LogSinkWorker::request(bool sync, int timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stop_) {
+        return false;
+    }
+    uint64_t ticket = ++requests_;
+    if (sync) {
+        syncRequested_ = true;
+    }
+    dataReady_.notify_one();
+
+    auto done = [this, ticket] {
+        return requestsDone_ >= ticket || stop_;
+    };
+    if (timeoutMs < 0) {
+        spaceReady_.wait(lock, done);
+    } else if (!spaceReady_.wait_for(lock, std::chrono::milliseconds(timeoutMs), done)) {
+        return false;
+    }
+    return requestsDone_ >= ticket && lastRequestOk_;
+}
+
+void LogSinkWorker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) {
+            return;
+        }
+        stop_ = true;
+    }
+    dataReady_.notify_one();
+    spaceReady_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    sink_->flush();
+}
+
+void LogSinkWorker::writerThread() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        dataReady_.wait(lock, [this] {
+            return stop_ || !pendingLines_.empty() || requests_ != requestsDone_;
+        });
+        if (pendingLines_.empty() && requests_ == requestsDone_) {
+            // 停止时已无剩余日志
+            break;
+        }
+
+        // 本轮之前登记的请求：先写出它们之前投递的日志，再调用一次flush或sync
+        uint64_t requests = requests_;
+        bool sync = syncRequested_;
+        syncRequested_ = false;
+
+        // 交换双缓冲，在锁外写出
+        writing_.swap(pending_);
+        writingLines_.swap(pendingLines_);
+        LogBatch batch;
+        batch.data = writing_.data();
+        batch.size = writing_.size();
+        batch.lines = writingLines_.data();
+        batch.count = writingLines_.size();
+        batch.minLevel = pendingMinLevel_;
+        batch.maxLevel = pendingMaxLevel_;
+        pendingMinLevel_ = LogLevel::off;
+        pendingMaxLevel_ = LogLevel::trace;
+        busy_ = true;
+        lock.unlock();
+        spaceReady_.notify_all();
+
+        if (batch.count > 0) {
+            sink_->submit(batch);
+        }
+        writing_.clear();
+        writingLines_.clear();
+        bool ok = true;
+        if (requests != requestsDone_) {
+            if (sync) {
+                ok = sink_->sync();
+            } else {
+                sink_->flush();
+            }
+        }
+
+        lock.lock();
+        busy_ = false;
+        if (requests != requestsDone_) {
+            requestsDone_ = requests;
+            lastRequestOk_ = ok;
+        }
+        spaceReady_.notify_all();
+    }
+}
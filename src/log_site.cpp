@@ -0,0 +1,92 @@
+#include "winlog.h"
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+// 调用点按块分配，块一旦分配就不再移动，已返回的LogSite指针始终有效
+const size_t SITE_CHUNK_SIZE = 256;
+const size_t SITE_CHUNK_COUNT = WINLOG_MAX_LOG_SITES / SITE_CHUNK_SIZE;
+
+std::mutex siteRegistryMutex;                               // 仅在登记时加锁
+std::atomic<LogSite*> siteChunks[SITE_CHUNK_COUNT];         // 调用点块表
+std::atomic<uint32_t> siteCount(0);                         // 已登记的调用点数量
+
+// 去除__FILE__中的目录部分，只保留文件名
+const char* stripDirectory(const char* path) {
+    if (!path) {
+        return "";
+    }
+    const char* name = path;
+    for (const char* p = path; *p; ++p) {
+        if (*p == '/' || *p == '\\') {
+            name = p + 1;
+        }
+    }
+    return name;
+}
+
+void fillSite(LogSite* site, uint32_t id, LogLevel level, const char* format, const char* file, int line) {
+    site->id = id;
+    site->level = level;
+    site->format = format ? format : "";
+    site->file = stripDirectory(file);
+    site->line = line;
+    site->enabled.store(true, std::memory_order_relaxed);
+}
+
+// 按ID查找调用点（ID为从1开始的登记顺序）
+LogSite* lookupSite(uint32_t id) {
+    if (id == 0 || id > siteCount.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    uint32_t index = id - 1;
+    LogSite* sites = siteChunks[index / SITE_CHUNK_SIZE].load(std::memory_order_acquire);
+    return sites ? &sites[index % SITE_CHUNK_SIZE] : nullptr;
+}
+
+} // namespace
+
+// 登记调用点（每个调用点只在其静态变量初始化时调用一次）
+LogSite* LogSiteRegistry::registerSite(LogLevel level, const char* format, const char* file, int line) {
+    std::lock_guard<std::mutex> lock(siteRegistryMutex);
+
+    uint32_t index = siteCount.load(std::memory_order_relaxed);
+    if (index >= WINLOG_MAX_LOG_SITES) {
+        // 登记表已满：返回独立的调用点，条目退化为携带格式字符串、文件名和行号
+        LogSite* site = new LogSite();
+        fillSite(site, 0, level, format, file, line);
+        return site;
+    }
+
+    size_t chunk = index / SITE_CHUNK_SIZE;
+    LogSite* sites = siteChunks[chunk].load(std::memory_order_relaxed);
+    if (!sites) {
+        sites = new LogSite[SITE_CHUNK_SIZE];
+        siteChunks[chunk].store(sites, std::memory_order_release);
+    }
+
+    LogSite* site = &sites[index % SITE_CHUNK_SIZE];
+    fillSite(site, index + 1, level, format, file, line);
+    // 发布数量之后，工作线程才能通过find看到该调用点
+    siteCount.store(index + 1, std::memory_order_release);
+    return site;
+}
+
+// 按ID查找调用点
+const LogSite* LogSiteRegistry::find(uint32_t id) {
+    return lookupSite(id);
+}
+
+size_t LogSiteRegistry::count() {
+    return siteCount.load(std::memory_order_acquire);
+}
+
+bool LogSiteRegistry::setEnabled(uint32_t id, bool enabled) {
+    LogSite* site = lookupSite(id);
+    if (!site) {
+        return false;
+    }
+    site->enabled.store(enabled, std::memory_order_relaxed);
+    return true;
+}
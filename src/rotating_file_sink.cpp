@@ -0,0 +1,357 @@
+#include "rotating_file_sink.h"
+#include "log_compressor.h"
+#include <Windows.h>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <utility>
+#include <vector>
+
+RotatingFileLogSink::RotatingFileLogSink(const char* path, const RotationConfig& rotation, LogLevel level,
+                                         DurabilityPolicy durability, int syncIntervalMs, size_t syncIntervalBytes,
+                                         size_t mappedWindowBytes, size_t overlappedWrites,
+                                         size_t directPreallocateBytes) :
+    LogSink(level),
+    path_(path ? path : ""),
+    nextPath_(path_ + ".next"),
+    rotation_(rotation),
+    durability_(durability),
+    syncIntervalMs_(syncIntervalMs),
+    syncIntervalBytes_(syncIntervalBytes),
+    mappedWindowBytes_(mappedWindowBytes),
+    overlappedWrites_(overlappedWrites),
+    directPreallocateBytes_(directPreallocateBytes),
+    nextIndex_(1),
+    nextRotateTime_(0),
+    syncUsed_(false),
+    prepareRequested_(false),
+    busy_(false),
+    stop_(false) {
+    if (path_.empty()) {
+        return;
+    }
+    current_ = openFile(path_.c_str(), false);
+    scanArchives();
+    if (rotation_.rotateIntervalSec > 0) {
+        nextRotateTime_ = nextRotationTime(static_cast<int64_t>(time(nullptr)));
+    }
+    // 启动后立即预先创建下一个文件
+    prepareRequested_ = true;
+    thread_ = std::thread(&RotatingFileLogSink::backgroundThread, this);
+}
+
+RotatingFileLogSink::~RotatingFileLogSink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    workReady_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (current_) {
+        current_->close();
+    }
+    // 未使用的预建文件
+    if (prepared_) {
+        prepared_->close();
+        prepared_.reset();
+        DeleteFileA(nextPath_.c_str());
+    }
+}
+
+bool RotatingFileLogSink::isOpen() const {
+    return current_ && current_->isOpen();
+}
+
+void RotatingFileLogSink::write(const LogBatch& batch) {
+    LogLevel level = getLevel();
+    if (!current_ || batch.count == 0 || batch.maxLevel < level) {
+        return;
+    }
+
+    // 按时间轮转：到达边界时先轮转，本批日志写入新的文件；空文件不轮转
+    if (nextRotateTime_ > 0) {
+        int64_t now = static_cast<int64_t>(time(nullptr));
+        if (now >= nextRotateTime_) {
+            if (current_->fileSize() > 0) {
+                rotate();
+            }
+            nextRotateTime_ = nextRotationTime(now);
+            if (!current_) {
+                return;
+            }
+        }
+    }
+
+    batch.forEachRun(level, [this](const char* data, size_t len) {
+        current_->append(data, len);
+    });
+    current_->endBatch(batch.maxLevel >= LogLevel::error);
+
+    // 按大小轮转：在批次之间进行，一批日志不会被拆到两个文件中
+    if (rotation_.maxFileBytes > 0 && current_->fileSize() >= rotation_.maxFileBytes) {
+        rotate();
+    }
+}
+
+void RotatingFileLogSink::flush() {
+    if (current_) {
+        current_->flush();
+    }
+}
+
+bool RotatingFileLogSink::sync() {
+    syncUsed_ = true;
+    return !current_ || current_->sync();
+}
+
+RotationStats RotatingFileLogSink::getRotationStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+bool RotatingFileLogSink::waitIdle(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto idle = [this] {
+        return pendingArchives_.empty() && !busy_ && !prepareRequested_;
+    };
+    if (timeoutMs < 0) {
+        idle_.wait(lock, idle);
+        return true;
+    }
+    return idle_.wait_for(lock, std::chrono::milliseconds(timeoutMs), idle);
+}
+
+void RotatingFileLogSink::rotate() {
+    auto start = std::chrono::steady_clock::now();
+
+    // 关闭前按持久化策略写出并落盘；使用过sync（持久化票据）时总是先落盘，
+    // 之后的sync只作用于新文件，已轮转出去的日志也必须已经落盘
+    if (syncUsed_) {
+        current_->sync();
+    }
+    current_->close();
+    uint64_t index = nextIndex_;
+    std::string archive = archivePath(index);
+    bool archived = MoveFileExA(path_.c_str(), archive.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+    if (archived) {
+        nextIndex_++;
+    }
+
+    std::unique_ptr<LogFile> next;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next = std::move(prepared_);
+    }
+    // 预建文件以FILE_SHARE_DELETE打开，可以在打开状态下直接重命名为当前文件
+    bool switched = next && archived &&
+                    MoveFileExA(nextPath_.c_str(), path_.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+    if (!switched) {
+        if (next) {
+            next->close();
+            next.reset();
+            DeleteFileA(nextPath_.c_str());
+        }
+        // 没有预建文件或重命名失败：重新打开当前路径（重命名失败时继续追加到原文件）
+        next = openFile(path_.c_str(), false);
+    }
+    current_ = std::move(next);
+
+    uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.rotations++;
+        if (switched) {
+            stats_.preparedSwitches++;
+        }
+        stats_.totalRotationNanos += nanos;
+        stats_.maxRotationNanos = std::max(stats_.maxRotationNanos, nanos);
+        if (archived) {
+            pendingArchives_.push_back(index);
+        }
+        prepareRequested_ = true;
+    }
+    workReady_.notify_one();
+}
+
+std::unique_ptr<LogFile> RotatingFileLogSink::openFile(const char* path, bool truncate) {
+    std::unique_ptr<LogFile> file(new LogFile());
+    // 内存映射方式在第一次写入时才映射，预建文件在未映射的状态下重命名
+    file->setMapping(mappedWindowBytes_);
+    file->setOverlapped(overlappedWrites_);
+    file->setDirect(directPreallocateBytes_);
+    if (!file->open(path, truncate)) {
+        return nullptr;
+    }
+    file->setDurability(durability_, syncIntervalMs_, syncIntervalBytes_);
+    return file;
+}
+
+int64_t RotatingFileLogSink::nextRotationTime(int64_t now) const {
+    int64_t interval = rotation_.rotateIntervalSec;
+
+    // 本地时间相对UTC的偏移，使轮转时刻对齐到本地的整点或零点
+    time_t t = static_cast<time_t>(now);
+    std::tm local;
+    std::tm utc;
+    localtime_s(&local, &t);
+    gmtime_s(&utc, &t);
+    int dayDiff = local.tm_yday - utc.tm_yday;
+    if (dayDiff > 1) {
+        dayDiff = -1;
+    } else if (dayDiff < -1) {
+        dayDiff = 1;
+    }
+    int64_t offset = static_cast<int64_t>(dayDiff) * 86400 + (local.tm_hour - utc.tm_hour) * 3600 +
+                     (local.tm_min - utc.tm_min) * 60;
+
+    int64_t localNow = now + offset;
+    return (localNow / interval + 1) * interval - offset;
+}
+
+void RotatingFileLogSink::scanArchives() {
+    size_t slash = path_.find_last_of("/\\");
+    std::string baseName = path_.substr(slash == std::string::npos ? 0 : slash + 1) + ".";
+
+    // 历史文件名为"<文件名>.<序号>"或"<文件名>.<序号>.wlz"
+    std::vector<std::pair<uint64_t, bool>> found;
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((path_ + ".*").c_str(), &data);
+    if (find != INVALID_HANDLE_VALUE) {
+        do {
+            std::string name = data.cFileName;
+            if (name.compare(0, baseName.size(), baseName) != 0) {
+                continue;
+            }
+            std::string suffix = name.substr(baseName.size());
+            size_t digits = 0;
+            while (digits < suffix.size() && suffix[digits] >= '0' && suffix[digits] <= '9') {
+                digits++;
+            }
+            if (digits == 0 || digits > 18) {
+                continue;
+            }
+            bool compressed = suffix.compare(digits, std::string::npos, ".wlz") == 0;
+            if (digits != suffix.size() && !compressed) {
+                continue;
+            }
+            found.emplace_back(std::stoull(suffix.substr(0, digits)), compressed);
+        } while (FindNextFileA(find, &data));
+        FindClose(find);
+    }
+
+    // 同一序号同时存在两种形式时（压缩中途退出），按未压缩处理，重新压缩
+    std::sort(found.begin(), found.end());
+    for (size_t i = 0; i < found.size(); ++i) {
+        uint64_t index = found[i].first;
+        if (!archives_.empty() && archives_.back() == index) {
+            continue;
+        }
+        archives_.push_back(index);
+        if (!found[i].second && rotation_.compress) {
+            pendingArchives_.push_back(index);
+        }
+    }
+    if (!archives_.empty()) {
+        nextIndex_ = archives_.back() + 1;
+    }
+}
+
+std::string RotatingFileLogSink::archivePath(uint64_t index) const {
+    return path_ + "." + std::to_string(index);
+}
+
+void RotatingFileLogSink::backgroundThread() {
+    // 压缩与日志写入争用CPU和磁盘时让出
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        workReady_.wait(lock, [this] {
+            return stop_ || prepareRequested_ || !pendingArchives_.empty();
+        });
+
+        // 预先创建下一个文件优先于压缩，保证下一次轮转能直接切换
+        if (prepareRequested_ && !stop_) {
+            prepareRequested_ = false;
+            busy_ = true;
+            lock.unlock();
+            std::unique_ptr<LogFile> file = openFile(nextPath_.c_str(), true);
+            if (file && rotation_.preallocateBytes > 0) {
+                file->preallocate(rotation_.preallocateBytes);
+            }
+            lock.lock();
+            prepared_ = std::move(file);
+            busy_ = false;
+            idle_.notify_all();
+            continue;
+        }
+
+        // 停止时仍处理完已排队的历史文件
+        if (!pendingArchives_.empty()) {
+            uint64_t index = pendingArchives_.front();
+            pendingArchives_.pop_front();
+            busy_ = true;
+            lock.unlock();
+            processArchive(index);
+            lock.lock();
+            busy_ = false;
+            idle_.notify_all();
+            continue;
+        }
+
+        if (stop_) {
+            break;
+        }
+    }
+    prepareRequested_ = false;
+    idle_.notify_all();
+}
+
+void RotatingFileLogSink::processArchive(uint64_t index) {
+    std::string archive = archivePath(index);
+
+    if (rotation_.compress) {
+        std::string temp = archive + ".wlz.tmp";
+        std::string target = archive + ".wlz";
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;
+        auto start = std::chrono::steady_clock::now();
+        // 先写临时文件，完成后再重命名，避免留下不完整的.wlz
+        if (logCompressFile(archive.c_str(), temp.c_str(), &bytesIn, &bytesOut) &&
+            MoveFileExA(temp.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+            DeleteFileA(archive.c_str());
+            uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.filesCompressed++;
+            stats_.compressedBytesIn += bytesIn;
+            stats_.compressedBytesOut += bytesOut;
+            stats_.compressionNanos += nanos;
+        } else {
+            DeleteFileA(temp.c_str());
+        }
+    }
+
+    // 只保留最近maxFiles个历史文件
+    if (archives_.empty() || archives_.back() < index) {
+        archives_.push_back(index);
+    }
+    uint64_t deleted = 0;
+    while (rotation_.maxFiles >= 0 && archives_.size() > static_cast<size_t>(rotation_.maxFiles)) {
+        std::string oldest = archivePath(archives_.front());
+        archives_.pop_front();
+        if (DeleteFileA(oldest.c_str())) {
+            deleted++;
+        }
+        if (DeleteFileA((oldest + ".wlz").c_str())) {
+            deleted++;
+        }
+    }
+    if (deleted > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.filesDeleted += deleted;
+    }
+}
@@ -0,0 +1,153 @@
+#include "spill_file.h"
+#include <Windows.h>
+#include <cstring>
+
+namespace {
+
+// 默认溢出文件名的序号，同一进程中的多个队列各用一个文件
+std::atomic<uint32_t> nextSpillId(1);
+
+// 容量向上取整为2的幂（不小于一个分配粒度）
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 64 * 1024;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+SpillFile::SpillFile() :
+    handle_(INVALID_HANDLE_VALUE),
+    mapping_(nullptr),
+    view_(nullptr),
+    capacity_(0),
+    pendingSize_(0),
+    peekSize_(0),
+    writePos_(0),
+    readPos_(0) {
+}
+
+SpillFile::~SpillFile() {
+    close();
+}
+
+bool SpillFile::open(const char* path, size_t capacity) {
+    close();
+
+    if (path && *path) {
+        path_ = path;
+    } else {
+        char tempDir[MAX_PATH];
+        DWORD len = GetTempPathA(MAX_PATH, tempDir);
+        path_.assign(tempDir, len > 0 && len < MAX_PATH ? len : 0);
+        path_ += "winlog_spill_" + std::to_string(GetCurrentProcessId()) + "_" +
+                 std::to_string(nextSpillId.fetch_add(1)) + ".tmp";
+    }
+
+    // 临时文件属性提示系统尽量把数据留在缓存中，只有内存紧张时才真正写到磁盘
+    HANDLE handle = CreateFileA(path_.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                FILE_ATTRIBUTE_TEMPORARY, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    // 映射长度超过文件长度时，CreateFileMapping将文件扩展到映射末尾
+    size_t size = roundUpToPowerOfTwo(capacity);
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READWRITE, static_cast<DWORD>((uint64_t)size >> 32),
+                                        static_cast<DWORD>(size), nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size) : nullptr;
+    if (!view) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(handle);
+        DeleteFileA(path_.c_str());
+        return false;
+    }
+
+    handle_ = handle;
+    mapping_ = mapping;
+    view_ = static_cast<char*>(view);
+    capacity_ = size;
+    pendingSize_ = 0;
+    peekSize_ = 0;
+    writePos_.store(0, std::memory_order_relaxed);
+    readPos_.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void SpillFile::close() {
+    if (view_) {
+        UnmapViewOfFile(view_);
+        view_ = nullptr;
+    }
+    if (mapping_) {
+        CloseHandle(static_cast<HANDLE>(mapping_));
+        mapping_ = nullptr;
+    }
+    if (handle_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(static_cast<HANDLE>(handle_));
+        handle_ = INVALID_HANDLE_VALUE;
+        DeleteFileA(path_.c_str());
+    }
+    capacity_ = 0;
+}
+
+char* SpillFile::reserve(size_t payloadLen) {
+    size_t total = recordSize(payloadLen);
+    if (!view_ || total > capacity_ / 2) {
+        return nullptr;
+    }
+
+    uint64_t pos = writePos_.load(std::memory_order_relaxed);
+    uint64_t read = readPos_.load(std::memory_order_acquire);
+    size_t offset = static_cast<size_t>(pos & (capacity_ - 1));
+    size_t contiguous = capacity_ - offset;
+    size_t need = total <= contiguous ? total : contiguous + total;
+    if (pos + need - read > capacity_) {
+        return nullptr;
+    }
+
+    // 尾部放不下时写入回绕标记，记录从文件开头开始（读取者在公布之前不会读到标记）
+    if (total > contiguous) {
+        RecordPrefix wrap = {WRAP_MARKER, 0};
+        memcpy(view_ + offset, &wrap, sizeof(wrap));
+        offset = 0;
+    }
+    RecordPrefix prefix = {static_cast<uint32_t>(payloadLen), 0};
+    memcpy(view_ + offset, &prefix, sizeof(prefix));
+    pendingSize_ = need;
+    return view_ + offset + sizeof(RecordPrefix);
+}
+
+void SpillFile::commit() {
+    writePos_.store(writePos_.load(std::memory_order_relaxed) + pendingSize_, std::memory_order_release);
+    pendingSize_ = 0;
+}
+
+const char* SpillFile::peek(size_t& payloadLen) {
+    uint64_t pos = readPos_.load(std::memory_order_relaxed);
+    if (pos == writePos_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    size_t offset = static_cast<size_t>(pos & (capacity_ - 1));
+    RecordPrefix prefix;
+    memcpy(&prefix, view_ + offset, sizeof(prefix));
+    size_t skipped = 0;
+    if (prefix.length == WRAP_MARKER) {
+        skipped = capacity_ - offset;
+        offset = 0;
+        memcpy(&prefix, view_, sizeof(prefix));
+    }
+    payloadLen = prefix.length;
+    peekSize_ = skipped + recordSize(payloadLen);
+    return view_ + offset + sizeof(RecordPrefix);
+}
+
+void SpillFile::pop() {
+    readPos_.store(readPos_.load(std::memory_order_relaxed) + peekSize_, std::memory_order_release);
+    peekSize_ = 0;
+}
@@ -0,0 +1,101 @@
+#include "timestamp_formatter.h"
+#include <Windows.h>
+#include <ctime>
+#include <cstring>
+
+namespace {
+
+const int64_t NANOS_PER_SECOND = 1000000000;
+
+// 以固定宽度写入十进制数字（不足位补0）
+inline void writeDigits(char* out, uint32_t value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+} // namespace
+
+TimestampFormatter::TimestampFormatter(TimestampPrecision precision, TimestampZone zone) :
+    precision_(precision),
+    zone_(zone),
+    cachedSecond_(0),
+    cacheValid_(false) {
+    memset(prefix_, 0, sizeof(prefix_));
+}
+
+size_t TimestampFormatter::format(std::chrono::system_clock::time_point time, char* out) {
+    int64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    return format(nanos, out);
+}
+
+size_t TimestampFormatter::format(int64_t nanosSinceEpoch, char* out) {
+    // 向下取整到秒（纪元之前的时间点余数为负）
+    int64_t seconds = nanosSinceEpoch / NANOS_PER_SECOND;
+    int64_t subsecond = nanosSinceEpoch % NANOS_PER_SECOND;
+    if (subsecond < 0) {
+        subsecond += NANOS_PER_SECOND;
+        seconds--;
+    }
+
+    if (!cacheValid_ || seconds != cachedSecond_) {
+        refreshPrefix(seconds);
+    }
+
+    memcpy(out, prefix_, PREFIX_LEN);
+    char* p = out + PREFIX_LEN;
+    *p++ = '.';
+
+    // 只写入所需精度的小数位
+    int digits = static_cast<int>(precision_);
+    uint32_t fraction = static_cast<uint32_t>(subsecond);
+    if (precision_ == TimestampPrecision::milliseconds) {
+        fraction /= 1000000;
+    } else if (precision_ == TimestampPrecision::microseconds) {
+        fraction /= 1000;
+    }
+    writeDigits(p, fraction, digits);
+    p += digits;
+    *p = '\0';
+    return static_cast<size_t>(p - out);
+}
+
+void TimestampFormatter::setPrecision(TimestampPrecision precision) {
+    precision_ = precision;
+}
+
+void TimestampFormatter::setZone(TimestampZone zone) {
+    if (zone_ != zone) {
+        zone_ = zone;
+        cacheValid_ = false;
+    }
+}
+
+// 每秒最多执行一次时区转换，日期与时间各字段手工写入，避免strftime的格式解析开销
+void TimestampFormatter::refreshPrefix(int64_t seconds) {
+    std::time_t time = static_cast<std::time_t>(seconds);
+    std::tm tm;
+    memset(&tm, 0, sizeof(tm));
+    if (zone_ == TimestampZone::utc) {
+        gmtime_s(&tm, &time);
+    } else {
+        localtime_s(&tm, &time);
+    }
+
+    writeDigits(prefix_, static_cast<uint32_t>(tm.tm_year + 1900), 4);
+    prefix_[4] = '-';
+    writeDigits(prefix_ + 5, static_cast<uint32_t>(tm.tm_mon + 1), 2);
+    prefix_[7] = '-';
+    writeDigits(prefix_ + 8, static_cast<uint32_t>(tm.tm_mday), 2);
+    prefix_[10] = ' ';
+    writeDigits(prefix_ + 11, static_cast<uint32_t>(tm.tm_hour), 2);
+    prefix_[13] = ':';
+    writeDigits(prefix_ + 14, static_cast<uint32_t>(tm.tm_min), 2);
+    prefix_[16] = ':';
+    writeDigits(prefix_ + 17, static_cast<uint32_t>(tm.tm_sec), 2);
+    prefix_[PREFIX_LEN] = '\0';
+
+    cachedSecond_ = seconds;
+    cacheValid_ = true;
+}
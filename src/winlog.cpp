@@ -1,15 +1,20 @@
 #include "winlog.h"
 #include "async_log_queue.h"
+#include "binary_log_format.h"
+#include "log_args.h"
+#include "log_output_buffer.h"
+#include "log_sink.h"
+#include "log_sink_worker.h"
+#include "rotating_file_sink.h"
 #include <Windows.h>
 #include <string>
-#include <fstream>
-#include <iostream>
-#include <sstream>
+#include <algorithm>
+#include <iterator>
 #include <ctime>
 #include <cstdarg>
 #include <mutex>
+#include <condition_variable>
 #include <chrono>
-#include <iomanip>
 #include <memory>
 #include <cstring>
 
@@ -23,7 +28,7 @@ std::mutex globalWinLogMutex;
 // 已在编译命令中定义WINLOG_EXPORTS，不需要在这里再次定义
 
 // LogEntry 默认构造函数实现
-LogEntry::LogEntry() : level(LogLevel::info), line(0), messageLen(0), fileLen(0), timeLen(0) {
+LogEntry::LogEntry() : level(LogLevel::info), line(0), messageLen(0), fileLen(0), timeLen(0), timestamp(0), format(nullptr), siteId(0), expedited(false) {
     memset(this->message, 0, LOG_MESSAGE_BUFFER_SIZE);
     memset(this->file, 0, LOG_FILE_BUFFER_SIZE);
     memset(this->time, 0, 32);
@@ -31,7 +36,7 @@ LogEntry::LogEntry() : level(LogLevel::info), line(0), messageLen(0), fileLen(0)
 
 // LogEntry 带参构造函数实现
 LogEntry::LogEntry(LogLevel level, const std::string& message) :
-    level(level), line(0), messageLen(0), fileLen(0), timeLen(0) {
+    level(level), line(0), messageLen(0), fileLen(0), timeLen(0), timestamp(0), format(nullptr), siteId(0), expedited(false) {
     memset(this->message, 0, LOG_MESSAGE_BUFFER_SIZE);
     memset(this->file, 0, LOG_FILE_BUFFER_SIZE);
     memset(this->time, 0, 32);
@@ -48,7 +53,11 @@ LogEntry::LogEntry(LogEntry&& other) noexcept :
     line(other.line),
     messageLen(other.messageLen),
     fileLen(other.fileLen),
-    timeLen(other.timeLen) {
+    timeLen(other.timeLen),
+    timestamp(other.timestamp),
+    format(other.format),
+    siteId(other.siteId),
+    expedited(other.expedited) {
     // 复制消息内容
     if (messageLen > 0) {
         memcpy(this->message, other.message, messageLen + 1);
@@ -70,11 +79,41 @@ LogEntry::LogEntry(LogEntry&& other) noexcept :
     other.messageLen = 0;
     other.fileLen = 0;
     other.timeLen = 0;
+    other.timestamp = 0;
+    other.format = nullptr;
+    other.siteId = 0;
+    other.expedited = false;
     other.message[0] = '\0';
     other.file[0] = '\0';
     other.time[0] = '\0';
 }
 
+// LogEntry 移动赋值运算符实现
+LogEntry& LogEntry::operator=(LogEntry&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    
+    level = other.level;
+    line = other.line;
+    messageLen = other.messageLen;
+    fileLen = other.fileLen;
+    timeLen = other.timeLen;
+    timestamp = other.timestamp;
+    format = other.format;
+    siteId = other.siteId;
+    expedited = other.expedited;
+    
+    // 只复制有效长度的内容（包括结尾的'\0'）
+    memcpy(this->message, other.message, messageLen + 1);
+    memcpy(this->file, other.file, fileLen + 1);
+    memcpy(this->time, other.time, timeLen + 1);
+    
+    // 重置源对象
+    other.reset();
+    return *this;
+}
+
 // 重置对象状态
 void LogEntry::reset() {
     level = LogLevel::info;
@@ -82,6 +121,10 @@ void LogEntry::reset() {
     messageLen = 0;
     fileLen = 0;
     timeLen = 0;
+    timestamp = 0;
+    format = nullptr;
+    siteId = 0;
+    expedited = false;
     message[0] = '\0';
     file[0] = '\0';
     time[0] = '\0';
@@ -97,6 +140,18 @@ void LogEntry::setMessage(const char* msg, size_t len) {
     }
 }
 
+// 直接在消息缓冲区中格式化，超出部分被截断
+void LogEntry::formatMessage(const char* format, va_list args) {
+    int written = vsnprintf(message, LOG_MESSAGE_BUFFER_SIZE, format, args);
+    if (written < 0) {
+        message[0] = '\0';
+        messageLen = 0;
+    } else {
+        messageLen = std::min((size_t)written, (size_t)LOG_MESSAGE_BUFFER_SIZE - 1);
+    }
+    this->format = nullptr;
+}
+
 // 安全地设置文件名
 void LogEntry::setFile(const char* filename, size_t len) {
     if (filename && len > 0) {
@@ -122,10 +177,25 @@ class WinLog::Impl {
 public:
     Impl() : 
         logLevel(LogLevel::info), 
-        fileStream(nullptr), 
         isInit(false),
         asyncMode(false),
-        asyncQueue(nullptr) {}
+        asyncQueue(nullptr),
+        sinkMinLevel(LogLevel::off),
+        binarySinkMinLevel(LogLevel::off),
+        outputMinLevel(LogLevel::off),
+        outputMaxLevel(LogLevel::trace),
+        binaryMinLevel(LogLevel::off),
+        binaryMaxLevel(LogLevel::trace),
+        priorityLevel(LogLevel::off),
+        priorityOrdering(PriorityOrdering::perSink),
+        syncSequence(0),
+        durableSequence(0),
+        durableSyncing(false),
+        durableWaits(0),
+        durableSyncs(0) {
+        outputLines.reserve(1024);
+        binaryLines.reserve(1024);
+    }
     
     ~Impl() {
         shutdown();
@@ -136,15 +206,12 @@ public:
         
         logLevel = level;
         asyncMode = false;
+        sinkWorkers.clear();
+        resetDurable();
         
-        // 初始化文件流
-        if (logFilePath) {
-            fileStream = new std::ofstream(logFilePath, std::ios::out | std::ios::app);
-            if (!fileStream->is_open()) {
-                delete fileStream;
-                fileStream = nullptr;
-                return false;
-            }
+        // 创建默认输出目标（同步模式下每条日志写入后立即交给操作系统）
+        if (!addDefaultSinks(logFilePath, DurabilityPolicy::flushPerBatch, 0, 0, RotationConfig(), 0, 0, 0)) {
+            return false;
         }
         
         isInit = true;
@@ -156,32 +223,40 @@ public:
         
         logLevel = level;
         asyncMode = asyncConfig.enabled;
+        // 重复init时先停止上一次创建的写线程，下面按当前的输出目标重新创建
+        sinkWorkers.clear();
+        resetDurable();
         
-        // 初始化文件流
-        if (logFilePath) {
-            fileStream = new std::ofstream(logFilePath, std::ios::out | std::ios::app);
-            if (!fileStream->is_open()) {
-                delete fileStream;
-                fileStream = nullptr;
-                return false;
-            }
+        // 创建默认输出目标（同步模式没有批次，仍按每条日志写入）
+        if (!addDefaultSinks(logFilePath, asyncMode ? asyncConfig.durability : DurabilityPolicy::flushPerBatch,
+                             asyncConfig.syncIntervalMs, asyncConfig.syncIntervalBytes, asyncConfig.rotation,
+                             asyncConfig.mappedWindowBytes, asyncConfig.overlappedWrites,
+                             asyncConfig.directPreallocateBytes)) {
+            return false;
         }
         
         // 初始化异步队列
         if (asyncMode) {
-            asyncQueue = new AsyncLogQueue(
-                asyncConfig.queueSize,
-                asyncConfig.maxBatchSize,
-                asyncConfig.memoryPoolSize,
-                asyncConfig.dropOnOverflow,
-                asyncConfig.flushIntervalMs
-            );
+            // 在创建队列前切换时钟源，此后取得的计数都按同一对应关系换算
+            // （仍有其他异步队列在运行时拒绝切换，沿用当前时钟源）
+            LogClock::setSource(asyncConfig.clockSource);
+            asyncQueue = new AsyncLogQueue(asyncConfig);
+            
+            // 每个输出目标由自己的写线程写出
+            for (const auto& sink : sinks) {
+                sinkWorkers.emplace_back(new LogSinkWorker(sink));
+            }
             
             // 设置日志处理回调
             auto self = this;
-            asyncQueue->setLogHandler([self](const std::vector<LogEntry>& entries) {
+            asyncQueue->setLogHandler([self](const std::vector<LogEntry*>& entries) {
                 self->processLogEntries(entries);
             });
+            priorityLevel = asyncConfig.priorityLevel;
+            priorityOrdering = asyncConfig.priorityOrdering;
+            asyncQueue->setPriorityHandler([self](const std::vector<LogEntry*>& entries) {
+                self->processPriorityEntries(entries);
+            });
         }
         
         isInit = true;
@@ -193,22 +268,125 @@ public:
             return;
         }
         
-        // 格式化日志消息
-        char message[4096];
-        vsnprintf(message, sizeof(message), format, args);
-        
-        LogEntry entry;
-        entry.level = level;
-        entry.setMessage(message, strlen(message));
-        
         if (asyncMode && asyncQueue) {
-            // 异步模式：放入队列
-            asyncQueue->enqueue(std::move(entry));
+            // 异步模式：从内存池取出条目，直接在其中格式化，队列只传递指针
+            LogEntry* entry = asyncQueue->allocateEntry();
+            entry->timestamp = LogClock::now();
+            entry->level = level;
+            entry->formatMessage(format, args);
+            asyncQueue->enqueue(entry);
         } else {
             // 同步模式：直接输出
+            LogEntry entry;
+            entry.timestamp = LogClock::now();
+            entry.level = level;
+            entry.formatMessage(format, args);
+            
             std::lock_guard<std::mutex> lock(logMutex);
             writeLogToOutputs(entry);
+            syncTicket = ++syncSequence;
+        }
+    }
+    
+    // 延迟格式化：级别过滤后取出条目，异步模式下来自内存池，同步模式下使用线程本地条目
+    LogEntry* beginDeferred(LogLevel level, const char* format) {
+        if (!isInit || level < logLevel || level >= LogLevel::off) {
+            return nullptr;
+        }
+        
+        LogEntry* entry;
+        if (asyncMode && asyncQueue) {
+            entry = asyncQueue->allocateEntry();
+        } else {
+            entry = &syncDeferredEntry;
+            entry->reset();
+        }
+        // 时间戳在调用点取得原始计数，换算与格式化留给工作线程
+        entry->timestamp = LogClock::now();
+        entry->level = level;
+        entry->format = format;
+        return entry;
+    }
+    
+    // 日志批次：级别过滤后取出条目，异步模式下来自内存池，同步模式下直接分配
+    LogEntry* allocateBatchEntry(LogLevel level) {
+        if (!isInit || level < logLevel || level >= LogLevel::off) {
+            return nullptr;
         }
+        LogEntry* entry = (asyncMode && asyncQueue) ? asyncQueue->allocateEntry() : new LogEntry();
+        entry->timestamp = LogClock::now();
+        entry->level = level;
+        return entry;
+    }
+    
+    // 归还批次中的条目（内存池中的条目同样由new分配，模式切换后直接释放也是安全的）
+    void freeBatchEntries(std::vector<LogEntry*>& entries) {
+        for (LogEntry* entry : entries) {
+            if (asyncMode && asyncQueue) {
+                asyncQueue->freeEntry(entry);
+            } else {
+                delete entry;
+            }
+        }
+        entries.clear();
+    }
+    
+    // 提交日志批次：异步模式下整批交给队列，同步模式下整批追加到输出缓冲区后一次写出
+    bool logBatch(std::vector<LogEntry*>& entries) {
+        if (entries.empty()) {
+            return true;
+        }
+        if (asyncMode && asyncQueue) {
+            size_t count = entries.size();
+            size_t accepted = asyncQueue->enqueueBatch(entries.data(), count);
+            entries.clear();
+            return accepted == count;
+        }
+        if (!isInit) {
+            freeBatchEntries(entries);
+            return false;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            updateSinkMinLevel();
+            for (LogEntry* entry : entries) {
+                appendEntry(*entry);
+            }
+            writeOutputBuffer();
+            syncTicket = syncSequence += entries.size();
+        }
+        freeBatchEntries(entries);
+        return true;
+    }
+    
+    // 调用点日志：格式字符串指针直接取自调用点，文件名和行号只记录调用点ID，由工作线程从登记表中取得
+    LogEntry* beginSite(const LogSite* site) {
+        LogEntry* entry = beginDeferred(site->level, site->format);
+        if (!entry) {
+            return nullptr;
+        }
+        if (site->id != 0) {
+            entry->siteId = site->id;
+        } else {
+            // 登记表已满时未能登记的调用点：条目自带文件名和行号
+            entry->setFile(site->file, strlen(site->file));
+            entry->line = site->line;
+        }
+        return entry;
+    }
+    
+    // 延迟格式化：异步模式下只传递指针，格式化由工作线程完成
+    void commitDeferred(LogEntry* entry) {
+        if (entry != &syncDeferredEntry) {
+            asyncQueue->enqueue(entry);
+            return;
+        }
+        
+        // 同步模式：没有工作线程，在调用线程中直接输出（只有文本输出目标需要时才格式化）
+        std::lock_guard<std::mutex> lock(logMutex);
+        writeLogToOutputs(*entry);
+        syncTicket = ++syncSequence;
     }
     
     void setLevel(LogLevel level) {
@@ -216,40 +394,163 @@ public:
         logLevel = level;
     }
     
-    void shutdown() {
+    void setTimestampFormat(TimestampPrecision precision, TimestampZone zone) {
         std::lock_guard<std::mutex> lock(logMutex);
-        
-        // 关闭异步队列
-        if (asyncQueue) {
-            asyncQueue->stop();
-            delete asyncQueue;
+        timestampFormatter.setPrecision(precision);
+        timestampFormatter.setZone(zone);
+    }
+    
+    void addSink(const std::shared_ptr<LogSink>& sink) {
+        if (!sink) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(logMutex);
+        if (std::find(sinks.begin(), sinks.end(), sink) == sinks.end()) {
+            sinks.push_back(sink);
+            if (asyncMode && asyncQueue) {
+                sinkWorkers.emplace_back(new LogSinkWorker(sink));
+            }
+        }
+    }
+    
+    void removeSink(const std::shared_ptr<LogSink>& sink) {
+        if (!sink) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(logMutex);
+        for (size_t i = 0; i < sinkWorkers.size(); ++i) {
+            if (sinkWorkers[i]->sink() == sink) {
+                // 写出已投递的日志后停止写线程
+                sinkWorkers.erase(sinkWorkers.begin() + i);
+                break;
+            }
+        }
+        sink->flush();
+        sinks.erase(std::remove(sinks.begin(), sinks.end(), sink), sinks.end());
+    }
+    
+    void clearSinks() {
+        std::lock_guard<std::mutex> lock(logMutex);
+        sinkWorkers.clear();
+        for (const auto& sink : sinks) {
+            sink->flush();
+        }
+        sinks.clear();
+        defaultSinks.clear();
+    }
+    
+    void shutdown() {
+        // 关闭异步队列：在锁内取出后于锁外停止，工作线程排空剩余日志时仍要经processLogEntries获取logMutex
+        AsyncLogQueue* queue = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            queue = asyncQueue;
             asyncQueue = nullptr;
         }
+        if (queue) {
+            queue->stop();
+            delete queue;
+        }
         
-        // 关闭文件流
-        if (fileStream) {
-            fileStream->close();
-            delete fileStream;
-            fileStream = nullptr;
+        std::lock_guard<std::mutex> lock(logMutex);
+        
+        // 写出并释放全部输出目标（写线程先写完已投递的日志，文件输出目标在析构时关闭）
+        sinkWorkers.clear();
+        for (const auto& sink : sinks) {
+            sink->flush();
         }
+        sinks.clear();
+        defaultSinks.clear();
         
         isInit = false;
         asyncMode = false;
     }
     
     bool flush(int timeoutMs = -1) {
+        bool flushed = true;
         if (asyncMode && asyncQueue) {
-            return asyncQueue->flush(timeoutMs);
+            flushed = asyncQueue->flush(timeoutMs);
         }
         
-        // 同步模式下也尝试刷新文件流
+        // 等待各写线程写完已投递的日志，并将输出目标中仍缓冲在进程内的数据交给操作系统（none策略下由此写出）
         std::lock_guard<std::mutex> lock(logMutex);
-        if (fileStream) {
-            fileStream->flush();
+        if (!sinkWorkers.empty()) {
+            for (const auto& worker : sinkWorkers) {
+                flushed = worker->flush(timeoutMs) && flushed;
+            }
+        } else {
+            for (const auto& sink : sinks) {
+                sink->flush();
+            }
+        }
+        return flushed;
+    }
+    
+    uint64_t getDurabilityTicket() const {
+        if (asyncMode && asyncQueue) {
+            return asyncQueue->lastSequence();
+        }
+        return syncTicket;
+    }
+    
+    // 组提交：先等待凭据之前的日志交给输出目标，再由一个领头线程为此刻已交给输出目标的全部日志落盘一次，
+    // 落盘期间到达的线程等待本次结果，本次未覆盖时由其中一个发起下一次落盘
+    bool waitDurable(uint64_t ticket, int timeoutMs) {
+        if (!isInit) {
+            return false;
+        }
+        
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        {
+            std::lock_guard<std::mutex> lock(durableMutex);
+            ++durableWaits;
+        }
+        // 重新init之前取得的凭据可能超出当前的序号
+        ticket = std::min(ticket, currentSequence());
+        if (ticket == 0) {
+            return true;
+        }
+        
+        // 异步模式下等待工作线程处理到该凭据（已投递给各写线程）
+        if (asyncMode && asyncQueue && !asyncQueue->waitProcessed(ticket, timeoutMs)) {
+            return false;
+        }
+        
+        std::unique_lock<std::mutex> lock(durableMutex);
+        while (durableSequence < ticket) {
+            if (!durableSyncing) {
+                durableSyncing = true;
+                uint64_t target = processedSequence();
+                lock.unlock();
+                bool synced = syncSinks(remainingMs(timeoutMs, deadline));
+                lock.lock();
+                durableSyncing = false;
+                ++durableSyncs;
+                if (synced && target > durableSequence) {
+                    durableSequence = target;
+                }
+                durableReady.notify_all();
+                if (!synced) {
+                    return false;
+                }
+                continue;
+            }
+            
+            // 等待正在进行的落盘
+            if (timeoutMs < 0) {
+                durableReady.wait(lock);
+            } else if (durableReady.wait_until(lock, deadline) == std::cv_status::timeout &&
+                       durableSequence < ticket) {
+                return false;
+            }
         }
         return true;
     }
     
+    bool flushDurable(int timeoutMs) {
+        return waitDurable(currentSequence(), timeoutMs);
+    }
+    
     bool isAsyncModeEnabled() const {
         return asyncMode;
     }
@@ -258,6 +559,9 @@ public:
         if (asyncMode && asyncQueue) {
             asyncQueue->resetStats();
         }
+        std::lock_guard<std::mutex> lock(durableMutex);
+        durableWaits = 0;
+        durableSyncs = 0;
     }
     
     Stats getStats() const {
@@ -269,72 +573,324 @@ public:
             Stats result;
             result.totalLogEntries = queueStats.totalEnqueued;
             result.droppedEntries = queueStats.totalDropped;
-            // 注意：AsyncLogQueue::Stats没有totalOverflows字段
+            result.queueOverflows = queueStats.totalOverflows;
+            std::copy(std::begin(queueStats.droppedByLevel), std::end(queueStats.droppedByLevel),
+                      std::begin(result.droppedByLevel));
+            result.spilledEntries = queueStats.spilledEntries;
+            result.spillBytes = queueStats.spilledBytes;
+            result.totalSpillNanos = queueStats.totalSpillNanos;
+            result.maxSpillNanos = queueStats.maxSpillNanos;
+            result.spillDrainedEntries = queueStats.drainedEntries;
+            result.spillDrainNanos = queueStats.totalDrainNanos;
+            result.expeditedEntries = queueStats.expeditedEntries;
+            result.expediteMisses = queueStats.expediteMisses;
+            result.producerWakeups = queueStats.producerWakeups;
+            result.consumerParks = queueStats.consumerParks;
             result.totalAllocations = queueStats.totalAllocations;
             result.totalDeallocations = queueStats.totalDeallocations;
             result.peakPoolSize = queueStats.peakPoolSize;
             result.currentPoolSize = queueStats.currentPoolSize;
             result.threadCacheHits = queueStats.tlsCacheHits;
-            // 注意：AsyncLogQueue::Stats没有tlsCacheMisses和batchOperations字段
+            result.threadCacheMisses = queueStats.totalAllocations > queueStats.tlsCacheHits ?
+                queueStats.totalAllocations - queueStats.tlsCacheHits : 0;
+            result.batchOperations = queueStats.batchOperations;
+            result.batchSize = queueStats.batchLimit;
+            result.batchesPerSecond = queueStats.batchesPerSecond;
+            fillDurableStats(result);
             
             return result;
         }
-        return Stats(); // 返回默认统计数据
+        Stats result; // 返回默认统计数据
+        fillDurableStats(result);
+        return result;
     }
     
 private:
     LogLevel logLevel;
-    std::ofstream* fileStream;
     bool isInit;
     bool asyncMode;
     AsyncLogQueue* asyncQueue;
     std::mutex logMutex;
+    TimestampFormatter timestampFormatter;  // 按秒缓存前缀的时间戳格式化器（在logMutex保护下使用）
+    LogOutputBuffer outputBuffer;           // 可复用的整批输出缓冲区（在logMutex保护下使用）
+    std::vector<std::shared_ptr<LogSink>> sinks;        // 输出目标（在logMutex保护下使用）
+    std::vector<std::shared_ptr<LogSink>> defaultSinks; // 由init创建的输出目标，重新init时替换
+    std::vector<std::unique_ptr<LogSinkWorker>> sinkWorkers; // 异步模式下每个输出目标的写线程
+    LogLevel sinkMinLevel;                  // 文本输出目标中的最低级别，低于它的日志不格式化
+    LogLevel binarySinkMinLevel;            // 二进制输出目标中的最低级别，低于它的日志不编码
+    std::vector<LogLine> outputLines;       // 缓冲区中每行的位置与级别
+    LogLevel outputMinLevel;                // 缓冲区中的最低级别
+    LogLevel outputMaxLevel;                // 缓冲区中的最高级别
+    LogOutputBuffer binaryBuffer;           // 交给二进制输出目标的整批记录（在logMutex保护下使用）
+    std::vector<LogLine> binaryLines;       // 二进制缓冲区中每条记录的位置与级别
+    LogLevel binaryMinLevel;                // 二进制缓冲区中的最低级别
+    LogLevel binaryMaxLevel;                // 二进制缓冲区中的最高级别
+    LogLevel priorityLevel;                 // 异步模式下经优先级通道提前输出的最低级别（off表示不启用）
+    PriorityOrdering priorityOrdering;      // 优先级通道的输出顺序
     
-    // 格式化并写入日志到输出目标
-    void writeLogToOutputs(const LogEntry& entry) {
-        // 获取当前时间
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-        std::tm local_tm;
-        localtime_s(&local_tm, &now_time);
+    // 同步模式下延迟格式化使用的线程本地条目
+    static thread_local LogEntry syncDeferredEntry;
+    
+    // 落盘凭据相关：异步模式下凭据为队列序号，同步模式下为写出的日志条数
+    std::atomic<uint64_t> syncSequence;     // 同步模式下已写出的日志条数（在logMutex保护下递增）
+    static thread_local uint64_t syncTicket; // 同步模式下调用线程最近一次写出的日志的凭据
+    mutable std::mutex durableMutex;
+    std::condition_variable durableReady;   // 一次落盘完成
+    uint64_t durableSequence;               // 已落盘的凭据（在durableMutex保护下使用，下同）
+    bool durableSyncing;                    // 是否有线程正在落盘
+    size_t durableWaits;
+    size_t durableSyncs;
+    
+    // 已交给输出目标的凭据
+    uint64_t processedSequence() const {
+        if (asyncMode && asyncQueue) {
+            return asyncQueue->processedSequence();
+        }
+        return syncSequence.load(std::memory_order_acquire);
+    }
+    
+    // 此刻之前记录的全部日志都不超过的凭据
+    uint64_t currentSequence() const {
+        if (asyncMode && asyncQueue) {
+            return asyncQueue->currentSequence();
+        }
+        return syncSequence.load(std::memory_order_acquire);
+    }
+    
+    // 所有输出目标落盘：异步模式下由各写线程写完已投递的日志后调用sync
+    bool syncSinks(int timeoutMs) {
+        bool synced = true;
+        std::lock_guard<std::mutex> lock(logMutex);
+        if (!sinkWorkers.empty()) {
+            for (const auto& worker : sinkWorkers) {
+                synced = worker->sync(timeoutMs) && synced;
+            }
+        } else {
+            for (const auto& sink : sinks) {
+                synced = sink->sync() && synced;
+            }
+        }
+        return synced;
+    }
+    
+    // 截止时刻前剩余的毫秒数，timeoutMs为-1时保持无限等待
+    static int remainingMs(int timeoutMs, std::chrono::steady_clock::time_point deadline) {
+        if (timeoutMs < 0) {
+            return -1;
+        }
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        return left.count() > 0 ? (int)left.count() : 0;
+    }
+    
+    // 重新init时凭据从0开始（调用者持有logMutex）
+    void resetDurable() {
+        std::lock_guard<std::mutex> lock(durableMutex);
+        syncSequence.store(0, std::memory_order_release);
+        durableSequence = 0;
+    }
+    
+    void fillDurableStats(Stats& result) const {
+        std::lock_guard<std::mutex> lock(durableMutex);
+        result.durableWaits = durableWaits;
+        result.durableSyncs = durableSyncs;
+    }
+    
+    // 延迟格式化的条目：按格式字符串解码参数，并将结果写回消息缓冲区
+    static void materializeMessage(LogEntry& entry) {
+        if (!entry.format) {
+            return;
+        }
+        char formatted[LOG_MESSAGE_BUFFER_SIZE];
+        size_t len = formatLogArgs(entry.format, entry.message, entry.messageLen, formatted, sizeof(formatted));
+        memcpy(entry.message, formatted, len + 1);
+        entry.messageLen = len;
+        entry.format = nullptr;
+    }
+    
+    // 创建init的默认输出目标：文件路径非空时添加文件输出目标（配置了轮转时为轮转文件输出目标，
+    // mappedWindowBytes非0时以内存映射方式写入，overlappedWrites非0时以重叠I/O方式写入，
+    // directPreallocateBytes非0时以无缓冲方式写入），
+    // 尚未注册任何输出目标时添加控制台输出目标（调用者持有logMutex）
+    bool addDefaultSinks(const char* logFilePath, DurabilityPolicy durability, int syncIntervalMs,
+                         size_t syncIntervalBytes, const RotationConfig& rotation, size_t mappedWindowBytes,
+                         size_t overlappedWrites, size_t directPreallocateBytes) {
+        // 重复init时替换上一次创建的默认输出目标
+        for (const auto& sink : defaultSinks) {
+            sinks.erase(std::remove(sinks.begin(), sinks.end(), sink), sinks.end());
+        }
+        defaultSinks.clear();
         
-        // 格式化时间
-        char timeStr[64];
-        strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &local_tm);
+        bool addConsole = sinks.empty();
+        if (logFilePath) {
+            if (rotation.enabled()) {
+                std::shared_ptr<RotatingFileLogSink> fileSink = std::make_shared<RotatingFileLogSink>(
+                    logFilePath, rotation, LogLevel::trace, durability, syncIntervalMs, syncIntervalBytes,
+                    mappedWindowBytes, overlappedWrites, directPreallocateBytes);
+                if (!fileSink->isOpen()) {
+                    return false;
+                }
+                defaultSinks.push_back(fileSink);
+            } else {
+                std::shared_ptr<FileLogSink> fileSink = std::make_shared<FileLogSink>(
+                    logFilePath, LogLevel::trace, durability, syncIntervalMs, syncIntervalBytes, mappedWindowBytes,
+                    overlappedWrites, directPreallocateBytes);
+                if (!fileSink->isOpen()) {
+                    return false;
+                }
+                defaultSinks.push_back(fileSink);
+            }
+        }
+        if (addConsole) {
+            defaultSinks.push_back(std::make_shared<ConsoleLogSink>());
+        }
+        sinks.insert(sinks.end(), defaultSinks.begin(), defaultSinks.end());
+        return true;
+    }
+    
+    // 按编码分别重新计算输出目标中的最低级别，输出目标的级别可能随时被修改，每批开始时调用（调用者持有logMutex）
+    void updateSinkMinLevel() {
+        sinkMinLevel = LogLevel::off;
+        binarySinkMinLevel = LogLevel::off;
+        for (const auto& sink : sinks) {
+            LogLevel& minLevel = sink->encoding() == LogSinkEncoding::binary ? binarySinkMinLevel : sinkMinLevel;
+            minLevel = std::min(minLevel, sink->getLevel());
+        }
+    }
+    
+    // 将一条日志追加到对应编码的缓冲区：二进制输出目标直接接收未格式化的记录，
+    // 只有文本输出目标需要时才做延迟格式化（调用者持有logMutex）
+    void appendEntry(LogEntry& entry) {
+        if (entry.level >= binarySinkMinLevel) {
+            appendToBinaryBuffer(entry);
+        }
+        if (entry.level >= sinkMinLevel) {
+            materializeMessage(entry);
+            appendToOutputBuffer(entry);
+        }
+    }
+    
+    // 将一条日志按BinaryEntryHeader追加到二进制缓冲区，不做格式化（调用者持有logMutex）
+    void appendToBinaryBuffer(const LogEntry& entry) {
+        size_t lineStart = binaryBuffer.size();
         
-        // 获取毫秒
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+        BinaryEntryHeader header;
+        // 时间戳在此换算为墙上时间，与文本输出使用同一组换算参数（工作线程随后可能重新建立对应关系）
+        header.timestamp = static_cast<uint64_t>(entry.timestamp != 0 ? LogClock::toEpochNanos(entry.timestamp) :
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        header.format = entry.format;
+        header.siteId = entry.siteId;
+        header.line = entry.siteId == 0 && entry.line > 0 ? static_cast<uint32_t>(entry.line) : 0;
+        header.messageLen = static_cast<uint16_t>(entry.messageLen);
+        header.fileLen = entry.siteId == 0 ? static_cast<uint16_t>(entry.fileLen) : 0;
+        binaryBuffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        binaryBuffer.append(entry.message, header.messageLen);
+        binaryBuffer.append(entry.file, header.fileLen);
         
-        // 获取日志级别字符串
-        const char* levelStr = getLevelString(entry.level);
+        LogLine line;
+        line.offset = lineStart;
+        line.length = binaryBuffer.size() - lineStart;
+        line.level = entry.level;
+        binaryLines.push_back(line);
+        binaryMinLevel = std::min(binaryMinLevel, entry.level);
+        binaryMaxLevel = std::max(binaryMaxLevel, entry.level);
+    }
+    
+    // 将一条日志追加到输出缓冲区（调用者持有logMutex）
+    void appendToOutputBuffer(const LogEntry& entry) {
+        // 没有任何输出目标需要的日志不做格式化
+        if (entry.level < sinkMinLevel) {
+            return;
+        }
+        size_t lineStart = outputBuffer.size();
         
-        // 构建完整日志行
-        std::stringstream logStream;
-        logStream << "[" << timeStr << "." << std::setw(3) << std::setfill('0') << ms.count() << "] [" << levelStr << "] ";
+        // 格式化调用点取得的时间（同一秒内只复制缓存的前缀并写入小数部分），
+        // 没有时间戳的条目使用当前时间
+        char timeStr[TIMESTAMP_BUFFER_SIZE];
+        size_t timeLen;
+        if (entry.timestamp != 0) {
+            timeLen = timestampFormatter.format(LogClock::toEpochNanos(entry.timestamp), timeStr);
+        } else {
+            timeLen = timestampFormatter.format(std::chrono::system_clock::now(), timeStr);
+        }
         
-        // 添加文件名和行号（如果有）
-        if (entry.fileLen > 0 && entry.line > 0) {
-            logStream << "(" << entry.file << ":" << entry.line << ") ";
+        // 文件名和行号（如果有），调用点日志从登记表中取得
+        const LogSite* site = entry.siteId ? LogSiteRegistry::find(entry.siteId) : nullptr;
+        if (site && site->line > 0) {
+            outputBuffer.appendLine(timeStr, timeLen, entry.level, site->file, strlen(site->file), site->line,
+                                    entry.message, entry.messageLen);
+        } else {
+            outputBuffer.appendLine(timeStr, timeLen, entry.level, entry.file, entry.fileLen, entry.line,
+                                    entry.message, entry.messageLen);
         }
         
-        // 添加日志消息
-        logStream << entry.message << std::endl;
+        // 记录行的位置与级别，供各输出目标按自己的级别过滤
+        LogLine line;
+        line.offset = lineStart;
+        line.length = outputBuffer.size() - lineStart;
+        line.level = entry.level;
+        outputLines.push_back(line);
+        outputMinLevel = std::min(outputMinLevel, entry.level);
+        outputMaxLevel = std::max(outputMaxLevel, entry.level);
+    }
+    
+    // 将文本与二进制缓冲区中的整批日志交给对应编码、级别在[minSinkLevel, maxSinkLevel]之间的输出目标，
+    // 异步模式下交给各自的写线程（调用者持有logMutex）
+    void writeOutputBuffer(LogLevel minSinkLevel = LogLevel::trace, LogLevel maxSinkLevel = LogLevel::off) {
+        if (outputLines.empty() && binaryLines.empty()) {
+            return;
+        }
         
-        std::string logLine = logStream.str();
+        LogBatch textBatch;
+        textBatch.data = outputBuffer.data();
+        textBatch.size = outputBuffer.size();
+        textBatch.lines = outputLines.data();
+        textBatch.count = outputLines.size();
+        textBatch.minLevel = outputMinLevel;
+        textBatch.maxLevel = outputMaxLevel;
         
-        // 输出到文件
-        if (fileStream) {
-            *fileStream << logLine;
-            fileStream->flush();
-        }
+        LogBatch binaryBatch;
+        binaryBatch.data = binaryBuffer.data();
+        binaryBatch.size = binaryBuffer.size();
+        binaryBatch.lines = binaryLines.data();
+        binaryBatch.count = binaryLines.size();
+        binaryBatch.minLevel = binaryMinLevel;
+        binaryBatch.maxLevel = binaryMaxLevel;
         
-        // 输出到控制台
-        if (entry.level >= LogLevel::warn) {
-            // 警告和错误输出到stderr
-            std::cerr << logLine;
+        if (!sinkWorkers.empty()) {
+            // 异步模式：复制到各写线程的缓冲区后立即返回
+            for (const auto& worker : sinkWorkers) {
+                const LogBatch& batch = worker->sink()->encoding() == LogSinkEncoding::binary ? binaryBatch : textBatch;
+                LogLevel sinkLevel = worker->sink()->getLevel();
+                if (batch.count > 0 && sinkLevel >= minSinkLevel && sinkLevel <= maxSinkLevel) {
+                    worker->post(batch);
+                }
+            }
         } else {
-            std::cout << logLine;
+            for (const auto& sink : sinks) {
+                const LogBatch& batch = sink->encoding() == LogSinkEncoding::binary ? binaryBatch : textBatch;
+                LogLevel sinkLevel = sink->getLevel();
+                if (batch.count > 0 && sinkLevel >= minSinkLevel && sinkLevel <= maxSinkLevel) {
+                    sink->submit(batch);
+                }
+            }
         }
+        
+        outputBuffer.clear();
+        outputLines.clear();
+        outputMinLevel = LogLevel::off;
+        outputMaxLevel = LogLevel::trace;
+        binaryBuffer.clear();
+        binaryLines.clear();
+        binaryMinLevel = LogLevel::off;
+        binaryMaxLevel = LogLevel::trace;
+    }
+    
+    // 格式化并写入日志到输出目标
+    void writeLogToOutputs(LogEntry& entry) {
+        updateSinkMinLevel();
+        appendEntry(entry);
+        writeOutputBuffer();
     }
     
     // 兼容旧接口的重载版本
@@ -344,34 +900,57 @@ private:
     }
     
     // 处理日志条目批次（异步模式下使用）
-    void processLogEntries(const std::vector<LogEntry>& entries) {
+    void processLogEntries(const std::vector<LogEntry*>& entries) {
+        // 异步模式下只有工作线程使用logMutex，延迟格式化放在锁内，按输出目标的编码决定是否需要
         std::lock_guard<std::mutex> lock(logMutex);
         
-        for (const auto& entry : entries) {
-            writeLogToOutputs(entry);
+        // 整批日志依次追加到同一个缓冲区，格式化一次后交给所有文本输出目标，二进制输出目标只接收编码后的记录
+        updateSinkMinLevel();
+        // 带expedited标记的条目已提前交给优先级输出目标：relaxed顺序下（或优先级阈值为trace时）即所有输出目标，直接跳过
+        bool perSink = priorityOrdering == PriorityOrdering::perSink && priorityLevel > LogLevel::trace;
+        bool hasExpedited = false;
+        for (LogEntry* entry : entries) {
+            if (entry->expedited) {
+                hasExpedited = true;
+                if (!perSink) {
+                    continue;
+                }
+            }
+            appendEntry(*entry);
+        }
+        if (!hasExpedited || !perSink) {
+            writeOutputBuffer();
+            return;
+        }
+        
+        // perSink顺序：整批按入队顺序交给级别低于优先级阈值的输出目标；优先级输出目标只补发
+        // 优先级通道已满时未能提前输出的条目（通常没有）
+        LogLevel belowPriority = static_cast<LogLevel>(static_cast<int>(priorityLevel) - 1);
+        writeOutputBuffer(LogLevel::trace, belowPriority);
+        for (LogEntry* entry : entries) {
+            if (!entry->expedited && entry->level >= priorityLevel) {
+                appendEntry(*entry);
+            }
         }
+        writeOutputBuffer(priorityLevel);
     }
     
-    const char* getLevelString(LogLevel level) {
-        switch (level) {
-            case LogLevel::trace:
-                return "TRACE";
-            case LogLevel::debug:
-                return "DEBUG";
-            case LogLevel::info:
-                return "INFO";
-            case LogLevel::warn:
-                return "WARN";
-            case LogLevel::error:
-                return "ERROR";
-            case LogLevel::critical:
-                return "CRITICAL";
-            default:
-                return "UNKNOWN";
+    // 处理优先级通道的日志：perSink顺序下只交给级别不低于优先级阈值的输出目标，这些输出目标不接收更低级别的日志，
+    // 提前收到不会打乱其中的顺序；relaxed顺序下交给所有输出目标
+    void processPriorityEntries(const std::vector<LogEntry*>& entries) {
+        std::lock_guard<std::mutex> lock(logMutex);
+        
+        updateSinkMinLevel();
+        for (LogEntry* entry : entries) {
+            appendEntry(*entry);
         }
+        writeOutputBuffer(priorityOrdering == PriorityOrdering::perSink ? priorityLevel : LogLevel::trace);
     }
 };
 
+thread_local LogEntry WinLog::Impl::syncDeferredEntry;
+thread_local uint64_t WinLog::Impl::syncTicket = 0;
+
 // WinLog类的实现
 WinLog::WinLog() : pImpl(new Impl()) {}
 
@@ -399,12 +978,23 @@ bool WinLog::flush(int timeoutMs) {
     return pImpl->flush(timeoutMs);
 }
 
+uint64_t WinLog::getDurabilityTicket() const {
+    return pImpl->getDurabilityTicket();
+}
+
+bool WinLog::waitDurable(uint64_t ticket, int timeoutMs) {
+    return pImpl->waitDurable(ticket, timeoutMs);
+}
+
+bool WinLog::flushDurable(int timeoutMs) {
+    return pImpl->flushDurable(timeoutMs);
+}
+
 void WinLog::setAsyncConfig(const AsyncConfig& config) {
     std::lock_guard<std::mutex> lock(globalWinLogMutex);
     asyncConfig = config;
     
-    // 更新AsyncLogQueue的静态配置
-    AsyncLogQueue::setDropOnOverflow(config.dropOnOverflow);
+    // 更新AsyncLogQueue的静态配置（溢出策略按队列配置，由init创建队列时取自AsyncConfig）
     AsyncLogQueue::setFlushIntervalMs(config.flushIntervalMs);
 }
 
@@ -467,10 +1057,91 @@ void WinLog::critical(const char* format, ...) {
     va_end(args);
 }
 
+void WinLog::logv(LogLevel level, const char* format, va_list args) {
+    pImpl->log(level, format, args);
+}
+
+bool WinLog::logBatch(LogEntryBatch& batch) {
+    return pImpl->logBatch(batch.entries_);
+}
+
+LogEntry* WinLog::allocateBatchEntry(LogLevel level) {
+    return pImpl->allocateBatchEntry(level);
+}
+
+void WinLog::freeBatchEntries(std::vector<LogEntry*>& entries) {
+    pImpl->freeBatchEntries(entries);
+}
+
+// LogEntryBatch 实现
+LogEntryBatch::LogEntryBatch(WinLog& log) : log_(log) {
+}
+
+LogEntryBatch::~LogEntryBatch() {
+    clear();
+}
+
+void LogEntryBatch::add(LogLevel level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    addv(level, format, args);
+    va_end(args);
+}
+
+void LogEntryBatch::addv(LogLevel level, const char* format, va_list args) {
+    LogEntry* entry = beginEntry(level, nullptr);
+    if (entry) {
+        entry->formatMessage(format, args);
+    }
+}
+
+LogEntry* LogEntryBatch::beginEntry(LogLevel level, const char* format) {
+    LogEntry* entry = log_.allocateBatchEntry(level);
+    if (entry) {
+        entry->format = format;
+        entries_.push_back(entry);
+    }
+    return entry;
+}
+
+void LogEntryBatch::clear() {
+    if (!entries_.empty()) {
+        log_.freeBatchEntries(entries_);
+    }
+}
+
+LogEntry* WinLog::beginSite(const LogSite* site) {
+    return pImpl->beginSite(site);
+}
+
+LogEntry* WinLog::beginDeferred(LogLevel level, const char* format) {
+    return pImpl->beginDeferred(level, format);
+}
+
+void WinLog::commitDeferred(LogEntry* entry) {
+    pImpl->commitDeferred(entry);
+}
+
 void WinLog::setLevel(LogLevel level) {
     pImpl->setLevel(level);
 }
 
+void WinLog::setTimestampFormat(TimestampPrecision precision, TimestampZone zone) {
+    pImpl->setTimestampFormat(precision, zone);
+}
+
+void WinLog::addSink(const std::shared_ptr<LogSink>& sink) {
+    pImpl->addSink(sink);
+}
+
+void WinLog::removeSink(const std::shared_ptr<LogSink>& sink) {
+    pImpl->removeSink(sink);
+}
+
+void WinLog::clearSinks() {
+    pImpl->clearSinks();
+}
+
 void WinLog::shutdown() {
     std::lock_guard<std::mutex> lock(globalWinLogMutex);
     pImpl->shutdown();
@@ -505,42 +1176,42 @@ unsigned int WinLog::getVersionNumber() {
 void logTrace(const char* format, ...) {
     va_list args;
     va_start(args, format);
-    WinLog::getInstance().trace(format, args);
+    WinLog::getInstance().logv(LogLevel::trace, format, args);
     va_end(args);
 }
 
 void logDebug(const char* format, ...) {
     va_list args;
     va_start(args, format);
-    WinLog::getInstance().debug(format, args);
+    WinLog::getInstance().logv(LogLevel::debug, format, args);
     va_end(args);
 }
 
 void logInfo(const char* format, ...) {
     va_list args;
     va_start(args, format);
-    WinLog::getInstance().info(format, args);
+    WinLog::getInstance().logv(LogLevel::info, format, args);
     va_end(args);
 }
 
 void logWarn(const char* format, ...) {
     va_list args;
     va_start(args, format);
-    WinLog::getInstance().warn(format, args);
+    WinLog::getInstance().logv(LogLevel::warn, format, args);
     va_end(args);
 }
 
 void logError(const char* format, ...) {
     va_list args;
     va_start(args, format);
-    WinLog::getInstance().error(format, args);
+    WinLog::getInstance().logv(LogLevel::error, format, args);
     va_end(args);
 }
 
 void logCritical(const char* format, ...) {
     va_list args;
     va_start(args, format);
-    WinLog::getInstance().critical(format, args);
+    WinLog::getInstance().logv(LogLevel::critical, format, args);
     va_end(args);
 }
 
@@ -4,7 +4,52 @@
 #include <chrono>
 #include <iomanip>
 #include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdarg>
+#include <string>
+#include <sstream>
+#include <ctime>
+#include <fstream>
+#include <Windows.h>
 #include "../include/winlog.h"
+#include "../include/async_log_queue.h"
+#include "../include/log_output_buffer.h"
+#include "../include/log_file.h"
+#include "../include/log_sink.h"
+#include "../include/rotating_file_sink.h"
+#include "../include/log_compressor.h"
+#include "../include/binary_log_sink.h"
+#include "../include/binary_log_decoder.h"
+#include <cstdlib>
+#include <new>
+
+// 统计本程序中全局operator new的调用次数，用于验证输出路径在稳定状态下不分配堆内存
+static std::atomic<size_t> globalNewCount(0);
+
+// 替换函数禁止内联，避免编译器把内联后的free与operator new误判为不匹配
+#ifdef __GNUC__
+#define TEST_NOINLINE __attribute__((noinline))
+#else
+#define TEST_NOINLINE __declspec(noinline)
+#endif
+
+TEST_NOINLINE void* operator new(size_t size) {
+    globalNewCount.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+TEST_NOINLINE void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+TEST_NOINLINE void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
 
 // Test basic asynchronous logging functionality
 void testBasicAsyncLogging() {
@@ -335,6 +380,2841 @@ void testMemoryPoolPerformance() {
     WinLog::getInstance().flush();
 }
 
+// 队列引擎名称
+static const char* engineName(QueueEngine engine) {
+    switch (engine) {
+        case QueueEngine::mutex:
+            return "mutex";
+        case QueueEngine::lockFree:
+            return "lockFree";
+        case QueueEngine::recordRing:
+            return "recordRing";
+        case QueueEngine::perThreadLanes:
+            return "lanes";
+        default:
+            return "unknown";
+    }
+}
+
+// 计算已排序延迟样本的百分位数（纳秒）
+static long long percentileNs(const std::vector<long long>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+// Queue contention benchmark - mutex queue vs lock-free MPSC ring
+void testQueueContentionBenchmark() {
+    std::cout << "\n=== Queue Contention Benchmark: mutex vs lockFree vs lanes ===" << std::endl;
+    
+    const int TOTAL_ENTRIES = 64000;
+    const int threadCounts[] = {1, 4, 16, 64};
+    const QueueEngine engines[] = {QueueEngine::mutex, QueueEngine::lockFree, QueueEngine::perThreadLanes};
+    const char* message = "Queue contention benchmark message";
+    const size_t messageLen = strlen(message);
+    
+    std::cout << std::left << std::setw(10) << "engine" << std::setw(9) << "threads"
+              << std::setw(14) << "entries/s" << std::setw(10) << "p50(ns)"
+              << std::setw(10) << "p99(ns)" << std::setw(10) << "p999(ns)" << "dropped" << std::endl;
+    
+    for (QueueEngine engine : engines) {
+        for (int numThreads : threadCounts) {
+            AsyncConfig config;
+            config.queueSize = 65536;
+            config.maxBatchSize = 1000;
+            config.memoryPoolSize = 0;
+            config.dropOnOverflow = false;
+            config.flushIntervalMs = 100;
+            config.queueEngine = engine;
+            
+            AsyncLogQueue queue(config);
+            queue.setLogHandler([](const std::vector<LogEntry*>&) {});
+            
+            const int perThread = TOTAL_ENTRIES / numThreads;
+            std::vector<std::vector<long long>> latencies(numThreads);
+            std::vector<std::thread> producers;
+            std::atomic<bool> go(false);
+            
+            for (int t = 0; t < numThreads; ++t) {
+                producers.emplace_back([&, t]() {
+                    std::vector<long long>& samples = latencies[t];
+                    samples.reserve(perThread);
+                    while (!go.load()) {
+                        std::this_thread::yield();
+                    }
+                    for (int i = 0; i < perThread; ++i) {
+                        // 生产者侧完整开销：从内存池取条目、写入消息、交接指针
+                        auto begin = std::chrono::steady_clock::now();
+                        LogEntry* entry = queue.allocateEntry();
+                        entry->level = LogLevel::info;
+                        entry->setMessage(message, messageLen);
+                        queue.enqueue(entry);
+                        auto end = std::chrono::steady_clock::now();
+                        samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+                    }
+                });
+            }
+            
+            auto start = std::chrono::steady_clock::now();
+            go = true;
+            for (auto& t : producers) {
+                t.join();
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            queue.flush(1000);
+            queue.stop();
+            
+            std::vector<long long> all;
+            all.reserve(TOTAL_ENTRIES);
+            for (const auto& samples : latencies) {
+                all.insert(all.end(), samples.begin(), samples.end());
+            }
+            std::sort(all.begin(), all.end());
+            
+            double seconds = std::chrono::duration<double>(elapsed).count();
+            double throughput = seconds > 0 ? all.size() / seconds : 0.0;
+            
+            std::cout << std::left << std::setw(10) << engineName(engine)
+                      << std::setw(9) << numThreads
+                      << std::setw(14) << static_cast<long long>(throughput)
+                      << std::setw(10) << percentileNs(all, 0.50)
+                      << std::setw(10) << percentileNs(all, 0.99)
+                      << std::setw(10) << percentileNs(all, 0.999)
+                      << queue.getStats().totalDropped << std::endl;
+        }
+    }
+    std::cout << std::right;
+}
+
+// Queue storage benchmark - fixed LogEntry slots vs variable-length record ring
+void testQueueStorageBenchmark() {
+    std::cout << "\n=== Queue Storage Benchmark: fixed slots vs recordRing ===" << std::endl;
+    
+    const int LOG_COUNT = 200000;
+    const size_t CACHE_LINE = 64;
+    const QueueEngine engines[] = {QueueEngine::lockFree, QueueEngine::recordRing};
+    
+    std::cout << std::left << std::setw(12) << "engine" << std::setw(14) << "entries/s"
+              << std::setw(14) << "bytes/entry" << std::setw(16) << "lines/message"
+              << "footprint@100k(KB)" << std::endl;
+    
+    for (QueueEngine engine : engines) {
+        AsyncConfig config;
+        config.queueSize = 65536;
+        config.queueBytes = 4 * 1024 * 1024;
+        config.maxBatchSize = 1000;
+        config.memoryPoolSize = 1000;
+        config.flushIntervalMs = 100;
+        config.queueEngine = engine;
+        
+        AsyncLogQueue queue(config);
+        // 消费者读取消息内容，模拟真实的写出路径对缓存的访问
+        std::atomic<size_t> checksum(0);
+        queue.setLogHandler([&checksum](const std::vector<LogEntry*>& entries) {
+            size_t sum = 0;
+            for (const LogEntry* entry : entries) {
+                sum += entry->messageLen + static_cast<unsigned char>(entry->message[0]);
+            }
+            checksum += sum;
+        });
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < LOG_COUNT; ++i) {
+            LogEntry* entry = queue.allocateEntry();
+            entry->level = LogLevel::info;
+            int len = snprintf(entry->message, LOG_MESSAGE_BUFFER_SIZE,
+                               "request %d served in %d us from cache shard %d", i, i % 977, i % 16);
+            entry->messageLen = static_cast<size_t>(len);
+            queue.enqueue(entry);
+        }
+        queue.flush(1000);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        auto stats = queue.getStats();
+        queue.stop();
+        
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        double bytesPerEntry = stats.totalEnqueued > 0 ?
+            static_cast<double>(stats.totalQueueBytes) / stats.totalEnqueued : 0.0;
+        // 消费者每条消息触及的缓存行数（按记录连续排列估算）
+        double linesPerMessage = bytesPerEntry / CACHE_LINE;
+        // 深度为10万条时队列存储占用的内存
+        double footprintKb = bytesPerEntry * 100000 / 1024;
+        
+        std::cout << std::left << std::setw(12) << (engine == QueueEngine::recordRing ? "recordRing" : "fixedSlot")
+                  << std::setw(14) << static_cast<long long>(seconds > 0 ? LOG_COUNT / seconds : 0)
+                  << std::setw(14) << std::fixed << std::setprecision(1) << bytesPerEntry
+                  << std::setw(16) << linesPerMessage
+                  << footprintKb << std::endl;
+    }
+    std::cout << std::right;
+}
+
+// Per-producer lanes test - global timestamp order and lane retirement on thread exit
+void testPerThreadLanesOrdering() {
+    std::cout << "\n=== Per-Thread Lanes Ordering Test ===" << std::endl;
+    
+    AsyncConfig config;
+    config.queueSize = 100000;
+    config.laneSize = 256;  // 小通道，迫使生产者与工作线程频繁交替
+    config.maxBatchSize = 64;
+    config.memoryPoolSize = 1000;
+    config.flushIntervalMs = 100;
+    config.queueEngine = QueueEngine::perThreadLanes;
+    
+    AsyncLogQueue queue(config);
+    uint64_t lastTimestamp = 0;
+    size_t outOfOrder = 0;
+    size_t delivered = 0;
+    queue.setLogHandler([&](const std::vector<LogEntry*>& entries) {
+        for (const LogEntry* entry : entries) {
+            if (entry->timestamp < lastTimestamp) {
+                outOfOrder++;
+            }
+            lastTimestamp = entry->timestamp;
+            delivered++;
+        }
+    });
+    
+    const int NUM_THREADS = 8;
+    const int LOGS_PER_THREAD = 5000;
+    const int ROUNDS = 3;  // 每轮都创建新线程，验证退出线程的通道被安全回收
+    
+    for (int round = 0; round < ROUNDS; ++round) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            threads.emplace_back([&queue, t]() {
+                for (int i = 0; i < LOGS_PER_THREAD; ++i) {
+                    LogEntry* entry = queue.allocateEntry();
+                    entry->level = LogLevel::info;
+                    entry->line = t;
+                    queue.enqueue(entry);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+    
+    queue.flush(2000);
+    auto stats = queue.getStats();
+    queue.stop();
+    
+    size_t expected = static_cast<size_t>(NUM_THREADS) * LOGS_PER_THREAD * ROUNDS;
+    std::cout << "Delivered " << delivered << "/" << expected << " entries, out of order: " << outOfOrder
+              << ", dropped: " << stats.totalDropped << std::endl;
+    
+    // 关闭时的完整性：粗粒度时钟下刚写入的条目与关闭时刻同属一个计数，不经flush直接停止也必须全部输出
+    // （有异步队列在运行时不能切换时钟源）
+    WinLog::getInstance().shutdown();
+    LogClockSource previousSource = LogClock::getSource();
+    LogClock::setSource(LogClockSource::coarse);
+    const int SHUTDOWN_ENTRIES = 2000;
+    size_t shutdownDelivered = 0;
+    {
+        AsyncLogQueue shutdownQueue(config);
+        shutdownQueue.setLogHandler([&](const std::vector<LogEntry*>& entries) {
+            shutdownDelivered += entries.size();
+        });
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t) {
+            threads.emplace_back([&shutdownQueue]() {
+                for (int i = 0; i < SHUTDOWN_ENTRIES / 2; ++i) {
+                    LogEntry* entry = shutdownQueue.allocateEntry();
+                    entry->level = LogLevel::info;
+                    entry->timestamp = LogClock::now();
+                    shutdownQueue.enqueue(entry);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        shutdownQueue.stop();
+    }
+    LogClock::setSource(previousSource);
+    std::cout << "Delivered at shutdown (coarse clock): " << shutdownDelivered << "/" << SHUTDOWN_ENTRIES << std::endl;
+    
+    // 经WinLog关闭：不先flush，队列与各通道中仍积压的日志也要在shutdown中全部交给输出目标
+    std::atomic<size_t> winlogDelivered(0);
+    {
+        // 输出目标缓冲区很小且较慢，积压留在日志队列中
+        std::shared_ptr<CallbackLogSink> slowSink = std::make_shared<CallbackLogSink>(
+            [&winlogDelivered](LogLevel, const char*, size_t) {
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+                winlogDelivered++;
+            });
+        slowSink->setBufferCapacity(1024);
+        WinLog::getInstance().addSink(slowSink);
+        AsyncConfig winlogConfig;
+        winlogConfig.queueEngine = QueueEngine::perThreadLanes;
+        winlogConfig.overflowPolicy = OverflowPolicy::block;
+        WinLog::getInstance().init(nullptr, LogLevel::info, winlogConfig);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t) {
+            threads.emplace_back([]() {
+                for (int i = 0; i < SHUTDOWN_ENTRIES / 2; ++i) {
+                    WinLog::getInstance().info("shutdown drain %d", i);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        WinLog::getInstance().shutdown();
+    }
+    std::cout << "Delivered at WinLog shutdown: " << winlogDelivered.load() << "/" << SHUTDOWN_ENTRIES << std::endl;
+    
+    // isFull按调用线程自己的通道判断：本线程通道写满时为true，其他线程（尚无通道）仍可入队
+    bool fullOk = false;
+    {
+        AsyncConfig fullConfig;
+        fullConfig.queueEngine = QueueEngine::perThreadLanes;
+        fullConfig.laneSize = 16;
+        fullConfig.queueSize = 100000;
+        fullConfig.overflowPolicy = OverflowPolicy::dropNewest;
+        AsyncLogQueue fullQueue(fullConfig);
+        std::atomic<bool> release(false);
+        fullQueue.setLogHandler([&release](const std::vector<LogEntry*>&) {
+            while (!release.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        bool emptyBefore = !fullQueue.isFull();
+        int pushed = 0;
+        for (; pushed < 10000; ++pushed) {
+            LogEntry* entry = fullQueue.allocateEntry();
+            entry->level = LogLevel::info;
+            if (!fullQueue.enqueue(entry)) {
+                break;
+            }
+        }
+        bool ownFull = fullQueue.isFull();
+        bool otherFull = true;
+        std::thread other([&fullQueue, &otherFull]() { otherFull = fullQueue.isFull(); });
+        other.join();
+        release = true;
+        fullQueue.stop();
+        fullOk = emptyBefore && pushed < 10000 && ownFull && !otherFull;
+    }
+    std::cout << "isFull reports the caller's lane: " << (fullOk ? "yes" : "NO") << std::endl;
+    
+    std::cout << (delivered + stats.totalDropped == expected && outOfOrder == 0 &&
+                  shutdownDelivered == static_cast<size_t>(SHUTDOWN_ENTRIES) &&
+                  winlogDelivered == static_cast<size_t>(SHUTDOWN_ENTRIES) && fullOk ?
+                  "Per-thread lanes ordering test passed" : "Per-thread lanes ordering test FAILED") << std::endl;
+}
+
+// va_list路径：经WinLog::logv在调用线程中直接格式化到条目
+static void logInfoVarargs(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    WinLog::getInstance().logv(LogLevel::info, format, args);
+    va_end(args);
+}
+
+// 记录每条日志入队时是否保留了格式字符串：二进制编码的输出目标收到的记录头中带有条目的format指针
+class FormatProbeSink : public LogSink {
+public:
+    LogSinkEncoding encoding() const override {
+        return LogSinkEncoding::binary;
+    }
+    
+    void write(const LogBatch& batch) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < batch.count; ++i) {
+            BinaryEntryHeader header;
+            memcpy(&header, batch.data + batch.lines[i].offset, sizeof(header));
+            deferred_.push_back(header.format != nullptr);
+        }
+    }
+    
+    std::vector<bool> deferred() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return deferred_;
+    }
+    
+private:
+    std::mutex mutex_;
+    std::vector<bool> deferred_;
+};
+
+// 检查延迟格式化的结果与snprintf一致
+template <typename... Args>
+static bool checkDeferredFormat(const char* format, const Args&... args) {
+    char encoded[LOG_MESSAGE_BUFFER_SIZE];
+    LogArgBuffer buffer(encoded, sizeof(encoded));
+    encodeLogArgs(buffer, args...);
+    
+    char deferred[LOG_MESSAGE_BUFFER_SIZE];
+    char expected[LOG_MESSAGE_BUFFER_SIZE];
+    formatLogArgs(format, encoded, buffer.size(), deferred, sizeof(deferred));
+    snprintf(expected, sizeof(expected), format, args...);
+    if (strcmp(deferred, expected) != 0) {
+        std::cout << "  MISMATCH \"" << format << "\": \"" << deferred << "\" != \"" << expected << "\"" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void testDeferredFormatting() {
+    std::cout << "\n=== Deferred Formatting: va_list vs binary arguments ===" << std::endl;
+    
+    // 正确性：延迟格式化的输出必须与调用线程中直接格式化的结果一致
+    bool ok = true;
+    ok &= checkDeferredFormat("request %d served in %u us", -42, 977u);
+    ok &= checkDeferredFormat("%5d|%-5d|%05d|%x|%#X|%o", 7, 7, 7, 255, 255u, 8);
+    ok &= checkDeferredFormat("%lld %llu %ld %hd", -1234567890123LL, 18446744073709551615ULL, 42L, static_cast<short>(-3));
+    ok &= checkDeferredFormat("%.3f %e %g %10.2f", 3.14159, 12345.678, 0.0001, -2.5);
+    ok &= checkDeferredFormat("%s|%10s|%-6s|%.3s|%c|100%%", "abc", "right", "left", "truncate", 'Z');
+    ok &= checkDeferredFormat("%s and %s", std::string("std::string").c_str(), "literal");
+    ok &= checkDeferredFormat("%*d|%-*d|%.*s|%*.*f|end", 6, 42, 4, 7, 3, "truncate", 10, 2, 3.14159);
+    ok &= checkDeferredFormat("%*d|%.*f|%.*s", -5, 9, -1, 2.5, 0, "hidden");
+    std::cout << "格式化结果与snprintf一致: " << (ok ? "yes" : "NO") << std::endl;
+    
+    // 参数按值复制：调用返回后修改原缓冲区不影响输出
+    {
+        char scratch[32] = "before";
+        char encoded[LOG_MESSAGE_BUFFER_SIZE];
+        char out[LOG_MESSAGE_BUFFER_SIZE];
+        LogArgBuffer buffer(encoded, sizeof(encoded));
+        encodeLogArgs(buffer, static_cast<const char*>(scratch), std::string("owned"));
+        strcpy(scratch, "after");
+        formatLogArgs("%s %s", encoded, buffer.size(), out, sizeof(out));
+        std::cout << "字符串参数按值捕获: " << (strcmp(out, "before owned") == 0 ? "yes" : "NO") << std::endl;
+    }
+    
+    // 运行时的格式字符串（可写缓冲区、std::string::c_str()）在调用线程中立即格式化：
+    // 调用返回后改写或释放格式字符串不影响输出，工作线程不再访问它
+    {
+        WinLog::getInstance().shutdown();
+        std::mutex linesMutex;
+        std::vector<std::string> lines;
+        WinLog::getInstance().addSink(std::make_shared<CallbackLogSink>(
+            [&](LogLevel, const char* text, size_t length) {
+                std::lock_guard<std::mutex> lock(linesMutex);
+                lines.emplace_back(text, length);
+            }));
+        AsyncConfig config;
+        config.queueEngine = QueueEngine::lockFree;
+        WinLog::getInstance().init(nullptr, LogLevel::info, config);
+        
+        char buffer[64];
+        strcpy(buffer, "runtime buffer %d %s");
+        WinLog::getInstance().info(buffer, 1, std::string("owned"));
+        strcpy(buffer, "overwritten %d %s!");
+        {
+            std::string format = "runtime string %d %s";
+            WinLog::getInstance().info(format.c_str(), 2, "copied");
+        }
+        WinLog::getInstance().info("literal %d %s", 3, std::string("deferred"));
+        WinLog::getInstance().flush(5000);
+        WinLog::getInstance().shutdown();
+        
+        const char* expected[] = {"runtime buffer 1 owned", "runtime string 2 copied", "literal 3 deferred"};
+        bool runtimeOk = lines.size() == 3;
+        for (size_t i = 0; runtimeOk && i < 3; ++i) {
+            runtimeOk = lines[i].find(expected[i]) != std::string::npos;
+        }
+        std::cout << "运行时格式字符串立即格式化: " << (runtimeOk ? "yes" : "NO") << std::endl;
+        ok &= runtimeOk;
+    }
+    
+    // 公开接口按格式字符串的类型分派：字符串字面量保留格式字符串由工作线程格式化，可写缓冲区在调用线程中格式化
+    {
+        WinLog::getInstance().shutdown();
+        std::shared_ptr<FormatProbeSink> probe = std::make_shared<FormatProbeSink>();
+        WinLog::getInstance().addSink(probe);
+        AsyncConfig config;
+        WinLog::getInstance().init(nullptr, LogLevel::info, config);
+        
+        char buffer[32];
+        strcpy(buffer, "buffer %d");
+        WinLog::getInstance().info("literal %d", 1);
+        WinLog::getInstance().info(buffer, 2);
+        {
+            LogEntryBatch batch;
+            batch.add(LogLevel::info, "batch literal %d", 3);
+            batch.add(LogLevel::info, buffer, 4);
+            WinLog::getInstance().logBatch(batch);
+        }
+        WinLog::getInstance().flush(5000);
+        WinLog::getInstance().shutdown();
+        
+        std::vector<bool> deferred = probe->deferred();
+        bool dispatchOk = deferred.size() == 4 && deferred[0] && !deferred[1] && deferred[2] && !deferred[3];
+        std::cout << "字面量延迟格式化、可写缓冲区立即格式化（info与LogEntryBatch::add）: "
+                  << (dispatchOk ? "yes" : "NO") << std::endl;
+        ok &= dispatchOk;
+    }
+    
+    // 性能：经WinLog的公开接口，只测量调用线程的开销（取条目 + 格式化或编码 + 交接指针）
+    const int LOG_COUNT = 100000;
+    const char* name = "checkout-service";
+    
+    std::cout << std::left << std::setw(10) << "args" << std::setw(16) << "va_list(ns)"
+              << std::setw(16) << "deferred(ns)" << "speedup" << std::endl;
+    
+    for (int argCount : {1, 3, 6}) {
+        double nsPerCall[2] = {0.0, 0.0};
+        for (int deferred = 0; deferred < 2; ++deferred) {
+            WinLog::getInstance().shutdown();
+            // 工作线程完成延迟格式化后交给不做任何事的输出目标
+            WinLog::getInstance().addSink(std::make_shared<CallbackLogSink>([](LogLevel, const char*, size_t) {}));
+            AsyncConfig config;
+            config.queueSize = LOG_COUNT;
+            config.maxBatchSize = 1000;
+            config.memoryPoolSize = 1000;
+            config.flushIntervalMs = 100;
+            config.queueEngine = QueueEngine::lockFree;
+            config.overflowPolicy = OverflowPolicy::block;
+            WinLog::getInstance().init(nullptr, LogLevel::info, config);
+            WinLog& log = WinLog::getInstance();
+            
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < LOG_COUNT; ++i) {
+                double elapsedMs = i * 0.125;
+                if (argCount == 1) {
+                    if (deferred) {
+                        log.info("request %d accepted", i);
+                    } else {
+                        logInfoVarargs("request %d accepted", i);
+                    }
+                } else if (argCount == 3) {
+                    if (deferred) {
+                        log.info("request %d from %s served in %.3f ms", i, name, elapsedMs);
+                    } else {
+                        logInfoVarargs("request %d from %s served in %.3f ms", i, name, elapsedMs);
+                    }
+                } else {
+                    if (deferred) {
+                        log.info("request %d from %s served in %.3f ms status=%u shard=%c bytes=%lld",
+                                 i, name, elapsedMs, 200u, 'a' + i % 26, static_cast<long long>(i) * 1024);
+                    } else {
+                        logInfoVarargs("request %d from %s served in %.3f ms status=%u shard=%c bytes=%lld",
+                                       i, name, elapsedMs, 200u, 'a' + i % 26, static_cast<long long>(i) * 1024);
+                    }
+                }
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            log.flush(10000);
+            log.shutdown();
+            
+            nsPerCall[deferred] = std::chrono::duration<double, std::nano>(elapsed).count() / LOG_COUNT;
+        }
+        
+        std::cout << std::left << std::setw(10) << argCount
+                  << std::setw(16) << std::fixed << std::setprecision(1) << nsPerCall[0]
+                  << std::setw(16) << nsPerCall[1]
+                  << std::setprecision(2) << (nsPerCall[1] > 0 ? nsPerCall[0] / nsPerCall[1] : 0.0) << "x" << std::endl;
+    }
+    std::cout << std::right;
+    std::cout << (ok ? "Deferred formatting test passed" : "Deferred formatting test FAILED") << std::endl;
+}
+
+// 调用点登记表测试：每个调用点只登记一次，可按调用点禁用，输出带文件名和行号
+void testLogSiteRegistry() {
+    std::cout << "\n=== Log Site Registry Test ===" << std::endl;
+    
+    WinLog::getInstance().shutdown();
+    remove("site_log.log");
+    AsyncConfig config;
+    config.queueEngine = QueueEngine::lockFree;
+    config.flushIntervalMs = 100;
+    WinLog::getInstance().init("site_log.log", LogLevel::info, config);
+    
+    // 同一组调用点被反复执行
+    auto logFromSites = []() {
+        WINLOG_INFO("site message %d of %s", 2, "loop");
+        WINLOG_WARN("second site without arguments");
+    };
+    
+    size_t sitesBefore = LogSiteRegistry::count();
+    for (int i = 0; i < 3; ++i) {
+        logFromSites();
+    }
+    size_t sitesAfter = LogSiteRegistry::count();
+    uint32_t firstSiteId = static_cast<uint32_t>(sitesBefore + 1);
+    
+    // 禁用第一个调用点后它不再产生日志，第二个调用点不受影响
+    LogSiteRegistry::setEnabled(firstSiteId, false);
+    WinLog::getInstance().flush(1000);
+    WinLog::getInstance().resetStats();
+    for (int i = 0; i < 3; ++i) {
+        logFromSites();
+    }
+    WinLog::getInstance().flush(1000);
+    size_t enqueuedWhileDisabled = WinLog::getInstance().getStats().totalLogEntries;
+    LogSiteRegistry::setEnabled(firstSiteId, true);
+    WinLog::getInstance().shutdown();
+    
+    const LogSite* site = LogSiteRegistry::find(firstSiteId);
+    bool metadataOk = site && site->level == LogLevel::info && strcmp(site->file, "async_log_test.cpp") == 0 &&
+                      strcmp(site->format, "site message %d of %s") == 0 && site->line > 0;
+    
+    // 输出中应包含工作线程格式化后的消息及调用点的文件名和行号
+    bool outputOk = false;
+    FILE* file = fopen("site_log.log", "r");
+    if (file && site) {
+        char expected[128];
+        snprintf(expected, sizeof(expected), "(async_log_test.cpp:%d) site message 2 of loop", site->line);
+        char line[1024];
+        while (fgets(line, sizeof(line), file)) {
+            if (strstr(line, expected)) {
+                outputOk = true;
+            }
+        }
+    }
+    if (file) {
+        fclose(file);
+    }
+    
+    std::cout << "Sites registered: " << (sitesAfter - sitesBefore) << " (expected 2)" << std::endl;
+    std::cout << "Entries while first site disabled: " << enqueuedWhileDisabled << " (expected 3)" << std::endl;
+    std::cout << "Site metadata: " << (metadataOk ? "ok" : "MISMATCH") << ", file:line output: "
+              << (outputOk ? "ok" : "MISSING") << std::endl;
+    
+    if (sitesAfter - sitesBefore == 2 && enqueuedWhileDisabled == 3 && metadataOk && outputOk) {
+        std::cout << "Log site registry test passed" << std::endl;
+    } else {
+        std::cout << "Log site registry test FAILED" << std::endl;
+    }
+}
+
+// 时间戳格式化基准测试：逐行localtime_s + strftime 与按秒缓存前缀的格式化器
+void testTimestampFormatterBenchmark() {
+    std::cout << "\n=== Timestamp Formatter Benchmark ===" << std::endl;
+    
+    const int COUNT = 1000000;
+    // 模拟约每微秒一条日志，跨越约1秒
+    const int64_t STEP_NS = 997;
+    const int64_t base = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    char out[TIMESTAMP_BUFFER_SIZE];
+    size_t checksum = 0;
+    
+    // 正确性：与localtime_s/gmtime_s + strftime的结果一致
+    bool ok = true;
+    for (int zone = 0; zone < 2; ++zone) {
+        TimestampFormatter formatter(TimestampPrecision::microseconds, static_cast<TimestampZone>(zone));
+        for (int i = 0; i < 1000; ++i) {
+            int64_t nanos = base + static_cast<int64_t>(i) * 7919 * 1000000;
+            std::time_t seconds = static_cast<std::time_t>(nanos / 1000000000);
+            std::tm tm;
+            if (zone == 0) {
+                localtime_s(&tm, &seconds);
+            } else {
+                gmtime_s(&tm, &seconds);
+            }
+            char expected[64];
+            size_t len = strftime(expected, sizeof(expected), "%Y-%m-%d %H:%M:%S", &tm);
+            snprintf(expected + len, sizeof(expected) - len, ".%06d", static_cast<int>(nanos % 1000000000 / 1000));
+            formatter.format(nanos, out);
+            if (strcmp(out, expected) != 0) {
+                std::cout << "  MISMATCH: " << out << " != " << expected << std::endl;
+                ok = false;
+                break;
+            }
+        }
+    }
+    std::cout << "格式化结果与strftime一致: " << (ok ? "yes" : "NO") << std::endl;
+    
+    // 原实现：每行调用localtime_s + strftime，再用iomanip拼接毫秒
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < COUNT; ++i) {
+        int64_t nanos = base + i * STEP_NS;
+        std::time_t seconds = static_cast<std::time_t>(nanos / 1000000000);
+        std::tm tm;
+        localtime_s(&tm, &seconds);
+        char timeStr[64];
+        strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &tm);
+        std::stringstream stream;
+        stream << timeStr << "." << std::setw(3) << std::setfill('0') << (nanos / 1000000 % 1000);
+        checksum += stream.str().size();
+    }
+    double legacyNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / COUNT;
+    
+    std::cout << std::left << std::setw(28) << "method" << "ns/timestamp" << std::endl;
+    std::cout << std::left << std::setw(28) << "localtime_s+strftime" << std::fixed << std::setprecision(1) << legacyNs << std::endl;
+    
+    struct Variant {
+        const char* name;
+        TimestampPrecision precision;
+        TimestampZone zone;
+    };
+    const Variant variants[] = {
+        {"cached local ms", TimestampPrecision::milliseconds, TimestampZone::local},
+        {"cached utc ms", TimestampPrecision::milliseconds, TimestampZone::utc},
+        {"cached local us", TimestampPrecision::microseconds, TimestampZone::local},
+        {"cached local ns", TimestampPrecision::nanoseconds, TimestampZone::local},
+    };
+    for (const Variant& variant : variants) {
+        TimestampFormatter formatter(variant.precision, variant.zone);
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < COUNT; ++i) {
+            checksum += formatter.format(base + i * STEP_NS, out);
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / COUNT;
+        std::cout << std::left << std::setw(28) << variant.name << ns << std::endl;
+    }
+    std::cout << std::right << "(checksum " << checksum << ")" << std::endl;
+}
+
+// 调用点时间戳测试：各时钟源的读取开销与换算精度，以及积压时输出的时间戳仍为调用时刻
+void testCallSiteTimestamps() {
+    std::cout << "\n=== Call-Site Timestamp Test ===" << std::endl;
+    
+    const int COUNT = 1000000;
+    size_t checksum = 0;
+    
+    // 原方式：写出时读取系统时间并做时区转换与格式化
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < COUNT / 10; ++i) {
+        std::time_t seconds = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::tm tm;
+        localtime_s(&tm, &seconds);
+        char timeStr[64];
+        checksum += strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &tm);
+    }
+    double legacyNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (COUNT / 10);
+    
+    std::cout << std::left << std::setw(24) << "clock" << std::setw(16) << "ns/capture"
+              << "mapping error(us)" << std::endl;
+    std::cout << std::left << std::setw(24) << "now+localtime+strftime" << std::fixed << std::setprecision(1)
+              << legacyNs << std::endl;
+    
+    // 有异步队列在运行时不能切换时钟源
+    WinLog::getInstance().shutdown();
+    const LogClockSource sources[] = {LogClockSource::steady, LogClockSource::tsc, LogClockSource::coarse};
+    const char* sourceNames[] = {"steady", "tsc", "coarse"};
+    bool monotonic = true;
+    for (int s = 0; s < 3; ++s) {
+        LogClock::setSource(sources[s]);
+        uint64_t previous = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < COUNT; ++i) {
+            uint64_t ticks = LogClock::now();
+            if (ticks < previous) {
+                monotonic = false;
+            }
+            previous = ticks;
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / COUNT;
+        
+        // 换算后的墙上时间与系统时间的偏差
+        int64_t mapped = LogClock::toEpochNanos(LogClock::now());
+        int64_t actual = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        double errorUs = static_cast<double>(mapped > actual ? mapped - actual : actual - mapped) / 1000.0;
+        
+        std::cout << std::left << std::setw(24) << (LogClock::getSource() == sources[s] ? sourceNames[s] : "steady(fallback)")
+                  << std::setw(16) << ns << errorUs << std::endl;
+    }
+    std::cout << std::right << "Clock readings monotonic: " << (monotonic ? "yes" : "NO") << std::endl;
+    
+    // 队列运行期间拒绝切换时钟源；工作线程约每秒重新建立对应关系，停止后才能再次切换
+    bool switchRefused;
+    bool reanchored;
+    {
+        AsyncConfig clockConfig;
+        AsyncLogQueue clockQueue(clockConfig);
+        LogClockSource before = LogClock::getSource();
+        switchRefused = !LogClock::setSource(LogClockSource::steady) && LogClock::getSource() == before;
+        uint64_t tickBase;
+        int64_t epochBase;
+        double nanosPerTick;
+        LogClock::getMapping(&tickBase, &epochBase, &nanosPerTick);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        LogEntry* entry = clockQueue.allocateEntry();
+        entry->level = LogLevel::info;
+        entry->timestamp = LogClock::now();
+        clockQueue.enqueue(entry);
+        clockQueue.flush(1000);
+        uint64_t refreshedBase;
+        LogClock::getMapping(&refreshedBase, &epochBase, &nanosPerTick);
+        reanchored = refreshedBase != tickBase;
+    }
+    bool switchAllowed = LogClock::setSource(LogClockSource::steady);
+    std::cout << "Switch refused while queue runs: " << (switchRefused ? "yes" : "NO")
+              << ", re-anchored by worker: " << (reanchored ? "yes" : "NO")
+              << ", switch allowed after stop: " << (switchAllowed ? "yes" : "NO") << std::endl;
+    
+    // 积压测试：工作线程写出（含控制台输出）慢于生产者，输出中的时间戳仍应落在生产者循环的时间范围内
+    const int LOG_COUNT = 2000;
+    WinLog::getInstance().shutdown();
+    remove("timestamp_log.log");
+    AsyncConfig config;
+    config.queueSize = LOG_COUNT;
+    config.memoryPoolSize = LOG_COUNT;
+    config.clockSource = LogClockSource::tsc;
+    WinLog::getInstance().init("timestamp_log.log", LogLevel::info, config);
+    WinLog::getInstance().setTimestampFormat(TimestampPrecision::nanoseconds, TimestampZone::utc);
+    
+    TimestampFormatter bounds(TimestampPrecision::nanoseconds, TimestampZone::utc);
+    char lower[TIMESTAMP_BUFFER_SIZE];
+    char upper[TIMESTAMP_BUFFER_SIZE];
+    // 允许2毫秒的换算误差
+    bounds.format(std::chrono::system_clock::now() - std::chrono::milliseconds(2), lower);
+    for (int i = 0; i < LOG_COUNT; ++i) {
+        WinLog::getInstance().info("call-site timestamp %d", i);
+    }
+    bounds.format(std::chrono::system_clock::now() + std::chrono::milliseconds(2), upper);
+    WinLog::getInstance().flush(5000);
+    WinLog::getInstance().shutdown();
+    WinLog::getInstance().setTimestampFormat(TimestampPrecision::milliseconds, TimestampZone::local);
+    
+    int inRange = 0;
+    int total = 0;
+    FILE* file = fopen("timestamp_log.log", "r");
+    if (file) {
+        char line[1024];
+        while (fgets(line, sizeof(line), file)) {
+            if (line[0] != '[' || !strstr(line, "call-site timestamp")) {
+                continue;
+            }
+            std::string stamp(line + 1, strlen(lower));
+            total++;
+            if (strcmp(stamp.c_str(), lower) >= 0 && strcmp(stamp.c_str(), upper) <= 0) {
+                inRange++;
+            }
+        }
+        fclose(file);
+    }
+    std::cout << "Timestamps within producer window: " << inRange << "/" << total << std::endl;
+    if (monotonic && switchRefused && reanchored && switchAllowed && total == LOG_COUNT && inRange == total) {
+        std::cout << "Call-site timestamp test passed" << std::endl;
+    } else {
+        std::cout << "Call-site timestamp test FAILED" << std::endl;
+    }
+}
+
+// 输出路径分配测试：日志行格式化与整批写出在稳定状态下不应触发任何堆分配
+void testOutputPathAllocations() {
+    std::cout << "\n=== Output Path Allocation Test ===" << std::endl;
+    
+    const int BATCHES = 200;
+    const int BATCH_SIZE = 100;
+    
+    // 与工作线程相同的组件：时间戳格式化器、可复用缓冲区、行尾记录、日志文件
+    TimestampFormatter formatter;
+    LogOutputBuffer buffer;
+    std::vector<std::pair<size_t, bool>> lines;
+    lines.reserve(BATCH_SIZE);
+    remove("output_alloc.log");
+    LogFile file;
+    file.open("output_alloc.log");
+    
+    LogEntry entry;
+    entry.level = LogLevel::warn;
+    entry.setFile("async_log_test.cpp", strlen("async_log_test.cpp"));
+    entry.line = 42;
+    
+    size_t allocationsPerPhase[2] = {0, 0};
+    for (int phase = 0; phase < 2; ++phase) {
+        // 第一轮为预热（缓冲区扩容等），第二轮为稳定状态
+        size_t before = globalNewCount.load();
+        for (int b = 0; b < BATCHES; ++b) {
+            for (int i = 0; i < BATCH_SIZE; ++i) {
+                int len = snprintf(entry.message, LOG_MESSAGE_BUFFER_SIZE,
+                                   "batch %d line %d status ok", b, i);
+                entry.messageLen = static_cast<size_t>(len);
+                entry.timestamp = LogClock::now();
+                char timeStr[TIMESTAMP_BUFFER_SIZE];
+                size_t timeLen = formatter.format(LogClock::toEpochNanos(entry.timestamp), timeStr);
+                buffer.appendLine(timeStr, timeLen, entry.level, entry.file, entry.fileLen, entry.line,
+                                  entry.message, entry.messageLen);
+                lines.emplace_back(buffer.size(), false);
+            }
+            file.writeBatch(buffer.data(), buffer.size(), false);
+            buffer.clear();
+            lines.clear();
+        }
+        allocationsPerPhase[phase] = globalNewCount.load() - before;
+    }
+    file.close();
+    
+    size_t steadyLines = static_cast<size_t>(BATCHES) * BATCH_SIZE;
+    std::cout << "Warm-up allocations: " << allocationsPerPhase[0] << std::endl;
+    std::cout << "Steady-state allocations: " << allocationsPerPhase[1] << " for " << steadyLines << " lines ("
+              << std::fixed << std::setprecision(4) << static_cast<double>(allocationsPerPhase[1]) / steadyLines
+              << " per line)" << std::endl;
+    if (allocationsPerPhase[1] == 0) {
+        std::cout << "Output path allocation test passed" << std::endl;
+    } else {
+        std::cout << "Output path allocation test FAILED" << std::endl;
+    }
+}
+
+// 各持久化策略下的文件写入吞吐量
+void testDurabilityPolicyBenchmark() {
+    std::cout << "\n=== Durability Policy Benchmark ===" << std::endl;
+    
+    const int BATCHES = 2000;
+    const int BATCH_SIZE = 100;
+    const int LINES = BATCHES * BATCH_SIZE;
+    
+    struct PolicyCase {
+        const char* name;
+        DurabilityPolicy policy;
+        const char* path;
+    };
+    const PolicyCase cases[] = {
+        {"per-line flush (old)", DurabilityPolicy::flushPerBatch, "durability_line.log"},
+        {"none", DurabilityPolicy::none, "durability_none.log"},
+        {"flushPerBatch", DurabilityPolicy::flushPerBatch, "durability_batch.log"},
+        {"syncInterval", DurabilityPolicy::syncInterval, "durability_interval.log"},
+        {"syncOnError", DurabilityPolicy::syncOnError, "durability_error.log"},
+    };
+    
+    TimestampFormatter formatter;
+    LogOutputBuffer buffer;
+    char timeStr[TIMESTAMP_BUFFER_SIZE];
+    char message[128];
+    
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c) {
+        const PolicyCase& pc = cases[c];
+        bool perLine = (c == 0);
+        remove(pc.path);
+        LogFile file;
+        if (!file.open(pc.path)) {
+            std::cout << pc.name << ": failed to open " << pc.path << std::endl;
+            continue;
+        }
+        file.setDurability(pc.policy, 100, 1024 * 1024);
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < BATCHES; ++b) {
+            // syncOnError每50个批次出现一条error日志
+            bool containsError = (b % 50 == 49);
+            for (int i = 0; i < BATCH_SIZE; ++i) {
+                int len = snprintf(message, sizeof(message), "batch %d line %d request handled in %d us", b, i, i * 7);
+                size_t timeLen = formatter.format(LogClock::toEpochNanos(LogClock::now()), timeStr);
+                buffer.appendLine(timeStr, timeLen, LogLevel::info, "async_log_test.cpp", 18, 42,
+                                  message, static_cast<size_t>(len));
+                if (perLine) {
+                    // 原实现：每行写入后立即flush
+                    file.writeBatch(buffer.data(), buffer.size(), false);
+                    buffer.clear();
+                }
+            }
+            if (!perLine) {
+                file.writeBatch(buffer.data(), buffer.size(), containsError);
+                buffer.clear();
+            }
+        }
+        file.close();
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        double seconds = std::chrono::duration<double>(end - start).count();
+        double mb = static_cast<double>(file.bytesWritten()) / (1024.0 * 1024.0);
+        std::cout << std::left << std::setw(22) << pc.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(8) << mb / seconds << " MB/s  "
+                  << std::setw(10) << std::setprecision(0) << LINES / seconds << " lines/s  "
+                  << "writes: " << file.writeCalls() << "  syncs: " << file.syncCalls() << std::endl;
+    }
+}
+
+// 多输出目标测试：每个输出目标按自己的级别过滤，共享同一份格式化结果；注册了输出目标时不再输出到控制台
+void testMultipleSinks() {
+    std::cout << "\n=== Multiple Sinks Test ===" << std::endl;
+    
+    WinLog::getInstance().shutdown();
+    remove("sink_errors.log");
+    
+    std::shared_ptr<MemoryLogSink> infoSink = std::make_shared<MemoryLogSink>(4096, LogLevel::info);
+    std::shared_ptr<MemoryLogSink> errorSink = std::make_shared<MemoryLogSink>(4096, LogLevel::error);
+    std::shared_ptr<FileLogSink> errorFile = std::make_shared<FileLogSink>("sink_errors.log", LogLevel::error);
+    int callbackLines = 0;
+    bool callbackLevelsOk = true;
+    std::shared_ptr<CallbackLogSink> warnCallback = std::make_shared<CallbackLogSink>(
+        [&](LogLevel level, const char* text, size_t length) {
+            callbackLines++;
+            if (level < LogLevel::warn || length == 0 || text[length - 1] == '\n') {
+                callbackLevelsOk = false;
+            }
+        }, LogLevel::warn);
+    
+    WinLog::getInstance().addSink(infoSink);
+    WinLog::getInstance().addSink(errorSink);
+    WinLog::getInstance().addSink(errorFile);
+    WinLog::getInstance().addSink(warnCallback);
+    
+    AsyncConfig config;
+    config.flushIntervalMs = 100;
+    WinLog::getInstance().init(nullptr, LogLevel::debug, config);
+    
+    // 每轮：1条debug（没有输出目标需要）、1条info、每3轮1条warn、每10轮1条error
+    const int ROUNDS = 300;
+    for (int i = 0; i < ROUNDS; ++i) {
+        WinLog::getInstance().debug("sink debug %d", i);
+        WinLog::getInstance().info("sink info %d", i);
+        if (i % 3 == 0) {
+            WinLog::getInstance().warn("sink warn %d", i);
+        }
+        if (i % 10 == 0) {
+            WinLog::getInstance().error("sink error %d", i);
+        }
+    }
+    WinLog::getInstance().flush(1000);
+    
+    const size_t warnCount = (ROUNDS + 2) / 3;
+    const size_t errorCount = (ROUNDS + 9) / 10;
+    
+    // 错误输出目标中的每一行都应与info输出目标中对应的行完全相同
+    std::vector<std::string> allLines = infoSink->lines();
+    std::vector<std::string> errorLines = errorSink->lines();
+    std::vector<std::string> errorsFromAll;
+    for (const std::string& line : allLines) {
+        if (line.find("[ERROR]") != std::string::npos) {
+            errorsFromAll.push_back(line);
+        }
+    }
+    bool sharedOk = (errorLines == errorsFromAll);
+    
+    // 运行时调低错误输出目标的级别后，warn日志也会写入
+    errorSink->setLevel(LogLevel::warn);
+    WinLog::getInstance().warn("sink warn after level change");
+    WinLog::getInstance().flush(1000);
+    size_t errorSinkAfterChange = errorSink->size();
+    
+    WinLog::getInstance().shutdown();
+    
+    size_t fileLines = 0;
+    FILE* file = fopen("sink_errors.log", "r");
+    if (file) {
+        char line[1024];
+        while (fgets(line, sizeof(line), file)) {
+            fileLines++;
+        }
+        fclose(file);
+    }
+    
+    std::cout << "Info sink: " << allLines.size() << " (expected " << ROUNDS + warnCount + errorCount << ")" << std::endl;
+    std::cout << "Error sink: " << errorLines.size() << " (expected " << errorCount << "), after level change: "
+              << errorSinkAfterChange << " (expected " << errorCount + 1 << ")" << std::endl;
+    std::cout << "Error file: " << fileLines << " lines (expected " << errorCount << ")" << std::endl;
+    std::cout << "Callback sink: " << callbackLines << " (expected " << warnCount + errorCount + 1 << ")" << std::endl;
+    std::cout << "Shared formatting: " << (sharedOk ? "ok" : "MISMATCH") << std::endl;
+    
+    if (allLines.size() == ROUNDS + warnCount + errorCount && errorLines.size() == errorCount &&
+        errorSinkAfterChange == errorCount + 1 && fileLines == errorCount &&
+        callbackLines == static_cast<int>(warnCount + errorCount + 1) && callbackLevelsOk && sharedOk) {
+        std::cout << "Multiple sinks test passed" << std::endl;
+    } else {
+        std::cout << "Multiple sinks test FAILED" << std::endl;
+    }
+}
+
+// 慢输出目标隔离测试：慢输出目标有自己的写线程和缓冲区，文件输出目标的吞吐量不受影响
+void testSlowSinkIsolation() {
+    std::cout << "\n=== Slow Sink Isolation Test ===" << std::endl;
+    
+    const int MESSAGES = 50000;
+    
+    // 返回文件输出目标写完全部日志的吞吐量（行/秒）
+    auto runFileThroughput = [&](const std::shared_ptr<LogSink>& extraSink, const char* path,
+                                 std::shared_ptr<FileLogSink>& fileSink) {
+        WinLog::getInstance().shutdown();
+        remove(path);
+        fileSink = std::make_shared<FileLogSink>(path);
+        WinLog::getInstance().addSink(fileSink);
+        if (extraSink) {
+            WinLog::getInstance().addSink(extraSink);
+        }
+        AsyncConfig config;
+        config.flushIntervalMs = 10;
+        WinLog::getInstance().init(nullptr, LogLevel::info, config);
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < MESSAGES; ++i) {
+            WinLog::getInstance().info("isolation message %d with some payload text", i);
+        }
+        // 只等待文件输出目标写完，不等待慢输出目标
+        while (fileSink->getStats().linesWritten < static_cast<uint64_t>(MESSAGES)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        WinLog::getInstance().flush(5000);
+        WinLog::getInstance().shutdown();
+        return MESSAGES / std::chrono::duration<double>(end - start).count();
+    };
+    
+    std::shared_ptr<FileLogSink> baselineFile;
+    double baseline = runFileThroughput(nullptr, "isolation_baseline.log", baselineFile);
+    
+    // 模拟被管道另一端拖慢的控制台：每行耗时200微秒，缓冲区64KB，放不下时丢弃自己的日志
+    std::shared_ptr<CallbackLogSink> slowSink = std::make_shared<CallbackLogSink>(
+        [](LogLevel, const char*, size_t) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        });
+    slowSink->setBufferCapacity(64 * 1024);
+    slowSink->setOverflowPolicy(SinkOverflowPolicy::drop);
+    std::shared_ptr<FileLogSink> isolatedFile;
+    double isolated = runFileThroughput(slowSink, "isolation_slow.log", isolatedFile);
+    
+    SinkStats fileStats = isolatedFile->getStats();
+    SinkStats slowStats = slowSink->getStats();
+    double ratio = isolated / baseline;
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "File sink alone: " << baseline << " lines/s" << std::endl;
+    std::cout << "File sink with slow sink: " << isolated << " lines/s (" << std::setprecision(2) << ratio
+              << "x)" << std::endl;
+    std::cout << "File sink: " << fileStats.linesWritten << " lines, " << fileStats.bytesWritten << " bytes, "
+              << fileStats.batchesWritten << " batches, avg write "
+              << (fileStats.batchesWritten ? fileStats.totalWriteNanos / fileStats.batchesWritten / 1000 : 0)
+              << " us, dropped " << fileStats.droppedLines << std::endl;
+    std::cout << "Slow sink: " << slowStats.linesWritten << " lines, " << slowStats.batchesWritten
+              << " batches, max write " << slowStats.maxWriteNanos / 1000000 << " ms, dropped "
+              << slowStats.droppedLines << std::endl;
+    
+    if (fileStats.linesWritten == static_cast<uint64_t>(MESSAGES) && fileStats.droppedLines == 0 &&
+        slowStats.droppedLines > 0 && slowStats.linesWritten + slowStats.droppedLines == static_cast<uint64_t>(MESSAGES) &&
+        ratio > 0.5) {
+        std::cout << "Slow sink isolation test passed" << std::endl;
+    } else {
+        std::cout << "Slow sink isolation test FAILED" << std::endl;
+    }
+}
+
+static bool fileExists(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file) {
+        fclose(file);
+        return true;
+    }
+    return false;
+}
+
+// 构造一批典型的日志行
+static void buildRotationBatch(LogOutputBuffer& buffer, std::vector<LogLine>& lines, int batchIndex, int lineCount) {
+    TimestampFormatter formatter;
+    char timeStr[TIMESTAMP_BUFFER_SIZE];
+    char message[160];
+    buffer.clear();
+    lines.clear();
+    for (int i = 0; i < lineCount; ++i) {
+        size_t timeLen = formatter.format(LogClock::toEpochNanos(LogClock::now()), timeStr);
+        int len = snprintf(message, sizeof(message), "request %d.%d from client 10.0.%d.%d completed in %d us status=%s",
+                           batchIndex, i, i % 7, batchIndex % 250, (batchIndex * 37 + i * 11) % 5000,
+                           (i % 13 == 0) ? "retry" : "ok");
+        size_t start = buffer.size();
+        buffer.appendLine(timeStr, timeLen, LogLevel::info, "async_log_test.cpp", 18, 42, message, static_cast<size_t>(len));
+        LogLine line;
+        line.offset = start;
+        line.length = buffer.size() - start;
+        line.level = LogLevel::info;
+        lines.push_back(line);
+    }
+}
+
+// 文件轮转基准测试：轮转延迟、预建文件切换、后台压缩对写入吞吐量的影响及压缩正确性
+void testRotationBenchmark() {
+    std::cout << "\n=== Rotation Benchmark ===" << std::endl;
+    
+    const int BATCHES = 4000;
+    const int BATCH_SIZE = 100;
+    const int MAX_FILES = 3;
+    
+    LogOutputBuffer buffer;
+    std::vector<LogLine> lines;
+    
+    // 压缩器往返正确性与速度
+    LogOutputBuffer sample(1024 * 1024);
+    for (int b = 0; b < 100; ++b) {
+        buildRotationBatch(buffer, lines, b, BATCH_SIZE);
+        sample.append(buffer.data(), buffer.size());
+    }
+    std::vector<char> packed(logCompressBound(sample.size()));
+    std::vector<char> unpacked(sample.size());
+    auto compressStart = std::chrono::high_resolution_clock::now();
+    size_t packedLen = logCompressBlock(sample.data(), sample.size(), packed.data(), packed.size());
+    auto compressEnd = std::chrono::high_resolution_clock::now();
+    size_t unpackedLen = logDecompressBlock(packed.data(), packedLen, unpacked.data(), unpacked.size());
+    bool roundTripOk = packedLen > 0 && unpackedLen == sample.size() &&
+                       memcmp(unpacked.data(), sample.data(), sample.size()) == 0;
+    double compressMBs = sample.size() / (1024.0 * 1024.0) /
+                         std::chrono::duration<double>(compressEnd - compressStart).count();
+    std::cout << std::fixed << std::setprecision(2) << "Compressor: " << sample.size() << " -> " << packedLen
+              << " bytes (" << static_cast<double>(sample.size()) / packedLen << "x), "
+              << std::setprecision(0) << compressMBs << " MB/s, round trip " << (roundTripOk ? "ok" : "MISMATCH")
+              << std::endl;
+    
+    bool allOk = roundTripOk;
+    for (int compress = 0; compress <= 1; ++compress) {
+        const std::string path = "rotate_bench.log";
+        for (int i = 1; i <= 64; ++i) {
+            std::string archive = path + "." + std::to_string(i);
+            remove(archive.c_str());
+            remove((archive + ".wlz").c_str());
+        }
+        remove(path.c_str());
+        
+        RotationConfig rotation;
+        rotation.maxFileBytes = 4 * 1024 * 1024;
+        rotation.maxFiles = MAX_FILES;
+        rotation.compress = (compress != 0);
+        rotation.preallocateBytes = rotation.maxFileBytes;
+        RotationStats stats;
+        uint64_t bytesWritten = 0;
+        double seconds = 0;
+        {
+            RotatingFileLogSink sink(path.c_str(), rotation);
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int b = 0; b < BATCHES; ++b) {
+                buildRotationBatch(buffer, lines, b, BATCH_SIZE);
+                LogBatch batch;
+                batch.data = buffer.data();
+                batch.size = buffer.size();
+                batch.lines = lines.data();
+                batch.count = lines.size();
+                batch.minLevel = LogLevel::info;
+                batch.maxLevel = LogLevel::info;
+                sink.submit(batch);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            seconds = std::chrono::duration<double>(end - start).count();
+            sink.waitIdle(30000);
+            stats = sink.getRotationStats();
+            bytesWritten = sink.getStats().bytesWritten;
+        }
+        
+        // 最近MAX_FILES个历史文件应保留（压缩时为.wlz），更早的已删除
+        uint64_t newest = stats.rotations;
+        int retained = 0;
+        for (uint64_t i = 1; i <= newest; ++i) {
+            std::string archive = path + "." + std::to_string(i);
+            if (fileExists(compress ? archive + ".wlz" : archive)) {
+                retained++;
+            }
+        }
+        bool decodeOk = true;
+        if (compress && newest > 0) {
+            std::string archive = path + "." + std::to_string(newest);
+            decodeOk = logDecompressFile((archive + ".wlz").c_str(), "rotate_bench_decoded.log");
+            remove("rotate_bench_decoded.log");
+        }
+        
+        double mb = bytesWritten / (1024.0 * 1024.0);
+        std::cout << (compress ? "With compression:    " : "Without compression: ") << std::setprecision(1)
+                  << mb / seconds << " MB/s, " << stats.rotations << " rotations (" << stats.preparedSwitches
+                  << " prepared), rotation avg " << std::setprecision(0)
+                  << (stats.rotations ? stats.totalRotationNanos / stats.rotations / 1000.0 : 0.0) << " us, max "
+                  << stats.maxRotationNanos / 1000.0 << " us, retained " << retained << "/" << MAX_FILES
+                  << ", deleted " << stats.filesDeleted << std::endl;
+        if (compress) {
+            std::cout << "  Compressed " << stats.filesCompressed << " files: " << std::setprecision(2)
+                      << (stats.compressedBytesOut ? static_cast<double>(stats.compressedBytesIn) / stats.compressedBytesOut : 0.0)
+                      << "x, " << std::setprecision(0)
+                      << (stats.compressionNanos ? stats.compressedBytesIn / 1024.0 / 1024.0 / (stats.compressionNanos / 1e9) : 0.0)
+                      << " MB/s in background, decode " << (decodeOk ? "ok" : "FAILED") << std::endl;
+        }
+        
+        allOk = allOk && stats.rotations >= 8 && retained == MAX_FILES && decodeOk &&
+                (!compress || stats.filesCompressed == stats.rotations);
+    }
+    
+    // 按时间轮转：间隔1秒，跨过边界后的第一批日志写入新文件
+    {
+        const std::string path = "rotate_time.log";
+        remove(path.c_str());
+        remove((path + ".1").c_str());
+        RotationConfig rotation;
+        rotation.rotateIntervalSec = 1;
+        rotation.compress = false;
+        RotatingFileLogSink sink(path.c_str(), rotation);
+        buildRotationBatch(buffer, lines, 0, 1);
+        LogBatch batch;
+        batch.data = buffer.data();
+        batch.size = buffer.size();
+        batch.lines = lines.data();
+        batch.count = lines.size();
+        batch.minLevel = LogLevel::info;
+        batch.maxLevel = LogLevel::info;
+        sink.submit(batch);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        sink.submit(batch);
+        sink.waitIdle(5000);
+        uint64_t rotations = sink.getRotationStats().rotations;
+        std::cout << "Time-based rotations after 1.1 s: " << rotations << " (expected 1)" << std::endl;
+        allOk = allOk && rotations == 1;
+    }
+    
+    if (allOk) {
+        std::cout << "Rotation benchmark passed" << std::endl;
+    } else {
+        std::cout << "Rotation benchmark FAILED" << std::endl;
+    }
+}
+
+// 读取整个文件的内容
+static std::string readWholeFile(const char* path) {
+    std::string content;
+    FILE* file = fopen(path, "rb");
+    if (file) {
+        char chunk[65536];
+        size_t got;
+        while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            content.append(chunk, got);
+        }
+        fclose(file);
+    }
+    return content;
+}
+
+// 二进制输出目标基准测试：与文本输出路径比较工作线程每条日志的耗时和写入的字节数，
+// 并验证winlog-decode还原出的文本与文本输出目标逐字节相同
+void testBinarySinkBenchmark() {
+    std::cout << "\n=== Binary Sink Benchmark ===" << std::endl;
+    
+    const int BATCHES = 1000;
+    const int BATCH_SIZE = 100;
+    const int LINES = BATCHES * BATCH_SIZE;
+    const int ROUNDS = 3;
+    
+    // 典型的调用点日志：几个整数、一个浮点数和短字符串
+    const LogSite* sites[3] = {
+        LogSiteRegistry::registerSite(LogLevel::info, "order %d filled qty=%u price=%.2f account=%s",
+                                      "order_service.cpp", 128),
+        LogSiteRegistry::registerSite(LogLevel::info, "request %s from client %d completed in %d us status=%d",
+                                      "http_server.cpp", 311),
+        LogSiteRegistry::registerSite(LogLevel::warn, "cache miss key=%llu shard=%d retry=%d",
+                                      "cache.cpp", 57),
+    };
+    
+    // 预先生成全部条目（调用线程的编码不计入工作线程的耗时）
+    std::vector<LogEntry> entries(BATCH_SIZE);
+    auto fillEntry = [&](LogEntry& entry, int n) {
+        const LogSite* site = sites[n % 3];
+        entry.reset();
+        entry.level = site->level;
+        entry.format = site->format;
+        entry.siteId = site->id;
+        entry.timestamp = LogClock::now();
+        LogArgBuffer args(entry.message, LOG_MESSAGE_BUFFER_SIZE - 1);
+        switch (n % 3) {
+            case 0:
+                encodeLogArgs(args, 100000 + n, static_cast<unsigned>(n % 500), 99.5 + n % 100, "ACC-7731");
+                break;
+            case 1:
+                encodeLogArgs(args, "GET /api/orders", n % 64, (n * 37) % 5000, 200);
+                break;
+            default:
+                encodeLogArgs(args, 0x5bd1e995ULL * static_cast<unsigned long long>(n), n % 16, n % 3);
+                break;
+        }
+        entry.messageLen = args.size();
+    };
+    
+    TimestampFormatter formatter;
+    LogOutputBuffer buffer;
+    std::vector<LogLine> lines;
+    lines.reserve(BATCH_SIZE);
+    
+    double textSeconds = 1e9;
+    double binarySeconds = 1e9;
+    uint64_t textBytes = 0;
+    uint64_t binaryBytes = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        remove("binary_bench.log");
+        remove("binary_bench.wlb");
+        std::unique_ptr<FileLogSink> textSink(new FileLogSink("binary_bench.log"));
+        std::unique_ptr<BinaryLogSink> binarySink(new BinaryLogSink("binary_bench.wlb"));
+        double textTotal = 0;
+        double binaryTotal = 0;
+        for (int b = 0; b < BATCHES; ++b) {
+            for (int i = 0; i < BATCH_SIZE; ++i) {
+                fillEntry(entries[i], b * BATCH_SIZE + i);
+            }
+            
+            // 二进制路径：写入记录头与编码后的参数，由输出目标转码写入
+            auto start = std::chrono::high_resolution_clock::now();
+            buffer.clear();
+            lines.clear();
+            for (const LogEntry& entry : entries) {
+                size_t lineStart = buffer.size();
+                BinaryEntryHeader header;
+                header.timestamp = static_cast<uint64_t>(LogClock::toEpochNanos(entry.timestamp));
+                header.format = entry.format;
+                header.siteId = entry.siteId;
+                header.line = 0;
+                header.messageLen = static_cast<uint16_t>(entry.messageLen);
+                header.fileLen = 0;
+                buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+                buffer.append(entry.message, entry.messageLen);
+                LogLine line;
+                line.offset = lineStart;
+                line.length = buffer.size() - lineStart;
+                line.level = entry.level;
+                lines.push_back(line);
+            }
+            LogBatch batch;
+            batch.data = buffer.data();
+            batch.size = buffer.size();
+            batch.lines = lines.data();
+            batch.count = lines.size();
+            batch.minLevel = LogLevel::info;
+            batch.maxLevel = LogLevel::warn;
+            binarySink->submit(batch);
+            binaryTotal += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            
+            // 文本路径：延迟格式化、时间戳换算与格式化、拼接整行，由文件输出目标写入
+            start = std::chrono::high_resolution_clock::now();
+            buffer.clear();
+            lines.clear();
+            for (const LogEntry& entry : entries) {
+                size_t lineStart = buffer.size();
+                char message[LOG_MESSAGE_BUFFER_SIZE];
+                size_t messageLen = formatLogArgs(entry.format, entry.message, entry.messageLen, message, sizeof(message));
+                char timeStr[TIMESTAMP_BUFFER_SIZE];
+                size_t timeLen = formatter.format(LogClock::toEpochNanos(entry.timestamp), timeStr);
+                const LogSite* site = LogSiteRegistry::find(entry.siteId);
+                buffer.appendLine(timeStr, timeLen, entry.level, site->file, strlen(site->file), site->line,
+                                  message, messageLen);
+                LogLine line;
+                line.offset = lineStart;
+                line.length = buffer.size() - lineStart;
+                line.level = entry.level;
+                lines.push_back(line);
+            }
+            batch.data = buffer.data();
+            batch.size = buffer.size();
+            batch.lines = lines.data();
+            batch.count = lines.size();
+            textSink->submit(batch);
+            textTotal += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+        textSink.reset();
+        binarySink.reset();
+        textSeconds = std::min(textSeconds, textTotal);
+        binarySeconds = std::min(binarySeconds, binaryTotal);
+    }
+    std::string text = readWholeFile("binary_bench.log");
+    textBytes = text.size();
+    binaryBytes = readWholeFile("binary_bench.wlb").size();
+    
+    // 离线解码后与文本输出逐字节比较
+    auto decodeStart = std::chrono::high_resolution_clock::now();
+    BinaryLogDecoder decoder;
+    bool decodeOk = decoder.decodeFile("binary_bench.wlb", "binary_bench_decoded.log");
+    double decodeSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - decodeStart).count();
+    bool identical = decodeOk && readWholeFile("binary_bench_decoded.log") == text;
+    
+    double bytesRatio = binaryBytes ? static_cast<double>(textBytes) / binaryBytes : 0.0;
+    double cpuRatio = binarySeconds > 0 ? textSeconds / binarySeconds : 0.0;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Text path:   " << textSeconds * 1e9 / LINES << " ns/msg, " << static_cast<double>(textBytes) / LINES
+              << " bytes/msg" << std::endl;
+    std::cout << "Binary path: " << binarySeconds * 1e9 / LINES << " ns/msg, " << static_cast<double>(binaryBytes) / LINES
+              << " bytes/msg" << std::endl;
+    std::cout << std::setprecision(2) << "Bytes ratio: " << bytesRatio << "x, worker CPU ratio: " << cpuRatio << "x"
+              << std::endl;
+    std::cout << "Decoded " << decoder.entriesDecoded() << " entries in " << std::setprecision(1)
+              << decodeSeconds * 1000 << " ms, output " << (identical ? "identical" : "DIFFERENT") << std::endl;
+    
+    // 经由日志库：调用点日志、未登记的格式字符串和已格式化的消息同时写入二进制与文本输出目标
+    WinLog::getInstance().shutdown();
+    remove("binary_winlog.wlb");
+    std::shared_ptr<BinaryLogSink> binaryLog = std::make_shared<BinaryLogSink>("binary_winlog.wlb");
+    std::shared_ptr<MemoryLogSink> memoryLog = std::make_shared<MemoryLogSink>(4096);
+    WinLog::getInstance().addSink(binaryLog);
+    WinLog::getInstance().addSink(memoryLog);
+    AsyncConfig config;
+    config.flushIntervalMs = 50;
+    WinLog::getInstance().init(nullptr, LogLevel::debug, config);
+    for (int i = 0; i < 200; ++i) {
+        WINLOG_INFO("binary site %d value=%.3f name=%s", i, i * 0.25, "worker");
+        WinLog::getInstance().warn("binary deferred %d of %d", i, 200);
+        if (i % 20 == 0) {
+            WinLog::getInstance().error("binary preformatted %d", i);
+        }
+    }
+    WinLog::getInstance().flush(1000);
+    WinLog::getInstance().shutdown();
+    
+    BinaryLogDecoder winlogDecoder;
+    bool winlogOk = winlogDecoder.decodeFile("binary_winlog.wlb", "binary_winlog_decoded.log");
+    std::string expected;
+    for (const std::string& line : memoryLog->lines()) {
+        expected += line;
+        expected += '\n';
+    }
+    bool winlogIdentical = winlogOk && !expected.empty() && readWholeFile("binary_winlog_decoded.log") == expected;
+    std::cout << "WinLog binary sink: " << winlogDecoder.entriesDecoded() << " entries (expected "
+              << memoryLog->size() << "), decoded output " << (winlogIdentical ? "identical" : "DIFFERENT") << std::endl;
+    
+    if (identical && winlogIdentical && bytesRatio >= 5.0 && cpuRatio >= 5.0) {
+        std::cout << "Binary sink benchmark passed" << std::endl;
+    } else {
+        std::cout << "Binary sink benchmark FAILED" << std::endl;
+    }
+}
+
+// 内存映射文件输出目标：与缓冲写入比较吞吐量，验证关闭时截断、轮转和异常退出后的恢复
+void testMappedFileSink() {
+    std::cout << "\n=== Memory-Mapped File Sink Test ===" << std::endl;
+    
+    const int BATCHES = 2000;
+    const int BATCH_SIZE = 100;
+    LogOutputBuffer buffer;
+    std::vector<LogLine> lines;
+    buildRotationBatch(buffer, lines, 0, BATCH_SIZE);
+    LogBatch batch;
+    batch.data = buffer.data();
+    batch.size = buffer.size();
+    batch.lines = lines.data();
+    batch.count = lines.size();
+    batch.minLevel = LogLevel::info;
+    batch.maxLevel = LogLevel::info;
+    const uint64_t expectedSize = static_cast<uint64_t>(batch.size) * BATCHES;
+    bool allOk = true;
+    
+    // 吞吐量：同样的批次分别以缓冲写入和内存映射方式写入（16MB窗口，途中多次扩展文件并重新映射）
+    const char* paths[2] = {"mapped_buffered.log", "mapped_window.log"};
+    for (int mode = 0; mode < 2; ++mode) {
+        remove(paths[mode]);
+        std::unique_ptr<FileLogSink> sink(mode == 0 ? new FileLogSink(paths[mode])
+                                                    : new MappedFileLogSink(paths[mode], 16 * 1024 * 1024));
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < BATCHES; ++b) {
+            sink->submit(batch);
+        }
+        sink->flush();
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        uint64_t writeCalls = sink->file().writeCalls();
+        uint64_t mapCalls = sink->file().mapCalls();
+        sink.reset();
+        uint64_t size = readWholeFile(paths[mode]).size();
+        std::cout << (mode == 0 ? "Buffered: " : "Mapped:   ") << std::fixed << std::setprecision(1)
+                  << expectedSize / 1024.0 / 1024.0 / seconds << " MB/s, " << writeCalls << " WriteFile calls, "
+                  << mapCalls << " window maps, size after close " << size << " (expected " << expectedSize << ")"
+                  << std::endl;
+        allOk = allOk && size == expectedSize && (mode == 0 || writeCalls == 0);
+    }
+    bool sameContent = readWholeFile(paths[0]) == readWholeFile(paths[1]);
+    std::cout << "Mapped content matches buffered: " << (sameContent ? "yes" : "NO") << std::endl;
+    allOk = allOk && sameContent;
+    
+    // 轮转：每个历史文件都截断为实际长度，不含映射窗口留下的零填充
+    {
+        const std::string path = "mapped_rotate.log";
+        remove(path.c_str());
+        for (int i = 1; i <= 20; ++i) {
+            remove((path + "." + std::to_string(i)).c_str());
+        }
+        RotationConfig rotation;
+        rotation.maxFileBytes = 1024 * 1024;
+        rotation.maxFiles = 20;
+        rotation.compress = false;
+        uint64_t rotations = 0;
+        {
+            RotatingFileLogSink sink(path.c_str(), rotation, LogLevel::trace, DurabilityPolicy::flushPerBatch,
+                                     1000, 1024 * 1024, 256 * 1024);
+            for (int b = 0; b < 400; ++b) {
+                sink.submit(batch);
+            }
+            sink.waitIdle(5000);
+            rotations = sink.getRotationStats().rotations;
+        }
+        uint64_t total = readWholeFile(path.c_str()).size();
+        bool archivesClean = rotations > 0;
+        for (uint64_t i = 1; i <= rotations; ++i) {
+            std::string content = readWholeFile((path + "." + std::to_string(i)).c_str());
+            total += content.size();
+            if (content.empty() || content.back() != '\n' || content.find('\0') != std::string::npos) {
+                archivesClean = false;
+            }
+        }
+        std::cout << "Mapped rotation: " << rotations << " rotations, total " << total << " bytes (expected "
+                  << static_cast<uint64_t>(batch.size) * 400 << "), archives " << (archivesClean ? "clean" : "PADDED")
+                  << std::endl;
+        allOk = allOk && archivesClean && total == static_cast<uint64_t>(batch.size) * 400;
+    }
+    
+    // 异常退出：文件尾部留有写了一半的行和未写入的零填充窗口，重新打开时截掉后继续追加
+    {
+        const char* path = "mapped_crash.log";
+        std::string complete;
+        for (int i = 0; i < 1000; ++i) {
+            complete += "[2026-01-01 00:00:00.000] [INFO] line before crash " + std::to_string(i) + "\n";
+        }
+        FILE* file = fopen(path, "wb");
+        if (file) {
+            std::string torn = complete + "[2026-01-01 00:00:00.000] [INFO] torn li";
+            torn.append(300 * 1024, '\0');
+            fwrite(torn.data(), 1, torn.size(), file);
+            fclose(file);
+        }
+        uint64_t recovered = 0;
+        {
+            MappedFileLogSink sink(path, 256 * 1024);
+            recovered = sink.file().recoveredBytes();
+            sink.submit(batch);
+        }
+        std::string expected = complete + std::string(batch.data, batch.size);
+        bool recoveredOk = readWholeFile(path) == expected;
+        std::cout << "Crash recovery: trimmed " << recovered << " bytes, content "
+                  << (recoveredOk ? "ok" : "CORRUPT") << std::endl;
+        allOk = allOk && recoveredOk;
+    }
+    
+    if (allOk) {
+        std::cout << "Memory-mapped file sink test passed" << std::endl;
+    } else {
+        std::cout << "Memory-mapped file sink test FAILED" << std::endl;
+    }
+}
+
+// 重叠I/O写入基准测试：比较同步写入与重叠I/O写入时写线程每批的耗时，以及全部写入完成的总时间
+void testOverlappedWriteBenchmark() {
+    std::cout << "\n=== Overlapped Write Benchmark ===" << std::endl;
+    
+    const int BATCHES = 500;
+    const int BATCH_SIZE = 1000;
+    LogOutputBuffer buffer;
+    std::vector<LogLine> lines;
+    buildRotationBatch(buffer, lines, 0, BATCH_SIZE);
+    LogBatch batch;
+    batch.data = buffer.data();
+    batch.size = buffer.size();
+    batch.lines = lines.data();
+    batch.count = lines.size();
+    batch.minLevel = LogLevel::info;
+    batch.maxLevel = LogLevel::info;
+    const uint64_t expectedSize = static_cast<uint64_t>(batch.size) * BATCHES;
+    
+    const char* paths[2] = {"overlapped_sync.log", "overlapped_async.log"};
+    double avgNanos[2] = {0, 0};
+    bool allOk = true;
+    for (int mode = 0; mode < 2; ++mode) {
+        remove(paths[mode]);
+        std::unique_ptr<FileLogSink> sink(mode == 0 ? new FileLogSink(paths[mode])
+                                                    : new OverlappedFileLogSink(paths[mode], 4));
+        std::vector<long long> batchNanos;
+        batchNanos.reserve(BATCHES);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < BATCHES; ++b) {
+            auto batchStart = std::chrono::high_resolution_clock::now();
+            sink->submit(batch);
+            batchNanos.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::high_resolution_clock::now() - batchStart).count());
+        }
+        // 端到端：全部批次都写入操作系统为止
+        sink->flush();
+        double totalMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        bool overlapped = sink->file().isOverlapped();
+        uint64_t waits = sink->file().overlappedWaits();
+        uint64_t synchronous = sink->file().synchronousWrites();
+        uint64_t submits = sink->file().writeCalls();
+        sink.reset();
+        
+        std::sort(batchNanos.begin(), batchNanos.end());
+        long long sum = 0;
+        for (long long n : batchNanos) {
+            sum += n;
+        }
+        avgNanos[mode] = static_cast<double>(sum) / BATCHES;
+        uint64_t size = readWholeFile(paths[mode]).size();
+        std::cout << (mode == 0 ? "Synchronous: " : (overlapped ? "Overlapped:  " : "Overlapped (fallback): "))
+                  << std::fixed << std::setprecision(1) << avgNanos[mode] / 1000.0 << " us/batch worker time (p50 "
+                  << percentileNs(batchNanos, 0.50) / 1000.0 << ", p99 " << percentileNs(batchNanos, 0.99) / 1000.0
+                  << "), end-to-end " << totalMs << " ms, " << expectedSize / 1024.0 / 1024.0 / (totalMs / 1000.0)
+                  << " MB/s";
+        if (mode == 1) {
+            std::cout << ", waits for free buffer: " << waits << ", completed synchronously: " << synchronous << "/"
+                      << submits;
+        }
+        std::cout << std::endl;
+        allOk = allOk && size == expectedSize;
+    }
+    bool sameContent = readWholeFile(paths[0]) == readWholeFile(paths[1]);
+    std::cout << "Worker time ratio (sync / overlapped): " << std::setprecision(2)
+              << (avgNanos[1] > 0 ? avgNanos[0] / avgNanos[1] : 0.0) << "x, content "
+              << (sameContent ? "identical" : "DIFFERENT") << std::endl;
+    
+    // 异常退出：文件末尾超前扩展的零填充部分未截断，重新打开时截掉后再追加
+    bool recoveredOk;
+    {
+        const char* path = "overlapped_crash.log";
+        std::string complete = "[2026-01-01 00:00:00.000] [INFO] line before crash\n";
+        FILE* file = fopen(path, "wb");
+        if (file) {
+            std::string padded = complete;
+            padded.append(64 * 1024, '\0');
+            fwrite(padded.data(), 1, padded.size(), file);
+            fclose(file);
+        }
+        uint64_t recovered = 0;
+        {
+            OverlappedFileLogSink sink(path, 4);
+            recovered = sink.file().recoveredBytes();
+            sink.submit(batch);
+        }
+        recoveredOk = readWholeFile(path) == complete + std::string(batch.data, batch.size);
+        std::cout << "Crash recovery: trimmed " << recovered << " bytes, content "
+                  << (recoveredOk ? "ok" : "CORRUPT") << std::endl;
+    }
+    
+    if (allOk && sameContent && recoveredOk) {
+        std::cout << "Overlapped write benchmark passed" << std::endl;
+    } else {
+        std::cout << "Overlapped write benchmark FAILED" << std::endl;
+    }
+}
+
+// 无缓冲写入基准测试：比较std::ofstream、缓冲写入和无缓冲写入每批的写入延迟，以及经过系统文件缓存的数据量；
+// 并检查最后不足一个块的部分在flush和关闭时的补零与截断、追加到已有文件和异常退出后的恢复
+void testDirectWriteBenchmark() {
+    std::cout << "\n=== Direct (Unbuffered) Write Benchmark ===" << std::endl;
+    
+    const int BATCHES = 2000;
+    const int BATCH_SIZE = 100;
+    LogOutputBuffer buffer;
+    std::vector<LogLine> lines;
+    buildRotationBatch(buffer, lines, 0, BATCH_SIZE);
+    LogBatch batch;
+    batch.data = buffer.data();
+    batch.size = buffer.size();
+    batch.lines = lines.data();
+    batch.count = lines.size();
+    batch.minLevel = LogLevel::info;
+    batch.maxLevel = LogLevel::info;
+    const uint64_t expectedSize = static_cast<uint64_t>(batch.size) * BATCHES;
+    
+    // 0: std::ofstream（每批write后flush），1: 缓冲写入，2: 无缓冲写入
+    const char* names[3] = {"std::ofstream:", "Buffered:     ", "Direct:       "};
+    const char* paths[3] = {"direct_ofstream.log", "direct_buffered.log", "direct_unbuffered.log"};
+    bool allOk = true;
+    bool direct = false;
+    for (int mode = 0; mode < 3; ++mode) {
+        remove(paths[mode]);
+        std::ofstream stream;
+        std::unique_ptr<FileLogSink> sink;
+        if (mode == 0) {
+            stream.open(paths[mode], std::ios::binary | std::ios::app);
+        } else if (mode == 1) {
+            sink.reset(new FileLogSink(paths[mode]));
+        } else {
+            sink.reset(new DirectFileLogSink(paths[mode], 16 * 1024 * 1024));
+        }
+        std::vector<long long> batchNanos;
+        batchNanos.reserve(BATCHES);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < BATCHES; ++b) {
+            auto batchStart = std::chrono::high_resolution_clock::now();
+            if (mode == 0) {
+                stream.write(batch.data, static_cast<std::streamsize>(batch.size));
+                stream.flush();
+            } else {
+                sink->submit(batch);
+            }
+            batchNanos.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::high_resolution_clock::now() - batchStart).count());
+        }
+        uint64_t preallocations = 0;
+        if (mode == 0) {
+            stream.close();
+        } else {
+            sink->flush();
+            if (mode == 2) {
+                direct = sink->file().isDirect();
+                preallocations = sink->file().preallocations();
+            }
+        }
+        double totalMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        // 关闭后文件长度截回实际数据的末尾
+        sink.reset();
+        uint64_t sizeAfterClose = readWholeFile(paths[mode]).size();
+        
+        std::sort(batchNanos.begin(), batchNanos.end());
+        // 无缓冲写入不经过系统文件缓存，其余方式写入的数据全部留在缓存中等待回写
+        double cachedMB = (mode == 2 && direct) ? 0.0 : expectedSize / 1024.0 / 1024.0;
+        std::cout << (mode == 2 && !direct ? "Direct (fallback):" : names[mode]) << std::fixed << std::setprecision(1)
+                  << " p50 " << percentileNs(batchNanos, 0.50) / 1000.0 << " us, p99 "
+                  << percentileNs(batchNanos, 0.99) / 1000.0 << " us, max " << batchNanos.back() / 1000.0
+                  << " us per batch, " << expectedSize / 1024.0 / 1024.0 / (totalMs / 1000.0)
+                  << " MB/s, through system cache " << cachedMB << " MB";
+        if (mode == 2) {
+            std::cout << ", preallocations " << preallocations;
+        }
+        std::cout << std::endl;
+        allOk = allOk && sizeAfterClose == expectedSize;
+    }
+    bool sameContent = readWholeFile(paths[0]) == readWholeFile(paths[1]) &&
+                       readWholeFile(paths[1]) == readWholeFile(paths[2]);
+    std::cout << "Content " << (sameContent ? "identical" : "DIFFERENT") << std::endl;
+    allOk = allOk && sameContent;
+    
+    // 追加到长度不是块大小整数倍的已有文件：最后一个块中已有的数据随第一次写入一起重写
+    {
+        const char* path = "direct_append.log";
+        std::string existing = "[2026-01-01 00:00:00.000] [INFO] existing line\n";
+        FILE* file = fopen(path, "wb");
+        if (file) {
+            fwrite(existing.data(), 1, existing.size(), file);
+            fclose(file);
+        }
+        for (int i = 0; i < 3; ++i) {
+            DirectFileLogSink sink(path);
+            sink.submit(batch);
+            existing.append(batch.data, batch.size);
+        }
+        bool appendOk = readWholeFile(path) == existing;
+        std::cout << "Append to existing file: " << (appendOk ? "ok" : "CORRUPT") << std::endl;
+        allOk = allOk && appendOk;
+    }
+    
+    // 每批之后flush：预留的空间保留到关闭，不会每次flush后重新预留
+    {
+        const char* path = "direct_flush.log";
+        remove(path);
+        const size_t EXTENT = 1024 * 1024;
+        const int FLUSHED_BATCHES = 200;
+        uint64_t preallocations = 0;
+        bool flushDirect = false;
+        {
+            DirectFileLogSink sink(path, EXTENT);
+            for (int b = 0; b < FLUSHED_BATCHES; ++b) {
+                sink.submit(batch);
+                sink.flush();
+            }
+            flushDirect = sink.file().isDirect();
+            preallocations = sink.file().preallocations();
+        }
+        uint64_t written = static_cast<uint64_t>(batch.size) * FLUSHED_BATCHES;
+        uint64_t expectedPreallocations = (written + EXTENT - 1) / EXTENT;
+        bool keptOk = readWholeFile(path).size() == written && (!flushDirect || preallocations <= expectedPreallocations);
+        std::cout << "Flush after every batch: " << preallocations << " preallocations (at most "
+                  << expectedPreallocations << "), size after close " << (keptOk ? "ok" : "WRONG") << std::endl;
+        allOk = allOk && keptOk;
+    }
+    
+    // 异常退出：最后一个块补零写出后未截断，重新打开时截掉零填充和写了一半的行
+    {
+        const char* path = "direct_crash.log";
+        std::string complete;
+        for (int i = 0; i < 100; ++i) {
+            complete += "[2026-01-01 00:00:00.000] [INFO] line before crash " + std::to_string(i) + "\n";
+        }
+        FILE* file = fopen(path, "wb");
+        if (file) {
+            std::string torn = complete + "[2026-01-01 00:00:00.000] [INFO] torn li";
+            torn.append(4096 - torn.size() % 4096, '\0');
+            fwrite(torn.data(), 1, torn.size(), file);
+            fclose(file);
+        }
+        uint64_t recovered = 0;
+        {
+            DirectFileLogSink sink(path);
+            recovered = sink.file().recoveredBytes();
+            sink.submit(batch);
+        }
+        bool recoveredOk = readWholeFile(path) == complete + std::string(batch.data, batch.size);
+        std::cout << "Crash recovery: trimmed " << recovered << " bytes, content "
+                  << (recoveredOk ? "ok" : "CORRUPT") << std::endl;
+        allOk = allOk && recoveredOk;
+    }
+    
+    if (allOk) {
+        std::cout << "Direct write benchmark passed" << std::endl;
+    } else {
+        std::cout << "Direct write benchmark FAILED" << std::endl;
+    }
+}
+
+// 落盘凭据与组提交测试：多个线程各自记录一条日志后等待其落盘，同时等待的线程共享一次FlushFileBuffers
+void testDurableGroupCommit() {
+    std::cout << "\n=== Durable Group Commit Test ===" << std::endl;
+    
+    const int THREADS = 8;
+    const int PER_THREAD = 200;
+    const char* path = "durable_commit.log";
+    
+    WinLog::getInstance().shutdown();
+    remove(path);
+    
+    std::shared_ptr<FileLogSink> fileSink = std::make_shared<FileLogSink>(path, LogLevel::trace,
+                                                                          DurabilityPolicy::none);
+    WinLog::getInstance().addSink(fileSink);
+    
+    AsyncConfig config;
+    config.flushIntervalMs = 100;
+    WinLog::getInstance().init(nullptr, LogLevel::debug, config);
+    WinLog::getInstance().resetStats();
+    
+    std::vector<std::vector<long long>> waits(THREADS);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([t, &waits, &failures]() {
+            waits[t].reserve(PER_THREAD);
+            for (int i = 0; i < PER_THREAD; ++i) {
+                WinLog::getInstance().critical("durable thread %d commit %d", t, i);
+                uint64_t ticket = WinLog::getInstance().getDurabilityTicket();
+                auto waitStart = std::chrono::high_resolution_clock::now();
+                if (ticket == 0 || !WinLog::getInstance().waitDurable(ticket, 5000)) {
+                    failures++;
+                }
+                auto waitEnd = std::chrono::high_resolution_clock::now();
+                waits[t].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(waitEnd - waitStart).count());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    Stats stats = WinLog::getInstance().getStats();
+    uint64_t fileSyncs = fileSink->file().syncCalls();
+    
+    // 同步模式：凭据为已写出的日志条数，waitDurable直接落盘
+    WinLog::getInstance().shutdown();
+    WinLog::getInstance().addSink(fileSink);
+    WinLog::getInstance().init(nullptr, LogLevel::debug);
+    WinLog::getInstance().critical("durable sync mode commit");
+    uint64_t syncTicket = WinLog::getInstance().getDurabilityTicket();
+    bool syncModeOk = syncTicket != 0 && WinLog::getInstance().waitDurable(syncTicket, 1000) &&
+                      WinLog::getInstance().flushDurable(1000);
+    WinLog::getInstance().shutdown();
+    fileSink.reset();
+    
+    std::vector<long long> all;
+    for (const auto& w : waits) {
+        all.insert(all.end(), w.begin(), w.end());
+    }
+    std::sort(all.begin(), all.end());
+    
+    // 每个线程的每条日志都应在文件中出现一次
+    std::vector<int> seen(THREADS * PER_THREAD, 0);
+    size_t fileLines = 0;
+    FILE* file = fopen(path, "r");
+    if (file) {
+        char line[1024];
+        while (fgets(line, sizeof(line), file)) {
+            int t = 0;
+            int i = 0;
+            const char* found = strstr(line, "durable thread ");
+            if (found && sscanf(found, "durable thread %d commit %d", &t, &i) == 2 &&
+                t >= 0 && t < THREADS && i >= 0 && i < PER_THREAD) {
+                seen[t * PER_THREAD + i]++;
+            }
+            fileLines++;
+        }
+        fclose(file);
+    }
+    bool allPresent = std::all_of(seen.begin(), seen.end(), [](int n) { return n == 1; });
+    
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double perSync = stats.durableSyncs ? static_cast<double>(stats.durableWaits) / stats.durableSyncs : 0.0;
+    std::cout << std::fixed << std::setprecision(1)
+              << "Commits: " << THREADS * PER_THREAD << " in " << seconds * 1000.0 << " ms ("
+              << std::setprecision(0) << THREADS * PER_THREAD / seconds << " commits/s)" << std::endl;
+    std::cout << std::setprecision(1) << "Wait latency: p50 " << percentileNs(all, 0.50) / 1000.0 << " us, p99 "
+              << percentileNs(all, 0.99) / 1000.0 << " us, max " << all.back() / 1000.0 << " us" << std::endl;
+    std::cout << "Waits: " << stats.durableWaits << ", group syncs: " << stats.durableSyncs
+              << " (" << perSync << " waits per sync), file FlushFileBuffers: " << fileSyncs << std::endl;
+    std::cout << "File lines: " << fileLines << " (expected " << THREADS * PER_THREAD + 1 << "), all present once: "
+              << (allPresent ? "yes" : "NO") << ", failed waits: " << failures.load()
+              << ", sync mode: " << (syncModeOk ? "ok" : "FAILED") << std::endl;
+    
+    if (allPresent && failures.load() == 0 && syncModeOk && fileLines == THREADS * PER_THREAD + 1 &&
+        stats.durableWaits == THREADS * PER_THREAD && stats.durableSyncs <= stats.durableWaits &&
+        fileSyncs >= stats.durableSyncs) {
+        std::cout << "Durable group commit test passed" << std::endl;
+    } else {
+        std::cout << "Durable group commit test FAILED" << std::endl;
+    }
+}
+
+// 持续写入下的flush延迟：其他线程不停记录日志，队列从不为空，flush只等待调用时刻之前的日志
+void testFlushUnderLoad() {
+    std::cout << "\n=== Flush Latency Under Load ===" << std::endl;
+    
+    const int LOAD_THREADS = 3;
+    const int FLUSHES = 100;
+    
+    struct EngineCase {
+        const char* name;
+        QueueEngine engine;
+    };
+    const EngineCase cases[] = {
+        {"mutex", QueueEngine::mutex},
+        {"lockFree", QueueEngine::lockFree},
+        {"recordRing", QueueEngine::recordRing},
+        {"perThreadLanes", QueueEngine::perThreadLanes},
+    };
+    
+    bool allOk = true;
+    for (const EngineCase& ec : cases) {
+        WinLog::getInstance().shutdown();
+        
+        // 记录输出目标收到的最新标记，flush返回时应已收到flush之前的标记
+        std::atomic<int> lastMarker(-1);
+        std::atomic<size_t> loadLines(0);
+        std::shared_ptr<CallbackLogSink> sink = std::make_shared<CallbackLogSink>(
+            [&](LogLevel, const char* text, size_t length) {
+                const char* found = strstr(text, "flush marker ");
+                if (found && found < text + length) {
+                    lastMarker.store(atoi(found + 13), std::memory_order_release);
+                } else {
+                    loadLines.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        WinLog::getInstance().addSink(sink);
+        
+        AsyncConfig config;
+        config.queueEngine = ec.engine;
+        config.flushIntervalMs = 1000;
+        WinLog::getInstance().init(nullptr, LogLevel::debug, config);
+        
+        std::atomic<bool> running(true);
+        std::vector<std::thread> producers;
+        for (int t = 0; t < LOAD_THREADS; ++t) {
+            producers.emplace_back([t, &running]() {
+                int i = 0;
+                while (running.load(std::memory_order_relaxed)) {
+                    WinLog::getInstance().info("load thread %d line %d", t, i++);
+                    if ((i & 63) == 0) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        
+        std::vector<long long> latencies;
+        int failed = 0;
+        int missed = 0;
+        for (int i = 0; i < FLUSHES; ++i) {
+            WinLog::getInstance().info("flush marker %d", i);
+            auto start = std::chrono::high_resolution_clock::now();
+            bool flushed = WinLog::getInstance().flush(2000);
+            auto end = std::chrono::high_resolution_clock::now();
+            latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            if (!flushed) {
+                failed++;
+            } else if (lastMarker.load(std::memory_order_acquire) != i) {
+                missed++;
+            }
+        }
+        
+        running = false;
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        WinLog::getInstance().shutdown();
+        
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << std::left << std::setw(16) << ec.name << std::right << std::fixed << std::setprecision(1)
+                  << "flush p50 " << std::setw(8) << percentileNs(latencies, 0.50) / 1000.0 << " us, p99 "
+                  << std::setw(8) << percentileNs(latencies, 0.99) / 1000.0 << " us, max "
+                  << std::setw(8) << latencies.back() / 1000.0 << " us, timed out: " << failed
+                  << ", marker missing: " << missed << ", load lines: " << loadLines.load() << std::endl;
+        if (failed != 0 || missed != 0) {
+            allOk = false;
+        }
+    }
+    
+    std::cout << (allOk ? "Flush under load test passed" : "Flush under load test FAILED") << std::endl;
+}
+
+// 溢出策略测试：处理回调先阻塞，队列被迅速填满，检查各引擎下每种策略的丢弃数量、按级别的计数与输出顺序
+void testOverflowPolicies() {
+    std::cout << "\n=== Overflow Policies Test ===" << std::endl;
+    
+    const int ENTRIES = 400;
+    
+    struct EngineCase {
+        const char* name;
+        QueueEngine engine;
+    };
+    const EngineCase engines[] = {
+        {"mutex", QueueEngine::mutex},
+        {"lockFree", QueueEngine::lockFree},
+        {"recordRing", QueueEngine::recordRing},
+        {"perThreadLanes", QueueEngine::perThreadLanes},
+    };
+    struct PolicyCase {
+        const char* name;
+        OverflowPolicy policy;
+        int timeoutMs;
+    };
+    const PolicyCase policies[] = {
+        {"blockWithTimeout", OverflowPolicy::blockWithTimeout, 5},
+        {"block", OverflowPolicy::block, 0},
+        {"dropNewest", OverflowPolicy::dropNewest, 0},
+        {"dropOldest", OverflowPolicy::dropOldest, 0},
+        {"dropByLevel", OverflowPolicy::dropByLevel, 2000},
+    };
+    
+    bool allOk = true;
+    for (const EngineCase& ec : engines) {
+        for (const PolicyCase& pc : policies) {
+            AsyncConfig config;
+            config.queueSize = 64;
+            config.laneSize = 64;
+            config.queueBytes = 4096;
+            config.maxBatchSize = 16;
+            config.memoryPoolSize = 256;
+            config.flushIntervalMs = 10;
+            config.queueEngine = ec.engine;
+            config.overflowPolicy = pc.policy;
+            config.overflowTimeoutMs = pc.timeoutMs;
+            
+            AsyncLogQueue queue(config);
+            std::atomic<bool> released(false);
+            std::vector<int> delivered;
+            std::vector<LogLevel> deliveredLevels;
+            queue.setLogHandler([&](const std::vector<LogEntry*>& entries) {
+                // 第一批在释放前阻塞，模拟写得很慢的输出目标
+                while (!released.load(std::memory_order_acquire)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                for (const LogEntry* entry : entries) {
+                    delivered.push_back(entry->line);
+                    deliveredLevels.push_back(entry->level);
+                }
+            });
+            
+            // 阻塞类策略需要在生产者等待期间释放处理回调
+            std::thread releaser([&released]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                released.store(true, std::memory_order_release);
+            });
+            
+            // 每10条中有1条warn、1条error，其余为info
+            size_t highLevel = 0;
+            size_t rejected = 0;
+            for (int i = 0; i < ENTRIES; ++i) {
+                LogEntry* entry = queue.allocateEntry();
+                entry->level = (i % 10 == 3) ? LogLevel::warn : (i % 10 == 7) ? LogLevel::error : LogLevel::info;
+                entry->line = i;
+                entry->timestamp = LogClock::now();
+                entry->setMessage("overflow", 8);
+                if (entry->level >= LogLevel::warn) {
+                    highLevel++;
+                }
+                if (!queue.enqueue(entry)) {
+                    rejected++;
+                }
+            }
+            releaser.join();
+            queue.flush(2000);
+            queue.stop();
+            
+            AsyncLogQueue::Stats stats = queue.getStats();
+            size_t levelSum = 0;
+            for (size_t l = 0; l < LOG_LEVEL_COUNT; ++l) {
+                levelSum += stats.droppedByLevel[l];
+            }
+            size_t highDropped = stats.droppedByLevel[static_cast<size_t>(LogLevel::warn)] +
+                                 stats.droppedByLevel[static_cast<size_t>(LogLevel::error)];
+            size_t deliveredHigh = static_cast<size_t>(std::count_if(deliveredLevels.begin(), deliveredLevels.end(),
+                [](LogLevel level) { return level >= LogLevel::warn; }));
+            bool ordered = std::is_sorted(delivered.begin(), delivered.end()) &&
+                           std::adjacent_find(delivered.begin(), delivered.end()) == delivered.end();
+            
+            // 通用检查：每条日志要么输出要么计入丢弃，按级别的计数之和等于总数，输出保持入队顺序
+            bool ok = delivered.size() + stats.totalDropped == static_cast<size_t>(ENTRIES) &&
+                      levelSum == stats.totalDropped && ordered && stats.totalOverflows > 0;
+            // 策略相关检查
+            switch (pc.policy) {
+            case OverflowPolicy::block:
+            case OverflowPolicy::spill:
+                ok = ok && stats.totalDropped == 0;
+                break;
+            case OverflowPolicy::dropNewest:
+            case OverflowPolicy::blockWithTimeout:
+                ok = ok && rejected == stats.totalDropped && stats.totalDropped > 0;
+                break;
+            case OverflowPolicy::dropOldest:
+                if (ec.engine == QueueEngine::mutex) {
+                    // 新日志总是被接受，最新的一条一定会输出
+                    ok = ok && rejected == 0 && stats.totalDropped > 0 && !delivered.empty() &&
+                         delivered.back() == ENTRIES - 1;
+                } else {
+                    // 无锁引擎中与dropNewest相同：不等待，直接丢弃本条
+                    ok = ok && rejected == stats.totalDropped && stats.totalDropped > 0;
+                }
+                break;
+            case OverflowPolicy::dropByLevel:
+                ok = ok && highDropped == 0 && deliveredHigh == highLevel && stats.totalDropped > 0;
+                break;
+            }
+            
+            std::cout << std::left << std::setw(16) << ec.name << std::setw(18) << pc.name << std::right
+                      << "delivered " << std::setw(4) << delivered.size()
+                      << ", dropped " << std::setw(4) << stats.totalDropped
+                      << " (info " << stats.droppedByLevel[static_cast<size_t>(LogLevel::info)]
+                      << ", warn+ " << highDropped << ")"
+                      << ", overflows " << std::setw(4) << stats.totalOverflows
+                      << (ok ? "" : "  <-- FAILED") << std::endl;
+            allOk = allOk && ok;
+        }
+    }
+    
+    std::cout << (allOk ? "Overflow policies test passed" : "Overflow policies test FAILED") << std::endl;
+}
+
+// 溢出文件测试：处理回调阻塞期间写入10倍于内存队列容量的突发日志，
+// 验证生产者不被阻塞、没有丢弃、每个线程的日志保持入队顺序，并统计溢出写入延迟与排空速率
+void testSpillBurst() {
+    std::cout << "\n=== Spill Burst Test ===" << std::endl;
+    
+    struct EngineCase {
+        const char* name;
+        QueueEngine engine;
+    };
+    const EngineCase engines[] = {
+        {"mutex", QueueEngine::mutex},
+        {"lockFree", QueueEngine::lockFree},
+        {"recordRing", QueueEngine::recordRing},
+        {"perThreadLanes", QueueEngine::perThreadLanes},
+    };
+    const int THREADS = 4;
+    const int QUEUE_SIZE = 1000;
+    const int PER_THREAD = QUEUE_SIZE * 10 / THREADS;
+    const int LINE_STRIDE = 1000000;
+    
+    bool allOk = true;
+    for (const EngineCase& ec : engines) {
+        AsyncConfig config;
+        config.queueSize = QUEUE_SIZE;
+        config.laneSize = QUEUE_SIZE / THREADS;
+        config.queueBytes = 64 * 1024;
+        config.maxBatchSize = 256;
+        config.memoryPoolSize = 2048;
+        config.flushIntervalMs = 10;
+        config.queueEngine = ec.engine;
+        config.overflowPolicy = OverflowPolicy::spill;
+        config.spillBytes = 4 * 1024 * 1024;
+        
+        AsyncLogQueue queue(config);
+        std::atomic<bool> released(false);
+        std::vector<int> delivered;
+        queue.setLogHandler([&](const std::vector<LogEntry*>& entries) {
+            // 突发期间阻塞，模拟写得很慢的输出目标
+            while (!released.load(std::memory_order_acquire)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            for (const LogEntry* entry : entries) {
+                delivered.push_back(entry->line);
+            }
+        });
+        
+        // 行号编码为 线程号*LINE_STRIDE + 序号
+        std::atomic<size_t> rejected(0);
+        std::vector<uint64_t> maxEnqueueNanos(THREADS, 0);
+        std::vector<std::thread> producers;
+        for (int t = 0; t < THREADS; ++t) {
+            producers.emplace_back([&, t]() {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    LogEntry* entry = queue.allocateEntry();
+                    entry->level = LogLevel::info;
+                    entry->line = t * LINE_STRIDE + i;
+                    entry->timestamp = LogClock::now();
+                    entry->setFile("spill_test.cpp", 14);
+                    entry->setMessage("burst entry written while the sink is stalled", 45);
+                    auto start = std::chrono::steady_clock::now();
+                    if (!queue.enqueue(entry)) {
+                        rejected++;
+                    }
+                    uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start).count());
+                    maxEnqueueNanos[t] = std::max(maxEnqueueNanos[t], nanos);
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        
+        // 突发结束后放行输出目标，flush需要等待溢出文件排空
+        released.store(true, std::memory_order_release);
+        bool flushed = queue.flush(10000);
+        AsyncLogQueue::Stats stats = queue.getStats();
+        queue.stop();
+        
+        // 每个线程的日志按入队顺序输出
+        std::vector<int> lastIndex(THREADS, -1);
+        bool ordered = true;
+        for (int line : delivered) {
+            int t = line / LINE_STRIDE;
+            int i = line % LINE_STRIDE;
+            if (t < 0 || t >= THREADS || i != lastIndex[t] + 1) {
+                ordered = false;
+                break;
+            }
+            lastIndex[t] = i;
+        }
+        uint64_t maxEnqueue = *std::max_element(maxEnqueueNanos.begin(), maxEnqueueNanos.end());
+        bool ok = flushed && rejected == 0 && stats.totalDropped == 0 && ordered &&
+                  delivered.size() == static_cast<size_t>(THREADS * PER_THREAD) &&
+                  stats.spilledEntries > 0 && stats.drainedEntries == stats.spilledEntries;
+        
+        double avgSpillNanos = stats.spilledEntries ? static_cast<double>(stats.totalSpillNanos) / stats.spilledEntries : 0.0;
+        double drainPerMs = stats.totalDrainNanos ? stats.drainedEntries * 1e6 / stats.totalDrainNanos : 0.0;
+        std::cout << std::left << std::setw(16) << ec.name << std::right
+                  << "delivered " << delivered.size() << ", dropped " << stats.totalDropped
+                  << ", spilled " << stats.spilledEntries << " (" << stats.spilledBytes / 1024 << " KB)"
+                  << ", spill avg " << std::fixed << std::setprecision(0) << avgSpillNanos << " ns"
+                  << ", max " << stats.maxSpillNanos / 1000 << " us"
+                  << ", drain " << drainPerMs << " entries/ms"
+                  << ", max enqueue " << maxEnqueue / 1000 << " us"
+                  << (ok ? "" : "  <-- FAILED") << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        allOk = allOk && ok;
+    }
+    
+    std::cout << (allOk ? "Spill burst test passed" : "Spill burst test FAILED") << std::endl;
+}
+
+// 优先级通道基准测试：info日志持续写满队列时，critical日志从调用到写入输出目标的延迟
+void testPriorityLanes() {
+    std::cout << "\n=== Priority Lanes Benchmark ===" << std::endl;
+    
+    const int CRITICALS = 20;
+    
+    struct ModeCase {
+        const char* name;
+        LogLevel priorityLevel;
+        PriorityOrdering ordering;
+    };
+    const ModeCase modes[] = {
+        {"off", LogLevel::off, PriorityOrdering::perSink},
+        {"perSink", LogLevel::error, PriorityOrdering::perSink},
+        {"relaxed", LogLevel::error, PriorityOrdering::relaxed},
+    };
+    
+    // 每条critical日志到达某个输出目标的时刻与次数
+    struct Arrivals {
+        std::vector<std::atomic<int64_t>> nanos;
+        std::vector<std::atomic<int>> counts;
+        Arrivals() : nanos(CRITICALS), counts(CRITICALS) {}
+        void record(const std::string& line) {
+            size_t marker = line.find("CRIT#");
+            if (marker == std::string::npos) {
+                return;
+            }
+            int id = atoi(line.c_str() + marker + 5);
+            if (id >= 0 && id < CRITICALS) {
+                if (counts[id]++ == 0) {
+                    nanos[id] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count();
+                }
+            }
+        }
+    };
+    
+    auto percentile = [](std::vector<double> values, double p) {
+        std::sort(values.begin(), values.end());
+        return values.empty() ? 0.0 : values[static_cast<size_t>(p * (values.size() - 1))];
+    };
+    
+    bool allOk = true;
+    double offMedian = 0;
+    for (const ModeCase& mc : modes) {
+        WinLog::getInstance().shutdown();
+        
+        // 模拟写磁盘的输出目标：每行约5微秒，接收所有级别；告警输出目标只接收error及以上
+        Arrivals disk;
+        Arrivals alert;
+        std::atomic<int> infoOutOfOrder(0);
+        std::atomic<long> lastInfo(-1);
+        std::shared_ptr<CallbackLogSink> diskSink = std::make_shared<CallbackLogSink>(
+            [&](LogLevel, const char* text, size_t length) {
+                auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(5);
+                while (std::chrono::steady_clock::now() < until) {
+                }
+                // 行文本不以'\0'结尾
+                std::string line(text, length);
+                size_t info = line.find("INFO#");
+                if (info != std::string::npos) {
+                    long index = atol(line.c_str() + info + 5);
+                    if (index <= lastInfo.load()) {
+                        infoOutOfOrder++;
+                    }
+                    lastInfo = index;
+                }
+                disk.record(line);
+            });
+        std::shared_ptr<CallbackLogSink> alertSink = std::make_shared<CallbackLogSink>(
+            [&](LogLevel, const char* text, size_t length) { alert.record(std::string(text, length)); }, LogLevel::error);
+        // 输出目标缓冲区较小，积压留在日志队列中
+        diskSink->setBufferCapacity(16 * 1024);
+        alertSink->setBufferCapacity(16 * 1024);
+        WinLog::getInstance().addSink(diskSink);
+        WinLog::getInstance().addSink(alertSink);
+        
+        AsyncConfig config;
+        config.queueSize = 20000;
+        config.maxBatchSize = 256;
+        config.flushIntervalMs = 10;
+        config.overflowPolicy = OverflowPolicy::block;
+        config.priorityLevel = mc.priorityLevel;
+        config.priorityOrdering = mc.ordering;
+        WinLog::getInstance().init(nullptr, LogLevel::info, config);
+        
+        // info日志持续写入，使队列保持积压
+        std::atomic<bool> flooding(true);
+        std::thread flooder([&flooding]() {
+            long i = 0;
+            while (flooding.load(std::memory_order_relaxed)) {
+                WinLog::getInstance().info("INFO#%ld background traffic keeping the queue saturated", i++);
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        
+        std::vector<int64_t> sent(CRITICALS);
+        for (int i = 0; i < CRITICALS; ++i) {
+            sent[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            WinLog::getInstance().critical("CRIT#%d disk controller reported an unrecoverable error", i);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        flooding = false;
+        flooder.join();
+        bool flushed = WinLog::getInstance().flush(30000);
+        Stats stats = WinLog::getInstance().getStats();
+        WinLog::getInstance().shutdown();
+        
+        std::vector<double> diskMs;
+        std::vector<double> alertMs;
+        bool once = true;
+        for (int i = 0; i < CRITICALS; ++i) {
+            diskMs.push_back((disk.nanos[i] - sent[i]) / 1e6);
+            alertMs.push_back((alert.nanos[i] - sent[i]) / 1e6);
+            once = once && disk.counts[i] == 1 && alert.counts[i] == 1;
+        }
+        
+        // perSink顺序下接收全部级别的输出目标仍按入队顺序收到info日志，critical日志只提前交给告警输出目标
+        bool ok = flushed && once && infoOutOfOrder == 0;
+        if (mc.priorityLevel == LogLevel::off) {
+            offMedian = percentile(diskMs, 0.5);
+        } else {
+            ok = ok && stats.expeditedEntries + stats.expediteMisses == static_cast<size_t>(CRITICALS) &&
+                 percentile(alertMs, 0.5) < offMedian;
+            if (mc.ordering == PriorityOrdering::relaxed) {
+                ok = ok && percentile(diskMs, 0.5) < offMedian;
+            }
+        }
+        
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << std::left << std::setw(9) << mc.name << std::right
+                  << "disk sink p50 " << std::setw(8) << percentile(diskMs, 0.5) << " ms, max " << std::setw(8)
+                  << percentile(diskMs, 1.0) << " ms | alert sink p50 " << std::setw(8) << percentile(alertMs, 0.5)
+                  << " ms, max " << std::setw(8) << percentile(alertMs, 1.0) << " ms | expedited "
+                  << stats.expeditedEntries << (ok ? "" : "  <-- FAILED") << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        allOk = allOk && ok;
+    }
+    
+    // 通道容量很小时部分critical日志未能提前：告警输出目标仍须按入队顺序收到，未能提前的那条不能排在后续条目之后
+    {
+        WinLog::getInstance().shutdown();
+        std::mutex orderMutex;
+        std::vector<int> alertOrder;
+        std::shared_ptr<CallbackLogSink> slowSink = std::make_shared<CallbackLogSink>(
+            [](LogLevel, const char*, size_t) {
+                auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(20);
+                while (std::chrono::steady_clock::now() < until) {
+                }
+            });
+        std::shared_ptr<CallbackLogSink> alertSink = std::make_shared<CallbackLogSink>(
+            [&](LogLevel, const char* text, size_t length) {
+                std::string line(text, length);
+                size_t marker = line.find("CRIT#");
+                if (marker != std::string::npos) {
+                    std::lock_guard<std::mutex> lock(orderMutex);
+                    alertOrder.push_back(atoi(line.c_str() + marker + 5));
+                }
+            }, LogLevel::error);
+        slowSink->setBufferCapacity(4 * 1024);
+        alertSink->setBufferCapacity(4 * 1024);
+        WinLog::getInstance().addSink(slowSink);
+        WinLog::getInstance().addSink(alertSink);
+        
+        AsyncConfig config;
+        config.queueSize = 20000;
+        config.maxBatchSize = 64;
+        config.overflowPolicy = OverflowPolicy::block;
+        config.priorityLevel = LogLevel::error;
+        config.priorityOrdering = PriorityOrdering::perSink;
+        config.priorityQueueSize = 4;
+        WinLog::getInstance().init(nullptr, LogLevel::info, config);
+        
+        const int ORDERED = 400;
+        for (int i = 0; i < ORDERED; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                WinLog::getInstance().info("INFO#%d background traffic", j);
+            }
+            WinLog::getInstance().critical("CRIT#%d controller error", i);
+        }
+        bool flushed = WinLog::getInstance().flush(30000);
+        Stats stats = WinLog::getInstance().getStats();
+        WinLog::getInstance().shutdown();
+        
+        bool ordered = alertOrder.size() == static_cast<size_t>(ORDERED);
+        for (size_t i = 0; ordered && i < alertOrder.size(); ++i) {
+            ordered = alertOrder[i] == static_cast<int>(i);
+        }
+        bool ok = flushed && ordered && stats.expediteMisses > 0 &&
+                  stats.expeditedEntries + stats.expediteMisses == static_cast<size_t>(ORDERED);
+        std::cout << "Lane of 4 entries: expedited " << stats.expeditedEntries << ", missed " << stats.expediteMisses
+                  << ", alert sink order " << (ordered ? "kept" : "BROKEN") << (ok ? "" : "  <-- FAILED") << std::endl;
+        allOk = allOk && ok;
+    }
+    
+    std::cout << (allOk ? "Priority lanes benchmark passed" : "Priority lanes benchmark FAILED") << std::endl;
+}
+
+// 批量提交测试：各批次大小下每条日志的生产者开销，以及多线程提交时批次在输出中保持连续
+void testLogBatch() {
+    std::cout << "\n=== Log Batch Submission Benchmark ===" << std::endl;
+    
+    struct EngineCase {
+        const char* name;
+        QueueEngine engine;
+    };
+    const EngineCase engines[] = {
+        {"mutex", QueueEngine::mutex},
+        {"lockFree", QueueEngine::lockFree},
+        {"recordRing", QueueEngine::recordRing},
+        {"perThreadLanes", QueueEngine::perThreadLanes},
+    };
+    const size_t batchSizes[] = {1, 8, 64, 512};
+    const int ENTRIES = 32768;
+    
+    auto makeConfig = [](QueueEngine engine) {
+        AsyncConfig config;
+        config.queueEngine = engine;
+        config.queueSize = 65536;
+        config.laneSize = 65536;
+        config.queueBytes = 32 * 1024 * 1024;
+        config.maxBatchSize = 256;
+        config.flushIntervalMs = 10;
+        config.overflowPolicy = OverflowPolicy::block;
+        return config;
+    };
+    
+    bool allOk = true;
+    std::cout << std::left << std::setw(16) << "engine" << std::right << std::setw(12) << "individual";
+    for (size_t size : batchSizes) {
+        std::cout << std::setw(10) << ("batch " + std::to_string(size));
+    }
+    std::cout << "   (ns per entry, producer side)" << std::endl;
+    
+    for (const EngineCase& ec : engines) {
+        std::cout << std::left << std::setw(16) << ec.name << std::right;
+        std::cout << std::fixed << std::setprecision(1);
+        
+        // 第一列为逐条调用info，其余列为各批次大小下的logBatch
+        for (int column = -1; column < static_cast<int>(sizeof(batchSizes) / sizeof(batchSizes[0])); ++column) {
+            WinLog::getInstance().shutdown();
+            std::atomic<int> received(0);
+            WinLog::getInstance().addSink(std::make_shared<CallbackLogSink>(
+                [&received](LogLevel, const char*, size_t) { received++; }));
+            WinLog::getInstance().init(nullptr, LogLevel::info, makeConfig(ec.engine));
+            
+            auto start = std::chrono::high_resolution_clock::now();
+            if (column < 0) {
+                for (int i = 0; i < ENTRIES; ++i) {
+                    WinLog::getInstance().info("state row %d: shard=%d pending=%d", i, i % 16, i * 7);
+                }
+            } else {
+                size_t batchSize = batchSizes[column];
+                LogEntryBatch batch;
+                for (int i = 0; i < ENTRIES; ++i) {
+                    batch.add(LogLevel::info, "state row %d: shard=%d pending=%d", i, i % 16, i * 7);
+                    if (batch.size() == batchSize) {
+                        WinLog::getInstance().logBatch(batch);
+                    }
+                }
+                WinLog::getInstance().logBatch(batch);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            
+            bool flushed = WinLog::getInstance().flush(30000);
+            Stats stats = WinLog::getInstance().getStats();
+            WinLog::getInstance().shutdown();
+            
+            double nanos = static_cast<double>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / ENTRIES;
+            bool ok = flushed && received == ENTRIES && stats.droppedEntries == 0;
+            std::cout << std::setw(column < 0 ? 12 : 10) << nanos << (ok ? "" : "!");
+            allOk = allOk && ok;
+        }
+        std::cout << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    }
+    
+    // 连续性：多个线程同时提交批次，每个批次的日志在输出中必须相邻且按添加顺序排列
+    const int THREADS = 4;
+    const int BATCHES = 200;
+    const int BATCH_SIZE = 16;
+    for (const EngineCase& ec : engines) {
+        WinLog::getInstance().shutdown();
+        std::atomic<int> received(0);
+        int broken = 0;
+        int lastThread = -1;
+        int lastBatch = -1;
+        int lastIndex = BATCH_SIZE - 1;
+        WinLog::getInstance().addSink(std::make_shared<CallbackLogSink>(
+            [&](LogLevel, const char* text, size_t length) {
+                // 行文本不以'\0'结尾
+                std::string line(text, length);
+                size_t marker = line.find("BATCH#");
+                if (marker == std::string::npos) {
+                    return;
+                }
+                int thread = -1;
+                int batch = -1;
+                int index = -1;
+                sscanf(line.c_str() + marker, "BATCH#%d:%d:%d", &thread, &batch, &index);
+                // 新批次只能在上一个批次结束后开始，批次内的下一条必须紧随上一条
+                bool continues = thread == lastThread && batch == lastBatch && index == lastIndex + 1;
+                bool starts = index == 0 && lastIndex == BATCH_SIZE - 1;
+                if (!continues && !starts) {
+                    broken++;
+                }
+                lastThread = thread;
+                lastBatch = batch;
+                lastIndex = index;
+                received++;
+            }));
+        WinLog::getInstance().init(nullptr, LogLevel::info, makeConfig(ec.engine));
+        
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([t]() {
+                LogEntryBatch batch;
+                for (int b = 0; b < BATCHES; ++b) {
+                    for (int k = 0; k < BATCH_SIZE; ++k) {
+                        batch.add(LogLevel::info, "BATCH#%d:%d:%d request summary field", t, b, k);
+                    }
+                    WinLog::getInstance().logBatch(batch);
+                    // 穿插单条日志，检验批次不会被单条日志打断
+                    WinLog::getInstance().info("single line from thread %d", t);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        bool flushed = WinLog::getInstance().flush(30000);
+        WinLog::getInstance().shutdown();
+        
+        bool ok = flushed && received == THREADS * BATCHES * BATCH_SIZE && broken == 0;
+        std::cout << std::left << std::setw(16) << ec.name << std::right << "contiguity: " << received
+                  << " lines, " << broken << " interleaved" << (ok ? "" : "  <-- FAILED") << std::endl;
+        allOk = allOk && ok;
+    }
+    
+    std::cout << (allOk ? "Log batch benchmark passed" : "Log batch benchmark FAILED") << std::endl;
+}
+
+// 等待策略测试：突发写入时各策略下生产者唤醒工作线程的次数（系统调用次数）与端到端延迟
+void testWaitStrategies() {
+    std::cout << "\n=== Consumer Wait Strategy Benchmark ===" << std::endl;
+    
+    struct StrategyCase {
+        const char* name;
+        WaitStrategy strategy;
+    };
+    const StrategyCase strategies[] = {
+        {"park", WaitStrategy::park},
+        {"busySpin", WaitStrategy::busySpin},
+        {"spinYield", WaitStrategy::spinYield},
+        {"spinPark", WaitStrategy::spinPark},
+        {"timedBatch", WaitStrategy::timedBatch},
+    };
+    const QueueEngine engines[] = {QueueEngine::mutex, QueueEngine::lockFree};
+    const int BURSTS = 200;
+    const int BURST_SIZE = 10;
+    const int ENTRIES = BURSTS * BURST_SIZE;
+    
+    auto percentile = [](std::vector<double> values, double p) {
+        std::sort(values.begin(), values.end());
+        return values.empty() ? 0.0 : values[static_cast<size_t>(p * (values.size() - 1))];
+    };
+    auto nowNanos = []() {
+        return static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    };
+    
+    bool allOk = true;
+    for (QueueEngine engine : engines) {
+        for (const StrategyCase& sc : strategies) {
+            WinLog::getInstance().shutdown();
+            
+            // 输出目标从日志文本中取出发送时刻，计算到达输出目标的延迟
+            std::mutex latencyMutex;
+            std::vector<double> latencyUs;
+            latencyUs.reserve(ENTRIES);
+            WinLog::getInstance().addSink(std::make_shared<CallbackLogSink>(
+                [&](LogLevel, const char* text, size_t length) {
+                    long long arrived = nowNanos();
+                    std::string line(text, length);
+                    size_t marker = line.find("SENT#");
+                    if (marker != std::string::npos) {
+                        long long sent = atoll(line.c_str() + marker + 5);
+                        std::lock_guard<std::mutex> lock(latencyMutex);
+                        latencyUs.push_back((arrived - sent) / 1000.0);
+                    }
+                }));
+            
+            AsyncConfig config;
+            config.queueEngine = engine;
+            config.queueSize = 8192;
+            config.overflowPolicy = OverflowPolicy::block;
+            config.waitStrategy = sc.strategy;
+            config.spinIterations = 4000;
+            config.batchIntervalUs = 1000;
+            WinLog::getInstance().init(nullptr, LogLevel::info, config);
+            
+            // 突发写入：每批10条，批与批之间空闲1毫秒，使工作线程在批间进入等待
+            for (int b = 0; b < BURSTS; ++b) {
+                for (int i = 0; i < BURST_SIZE; ++i) {
+                    WinLog::getInstance().info("SENT#%lld burst %d entry %d", nowNanos(), b, i);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            bool flushed = WinLog::getInstance().flush(30000);
+            Stats stats = WinLog::getInstance().getStats();
+            WinLog::getInstance().shutdown();
+            
+            // 自旋中的工作线程与timedBatch策略不需要生产者通知；休眠策略下每次休眠最多被通知一次，
+            // 唤醒次数应与突发批数同一量级，而不是每条日志一次
+            bool ok = flushed && latencyUs.size() == static_cast<size_t>(ENTRIES);
+            if (sc.strategy == WaitStrategy::park || sc.strategy == WaitStrategy::spinPark) {
+                ok = ok && stats.producerWakeups <= static_cast<size_t>(BURSTS) * 2;
+            } else {
+                ok = ok && stats.producerWakeups == 0;
+            }
+            
+            std::cout << std::fixed << std::setprecision(1);
+            std::cout << std::left << std::setw(9) << (engine == QueueEngine::mutex ? "mutex" : "lockFree")
+                      << std::setw(11) << sc.name << std::right << "wakeups " << std::setw(5) << stats.producerWakeups
+                      << " (" << std::setprecision(3) << static_cast<double>(stats.producerWakeups) / ENTRIES
+                      << "/entry), parks " << std::setw(5) << stats.consumerParks << std::setprecision(1)
+                      << " | latency p50 " << std::setw(8) << percentile(latencyUs, 0.5) << " us, p99 "
+                      << std::setw(8) << percentile(latencyUs, 0.99) << " us" << (ok ? "" : "  <-- FAILED")
+                      << std::endl;
+            std::cout.unsetf(std::ios::fixed);
+            allOk = allOk && ok;
+        }
+    }
+    
+    std::cout << (allOk ? "Wait strategy benchmark passed" : "Wait strategy benchmark FAILED") << std::endl;
+}
+
+// 自适应批量测试：回调开销固定的快速输出目标下批次应放大以减少回调次数，
+// 每条开销较大的慢速输出目标下一批的处理耗时应保持在延迟目标附近
+void testAdaptiveBatching() {
+    std::cout << "\n=== Adaptive Batch Sizing Benchmark ===" << std::endl;
+    
+    struct BatchCase {
+        const char* name;
+        bool adaptive;
+        int callNanos;      // 每次回调的固定开销（模拟一次写入系统调用）
+        int entryNanos;     // 每条日志的处理开销
+        int entries;
+    };
+    const BatchCase cases[] = {
+        {"fixed fast", false, 20000, 200, 50000},
+        {"adaptive fast", true, 20000, 200, 50000},
+        {"adaptive slow", true, 20000, 20000, 5000},
+    };
+    const QueueEngine engines[] = {QueueEngine::mutex, QueueEngine::lockFree};
+    const int LATENCY_TARGET_US = 1000;
+    
+    auto spinFor = [](long long nanos) {
+        auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(nanos);
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    };
+    
+    bool allOk = true;
+    for (QueueEngine engine : engines) {
+        size_t fixedCalls = 0;
+        for (const BatchCase& bc : cases) {
+            AsyncConfig config;
+            config.queueSize = 8192;
+            config.maxBatchSize = bc.adaptive ? 4096 : 100;
+            config.memoryPoolSize = 8192;
+            config.queueEngine = engine;
+            config.overflowPolicy = OverflowPolicy::block;
+            config.adaptiveBatching = bc.adaptive;
+            config.minBatchSize = 16;
+            config.batchLatencyTargetUs = LATENCY_TARGET_US;
+            
+            AsyncLogQueue queue(config);
+            std::vector<int> delivered;
+            delivered.reserve(bc.entries);
+            std::vector<size_t> batchSizes;
+            std::vector<double> batchUs;
+            queue.setLogHandler([&](const std::vector<LogEntry*>& entries) {
+                auto start = std::chrono::steady_clock::now();
+                spinFor(bc.callNanos + static_cast<long long>(bc.entryNanos) * entries.size());
+                for (const LogEntry* entry : entries) {
+                    delivered.push_back(entry->line);
+                }
+                batchSizes.push_back(entries.size());
+                batchUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            });
+            
+            for (int i = 0; i < bc.entries; ++i) {
+                LogEntry* entry = queue.allocateEntry();
+                entry->level = LogLevel::info;
+                entry->line = i;
+                entry->timestamp = LogClock::now();
+                entry->setMessage("adaptive", 8);
+                queue.enqueue(entry);
+            }
+            bool flushed = queue.flush(30000);
+            AsyncLogQueue::Stats stats = queue.getStats();
+            queue.stop();
+            
+            size_t maxBatch = batchSizes.empty() ? 0 : *std::max_element(batchSizes.begin(), batchSizes.end());
+            std::vector<double> sortedUs = batchUs;
+            std::sort(sortedUs.begin(), sortedUs.end());
+            double p90Us = sortedUs.empty() ? 0.0 : sortedUs[static_cast<size_t>(0.9 * (sortedUs.size() - 1))];
+            bool ordered = std::is_sorted(delivered.begin(), delivered.end()) &&
+                           std::adjacent_find(delivered.begin(), delivered.end()) == delivered.end();
+            
+            // 通用检查：全部输出且保持顺序，批次数与回调次数一致
+            bool ok = flushed && delivered.size() == static_cast<size_t>(bc.entries) && ordered &&
+                      stats.batchOperations == batchSizes.size() && stats.batchesPerSecond > 0;
+            if (!bc.adaptive) {
+                fixedCalls = batchSizes.size();
+                ok = ok && maxBatch <= 100 && stats.batchLimit == 100;
+            } else if (bc.entryNanos < 1000) {
+                // 回调的固定开销占主导：积压时批次放大，回调次数明显少于固定上限
+                ok = ok && maxBatch > 100 && batchSizes.size() * 2 < fixedCalls;
+            } else {
+                // 每条开销20微秒、延迟目标1毫秒：每批上限应收敛到约50条，大多数批次不超过延迟目标的两倍
+                ok = ok && stats.batchLimit >= 16 && stats.batchLimit <= 64 && p90Us <= LATENCY_TARGET_US * 2.0;
+            }
+            
+            std::cout << std::fixed << std::setprecision(1);
+            std::cout << std::left << std::setw(9) << (engine == QueueEngine::mutex ? "mutex" : "lockFree")
+                      << std::setw(14) << bc.name << std::right << "batches " << std::setw(5) << stats.batchOperations
+                      << ", avg " << std::setw(7) << static_cast<double>(delivered.size()) / std::max<size_t>(1, batchSizes.size())
+                      << ", max " << std::setw(5) << maxBatch << ", limit " << std::setw(5) << stats.batchLimit
+                      << ", p90 " << std::setw(8) << p90Us << " us/batch, " << std::setw(8) << stats.batchesPerSecond
+                      << " batches/s" << (ok ? "" : "  <-- FAILED") << std::endl;
+            std::cout.unsetf(std::ios::fixed);
+            allOk = allOk && ok;
+        }
+    }
+    
+    std::cout << (allOk ? "Adaptive batching benchmark passed" : "Adaptive batching benchmark FAILED") << std::endl;
+}
+
 int main() {
     std::cout << "WinLog Asynchronous Logging Functionality Test" << std::endl;
     std::cout << "=============================" << std::endl;
@@ -350,6 +3230,30 @@ int main() {
         testOverflowStrategy();
         testConfigParams();
         testMemoryPoolPerformance();  // 运行内存池性能测试
+        testQueueContentionBenchmark(); // 队列引擎争用基准测试
+        testQueueStorageBenchmark();    // 队列存储布局基准测试
+        testPerThreadLanesOrdering();   // 生产者通道全局有序与回收测试
+        testDeferredFormatting();       // 延迟格式化正确性与调用线程开销
+        testLogSiteRegistry();          // 调用点登记表与按调用点禁用
+        testTimestampFormatterBenchmark(); // 时间戳格式化开销
+        testCallSiteTimestamps();       // 调用点时间戳的开销与准确性
+        testOutputPathAllocations();    // 输出路径稳定状态下零堆分配
+        testDurabilityPolicyBenchmark(); // 各持久化策略的写入吞吐量
+        testMultipleSinks();            // 多输出目标与按输出目标的级别过滤
+        testSlowSinkIsolation();        // 慢输出目标不影响文件输出目标的吞吐量
+        testRotationBenchmark();        // 文件轮转延迟与后台压缩的影响
+        testBinarySinkBenchmark();      // 二进制格式的写入字节数、工作线程耗时与解码一致性
+        testMappedFileSink();           // 内存映射文件输出目标的吞吐量、截断、轮转与恢复
+        testOverlappedWriteBenchmark(); // 同步写入与重叠I/O写入的写线程耗时和端到端时间
+        testDirectWriteBenchmark();     // 无缓冲写入的延迟、系统缓存占用与尾部块的截断
+        testDurableGroupCommit();       // 落盘凭据的等待延迟与组提交合并的落盘次数
+        testFlushUnderLoad();           // 其他线程持续写入时flush的延迟
+        testOverflowPolicies();         // 各溢出策略的丢弃计数、按级别统计与输出顺序
+        testSpillBurst();               // 突发日志写入溢出文件，不丢弃、不乱序
+        testPriorityLanes();            // info日志积压时critical日志到达输出目标的延迟
+        testLogBatch();                 // 批量提交的每条开销与批次在输出中的连续性
+        testWaitStrategies();           // 各等待策略下生产者的唤醒次数与端到端延迟
+        testAdaptiveBatching();         // 自适应批量在快速与慢速输出目标下的批次大小与处理耗时
         
         std::cout << "\nAll tests completed!" << std::endl;
     } catch (const std::exception& e) {